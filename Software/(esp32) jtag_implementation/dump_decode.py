@@ -0,0 +1,53 @@
+"""
+Rebuilds a target memory image from the framed binary dump that
+DumpCode() in main/jtag_implementation.c writes to the console.
+
+    python dump_decode.py capture.bin image.bin
+
+capture.bin is the raw console output, eg saved from a serial
+terminal. Text around the frames is skipped. image.bin holds the
+dumped range starting at its lowest address, with 0xFF in any
+block that was missing or failed its checksum.
+"""
+import struct
+import sys
+
+
+def frames(data):
+    i = 0
+    while True:
+        i = data.find(b"\xa5\x5a", i)
+        if i < 0 or i + 6 > len(data):
+            return
+        address, length = struct.unpack_from("<HH", data, i + 2)
+        end = i + 6 + length + 2
+        if end > len(data):
+            return
+        payload = data[i + 6:i + 6 + length]
+        (checksum,) = struct.unpack_from("<H", data, end - 2)
+        words = struct.unpack("<%dH" % (length // 2), payload)
+        if sum(words) & 0xFFFF == checksum:
+            yield address, payload
+            if length == 0:
+                return
+            i = end
+        else:
+            i += 1  # not a frame, or a corrupted one
+
+
+def main():
+    data = open(sys.argv[1], "rb").read()
+    blocks = [(a, p) for a, p in frames(data) if p]
+    if not blocks:
+        sys.exit("no frames found")
+    start = min(a for a, _ in blocks)
+    stop = max(a + len(p) for a, p in blocks)
+    image = bytearray(b"\xff" * (stop - start))
+    for address, payload in blocks:
+        image[address - start:address - start + len(payload)] = payload
+    open(sys.argv[2], "wb").write(image)
+    print("0x%04X-0x%04X, %d blocks" % (start, stop - 1, len(blocks)))
+
+
+if __name__ == "__main__":
+    main()
@@ -1,414 +1,415 @@
 #include <stdio.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "driver/uart.h"
 #include "driver/gpio.h"
+#include "esp_timer.h"
+#include "jtag_pins.h"
+#include "jtag_fsm.h"
+#include "jtag_control.h"
+#include "jtag_mirror.h"
 
 #define HIGH 1
 #define LOW 0
-#define INPUT GPIO_MODE_INPUT
-#define OUTPUT GPIO_MODE_OUTPUT
-
-// JTAG pins are from the perspective of the MSP430
-#define RST GPIO_NUM_14 // MSP430 reset                     (RX)  ->  (16) s2 (14/22)(GPIO/PHYSICAL)
-#define TMS GPIO_NUM_45 // JTAG state machine control       (TX)  ->  (7)     (45/26)
-#define TCK GPIO_NUM_34 // JTAG clock input                 (MO)  ->  (6)     (34/26)
-#define TDI GPIO_NUM_33 // JTAG data input and TCLK input   (MI)  ->  (14)    (33/24)
-#define TDO GPIO_NUM_21 // JTAG data output                 (21)  ->  (15)    (21/23)
-#define TEN GPIO_NUM_13 // JTAG enable                      (SCL) ->  (17)    (13/21)
 
 #define LOCATION 0x00
 
-const uint8_t IR_ADDR_16BIT = 0x83;
-const uint8_t IR_ADDR_CAPTURE = 0x84;
-const uint8_t IR_DATA_TO_ADDR = 0x85;
-const uint8_t IR_DATA_16BIT = 0x41;
-const uint8_t IR_DATA_QUICK = 0x43;
-const uint8_t IR_BYPASS = 0xFF;
-const uint8_t IR_CNTRL_SIG_16BIT = 0x13;
-const uint8_t IR_CNTRL_SIG_CAPTURE = 0x14;
-const uint8_t IR_CNTRL_SIG_RELEASE = 0x15;
-const uint8_t IR_DATA_PSA = 0x44;
-const uint8_t IR_SHIFT_OUT_PSA = 0x46;
-const uint8_t IR_Prepare_Blow = 0x22;
-const uint8_t IR_Ex_Blow = 0x24;
-const uint8_t IR_JMB_EXCHANGE = 0x61;
-
+// Pipelined dump: blocks of DUMP_BLOCK_WORDS words are read by the
+// JTAG task into one of two buffers while the output task streams
+// the other. Each block is sent as a binary frame:
+//   0xA5 0x5A, address (u16), length in bytes (u16), data, checksum (u16)
+// all little endian, the checksum being the 16-bit sum of the data
+// words. A frame with length 0 ends the dump.
+#define DUMP_BLOCK_WORDS 256
+#define DUMP_BUFFERS 2
+#define DUMP_UART CONFIG_ESP_CONSOLE_UART_NUM
+
+// Mirror console: one command per line on the console UART, answered
+// from the flash mirror without JTAG scans, see MirrorConsole().
+#define CONSOLE_LINE 32
+#define CONSOLE_LIST 8 // instructions listed by default
+
+typedef struct {
+    uint16_t address;
+    uint16_t length; // in words, 0 ends the dump
+    uint16_t words[DUMP_BLOCK_WORDS];
+} DumpBlock;
+
+typedef struct {
+    uint16_t start;
+    uint32_t stop;
+} DumpRange;
+
+static DumpBlock dump_blocks[DUMP_BUFFERS];
+static QueueHandle_t dump_free;   // blocks ready to be filled
+static QueueHandle_t dump_full;   // blocks ready to be sent
+static TaskHandle_t dump_waiter;  // notified once the dump is sent
+
+#ifdef JTAG_PIN_TRACE
+PinEdge pin_trace[PIN_TRACE_DEPTH];
+uint16_t pin_trace_length;
+#endif
+
+#ifdef JTAG_PIN_DEDICATED
 /*
-    Shifts an 8-bit JTAG instruction into the JTAG
-    instruction register via the TDI. At the same time,
-    the 8-bit JTAG ID is shifted out via the TDO. Each
-    instruction bit is captured from TDI on the rising
-    edge of the TCK. Shifted LSB first.
-
-    Returns: 8-bit JTAG ID
+    Routes TCK, TMS and TDI to a dedicated GPIO output bundle
+    and TDO to an input bundle. Must run before any other
+    bundle is created, see jtag_pins.h, and before initFSM()
+    drives the pins through the bundles.
 */
-uint8_t IR_SHIFT(uint8_t input_data) {
-    uint16_t ret = 0x00;
-    int prevTDI = gpio_get_level(TDI);
-
-    // set TAP machine to Shift-IR state
-    // TMS set through falling and rising edge
-    gpio_set_level(TMS, HIGH);
-    gpio_set_level(TCK, LOW);
-    gpio_set_level(TCK, HIGH); // 1 (Select DR)
-
-    gpio_set_level(TCK, LOW);
-    gpio_set_level(TCK, HIGH); // 1 (Select IR)
-
-    gpio_set_level(TMS, LOW);
-    gpio_set_level(TCK, LOW);
-    gpio_set_level(TCK, HIGH); // 0 (Capture IR)
-
-    gpio_set_level(TCK, LOW);
-    gpio_set_level(TCK, HIGH); // 0 (Shift IR)
-
-    // shift data into IR
-    uint8_t bit;
-    for (int i = 0; i < 7; i++) {
-        bit = input_data >> i;
-        bit &= 0x01; // send the selected bit
-        gpio_set_level(TDI, (uint32_t) bit);
-        gpio_set_level(TCK, LOW);
-        gpio_set_level(TCK, HIGH);
-        uint16_t output = gpio_get_level(TDO);
-        ret |= output << (7 - i);
+void InitDedicatedPins() {
+    static const int out_pins[] = {TCK, TMS, TDI};
+    static const int in_pins[] = {TDO};
+    dedic_gpio_bundle_handle_t out_bundle = NULL, in_bundle = NULL;
+    dedic_gpio_bundle_config_t out_config = {
+        .gpio_array = out_pins,
+        .array_size = 3,
+        .flags = { .out_en = 1 },
+    };
+    dedic_gpio_bundle_config_t in_config = {
+        .gpio_array = in_pins,
+        .array_size = 1,
+        .flags = { .in_en = 1 },
+    };
+    uint32_t offset;
+
+    ESP_ERROR_CHECK(dedic_gpio_new_bundle(&out_config, &out_bundle));
+    ESP_ERROR_CHECK(dedic_gpio_new_bundle(&in_config, &in_bundle));
+    if (dedic_gpio_get_out_offset(out_bundle, &offset) != ESP_OK || offset != 0) {
+        printf("Dedicated GPIO output bundle not at channel 0!\n");
     }
-
-    // Send MSB and return to Run/Idle
-    bit = input_data >> 7;
-    bit &= 0x01;
-    gpio_set_level(TMS, HIGH);
-    gpio_set_level(TDI, bit);
-    gpio_set_level(TCK, LOW);
-    gpio_set_level(TCK, HIGH); // 1 (Exit IR)
-    ret |= gpio_get_level(TDO);
-
-    gpio_set_level(TDI, prevTDI);
-    gpio_set_level(TCK, LOW);
-    gpio_set_level(TCK, HIGH); // 1 (Update IR)
-
-    gpio_set_level(TMS, LOW);
-    gpio_set_level(TCK, LOW);
-    gpio_set_level(TCK, HIGH); // 0 (IDLE)
-
-    for (int i = 0; i < 4; i++) {
-        gpio_set_level(TCK, LOW);
-        gpio_set_level(TCK, HIGH);
+    if (dedic_gpio_get_in_offset(in_bundle, &offset) != ESP_OK || offset != 0) {
+        printf("Dedicated GPIO input bundle not at channel 0!\n");
     }
-
-    return ret;
 }
+#endif
 
 /*
-    Shifts a 16-bit word into the JTAG data register (DR).
-    The word is shifted, MSB first, via the TDI. At the
-    same time, the last captured and stored value in the
-    addressed data register is shifted out via the TDO. A
-    new bit is present at TDO with a falling edge of TCK.
-    Shifted MSB first.
-
-    Returns: Last captured and stored value in the
-    addressed data register.
+    Producer of the pipelined dump. Fills free blocks with
+    burst reads until the range is read, then queues an
+    empty block to end the dump. readMemQuick() leaves the
+    CPU released, so it is put back into the instruction-fetch
+    state and halted before every block, as checkpoint() does.
+    The dump ends early if the target stops fetching.
 */
-uint16_t DR_SHIFT(uint16_t input_data) {
-    uint16_t ret = 0x0000;
-    int prevTDI = gpio_get_level(TDI);
-
-    // set TAP machine to Shift-DR state
-    // TMS set through falling and rising edge
-    gpio_set_level(TMS, HIGH);
-    gpio_set_level(TCK, LOW);
-    gpio_set_level(TCK, HIGH); // 1 (Select DR)
-
-    gpio_set_level(TMS, LOW);
-    gpio_set_level(TCK, LOW);
-    gpio_set_level(TCK, HIGH); // 0 (Capture DR)
-
-    gpio_set_level(TCK, LOW);
-    gpio_set_level(TCK, HIGH); // 0 (Shift DR)
-
-    // shift data into DR
-    uint16_t bit;
-    for (int i = 15; i > 0; i--) {
-        bit = input_data >> i;
-        bit &= 0x0001; // send the selected bit
-        gpio_set_level(TDI, (uint32_t) bit);
-        gpio_set_level(TCK, LOW);
-        gpio_set_level(TCK, HIGH);
-        uint16_t output = gpio_get_level(TDO);
-        ret |= output << i;
-    }
-    // Send LSB and return to Run/Idle
-    bit = input_data;
-    bit &= 0x0001;
-    gpio_set_level(TMS, HIGH);
-    gpio_set_level(TDI, bit);
-    gpio_set_level(TCK, LOW);
-    gpio_set_level(TCK, HIGH); // 1 (Exit DR)
-    ret |= gpio_get_level(TDO);
-
-    gpio_set_level(TDI, prevTDI);
-    gpio_set_level(TCK, LOW);
-    gpio_set_level(TCK, HIGH); // 1 (Update DR)
-
-    gpio_set_level(TMS, LOW);
-    gpio_set_level(TCK, LOW);
-    gpio_set_level(TCK, HIGH); // 0 (IDLE)
-
-    for (int i = 0; i < 4; i++) {
-        gpio_set_level(TCK, LOW);
-        gpio_set_level(TCK, HIGH);
-    }
+void DumpReadTask(void *arg) {
+    const DumpRange *range = arg;
+    DumpBlock *block;
+    uint32_t addr = range->start;
 
-    return ret;
-}
-
-/*
-    Sets TCLK to LOW, which acts as the falling edge of
-    the CPU clock. Executed in the Run/Idle state. Note
-    that the MSP430 is not pipelined, so a full TCLK cycle
-    executes the CPU instruction located at the PC.
-*/
-void ClrTCLK() {
-    gpio_set_level(TDI, LOW);
+    while (true) {
+        xQueueReceive(dump_free, &block, portMAX_DELAY);
+        block->address = addr;
+        block->length = 0;
+        if (addr < range->stop && setInstrFetch()) {
+            haltCPU();
+            block->length = DUMP_BLOCK_WORDS;
+            if (range->stop - addr < 2 * DUMP_BLOCK_WORDS) {
+                block->length = (range->stop - addr) / 2;
+            }
+            readMemQuick(addr, block->words, block->length);
+            addr += 2 * block->length;
+        }
+        xQueueSend(dump_full, &block, portMAX_DELAY);
+        if (block->length == 0) {
+            vTaskDelete(NULL);
+        }
+    }
 }
 
 /*
-    Sets TCLK to HIGH, which acts as the rising edge of
-    the CPU clock. Executed in the Run/Idle state. Note
-    that the MSP430 is not pipelined, so a full TCLK cycle
-    executes the CPU instruction located at the PC.
+    Consumer of the pipelined dump. Frames each filled block
+    onto the console UART and hands the block back to the
+    producer, notifying the waiting task after the end frame.
 */
-void SetTCLK() {
-    gpio_set_level(TDI, HIGH);
-}
+void DumpWriteTask(void *arg) {
+    DumpBlock *block;
+    uint8_t header[6], trailer[2];
+    uint16_t sum;
 
-/*
-    Takes the CPU under JTAG Control.
-*/
-void GetDevice() {
-    IR_SHIFT(IR_CNTRL_SIG_16BIT);
-    DR_SHIFT((uint16_t) 0x2401);
-    IR_SHIFT(IR_CNTRL_SIG_CAPTURE);
-    printf("Syncing CPU...\n");
     while (true) {
-        uint16_t TDOword = DR_SHIFT((uint16_t) 0x0000);
-        if ((TDOword & 0x0200) != 0) {
-            printf("Sync Successful!\n");
-            return;
+        xQueueReceive(dump_full, &block, portMAX_DELAY);
+        sum = 0;
+        for (uint16_t i = 0; i < block->length; i++) {
+            sum += block->words[i];
         }
-    }   
+        header[0] = 0xA5;
+        header[1] = 0x5A;
+        header[2] = block->address & 0xFF;
+        header[3] = block->address >> 8;
+        header[4] = (2 * block->length) & 0xFF;
+        header[5] = (2 * block->length) >> 8;
+        trailer[0] = sum & 0xFF;
+        trailer[1] = sum >> 8;
+        uart_write_bytes(DUMP_UART, header, sizeof(header));
+        uart_write_bytes(DUMP_UART, block->words, 2 * block->length); // ESP32 is little endian
+        uart_write_bytes(DUMP_UART, trailer, sizeof(trailer));
+        if (block->length == 0) {
+            uart_wait_tx_done(DUMP_UART, portMAX_DELAY);
+            xTaskNotifyGive(dump_waiter);
+            vTaskDelete(NULL);
+        }
+        xQueueSend(dump_free, &block, portMAX_DELAY);
+    }
 }
 
 /*
-    Releases CPU from JTAG control. The target CPU
-    starts program execution with the address stored
-    at location 0x0FFFE (reset vector).
-    
-    This function is very distinct from ReleaseCPU!
+    Dumps target memory from start up to stop as framed binary
+    blocks on the console, overlapping JTAG reads with UART
+    output, and reports the end-to-end rate. The CPU must be
+    halted, and its PC is moved by the burst reads. The CPU is
+    left released by the last burst read.
 */
-void ReleaseDevice() {
-    IR_SHIFT(IR_CNTRL_SIG_16BIT);
-    DR_SHIFT((uint16_t) 0x2C01); // apply reset
-    DR_SHIFT((uint16_t) 0x2401); // remove reset
-    IR_SHIFT(IR_CNTRL_SIG_RELEASE);
+void DumpCode(uint16_t start, uint32_t stop) {
+    static DumpRange range;
+    DumpBlock *block;
+
+    range.start = start;
+    range.stop = stop;
+    dump_free = xQueueCreate(DUMP_BUFFERS, sizeof(DumpBlock *));
+    dump_full = xQueueCreate(DUMP_BUFFERS, sizeof(DumpBlock *));
+    for (int i = 0; i < DUMP_BUFFERS; i++) {
+        block = &dump_blocks[i];
+        xQueueSend(dump_free, &block, 0);
+    }
+    // buffered UART output lets the reads run while frames are sent
+    if (!uart_is_driver_installed(DUMP_UART)) {
+        uart_driver_install(DUMP_UART, 256, 2 * sizeof(DumpBlock), 0, NULL, 0);
+    }
+    fflush(stdout);
+    dump_waiter = xTaskGetCurrentTaskHandle();
+
+    int64_t begin = esp_timer_get_time();
+    xTaskCreate(DumpWriteTask, "dump_write", 4096, NULL, 5, NULL);
+    xTaskCreate(DumpReadTask, "dump_read", 4096, &range, 5, NULL);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    int64_t elapsed = esp_timer_get_time() - begin;
+
+    vQueueDelete(dump_free);
+    vQueueDelete(dump_full);
+    printf("\nDump: %lu bytes at %lld bytes/s\n", (unsigned long) (stop - start),
+           (long long) (((int64_t) (stop - start) * 1000000) / elapsed));
 }
 
 /*
-    Sets the CPU to instruction-fetch state. This is used
-    to execute an instruction presented by a host over the
-    JTAG port.
+    Times DR_SHIFT calls to report the TCK frequency reached
+    by the pin HAL. A DR_SHIFT is 25 TCK cycles, and IR_BYPASS
+    is selected so the shifts have no effect on the target.
 */
-void SetInstrFetch() {
-    IR_SHIFT(IR_CNTRL_SIG_CAPTURE);
-    uint16_t data = DR_SHIFT((uint16_t) 0x0000);
-    for (int i = 0; i < 8; i++) {
-        printf("InstrFetch: 0x%X\n", data);
-        if ((data & 0x0080) != 0) return;
-        ClrTCLK();
-        SetTCLK();
+void BenchmarkTCK() {
+    const int shifts = 1000;
+
+    IR_SHIFT(IR_BYPASS);
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < shifts; i++) {
+        DR_SHIFT((uint16_t) 0x0000);
     }
-    printf("SetInstrFetch Unsuccessful!\n");
+    int64_t elapsed = esp_timer_get_time() - start;
+    printf("TCK: %lld kHz over %d DR_SHIFTs\n", (25LL * shifts * 1000) / elapsed, shifts);
 }
 
 /*
-    Loads the target device CPU's program counter 
-    with the desired 16-bit address.
+    Reports how many words per second of target flash are
+    read by readMem() and by readMemQuick(). The CPU must be
+    halted, and is halted again in the instruction-fetch state
+    with its PC moved by the quick reads.
 */
-void SetPC(uint16_t addr) {
-    IR_SHIFT(IR_CNTRL_SIG_16BIT);
-    DR_SHIFT((uint16_t) 0x3401);
-    IR_SHIFT(IR_DATA_16BIT);
-    DR_SHIFT((uint16_t) 0x4030);
-    ClrTCLK();
-    SetTCLK();
-    DR_SHIFT(addr);
-    ClrTCLK();
-    SetTCLK();
-    IR_SHIFT(IR_ADDR_CAPTURE);
-    ClrTCLK();
-    IR_SHIFT(IR_CNTRL_SIG_16BIT);
-    DR_SHIFT((uint16_t) 0x2401);
-}
+void BenchmarkRead() {
+    static uint16_t words[1024];
+    const uint16_t length = sizeof(words) / sizeof(words[0]);
 
-/*
-    Force a power-up reset of CPU
-*/
-void ExecutePOR() {
-    IR_SHIFT(IR_CNTRL_SIG_16BIT);
-    DR_SHIFT((uint16_t) 0x2c01);
-    DR_SHIFT((uint16_t) 0x2401);
-    ClrTCLK();
-    SetTCLK();
-    ClrTCLK();
-    SetTCLK();
-    ClrTCLK();
-    IR_SHIFT(IR_ADDR_CAPTURE);
-    SetTCLK();
-}
+    int64_t start = esp_timer_get_time();
+    for (uint16_t i = 0; i < length; i++) {
+        words[i] = readMem(0xC000 + 2 * i);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+    printf("readMem: %lld words/s\n", (length * 1000000LL) / elapsed);
 
-/*
-    Stopping of the CPU via the HALT_JTAG bit of the JTAG
-    control signal register, which is set to 1 here.
-*/
-void HaltCPU() {
-    // Execute JMP $ instr to maintain state
-    IR_SHIFT(IR_DATA_16BIT);
-    DR_SHIFT((uint16_t) 0x3FFF);
-    ClrTCLK();
-    // set halt bit in cntrl signal
-    IR_SHIFT(IR_CNTRL_SIG_16BIT);
-    DR_SHIFT((uint16_t) 0x2409);
-    SetTCLK();
+    start = esp_timer_get_time();
+    readMemQuick(0xC000, words, length);
+    elapsed = esp_timer_get_time() - start;
+    printf("readMemQuick: %lld words/s\n", (length * 1000000LL) / elapsed);
+
+    // the burst read leaves the CPU released
+    if (!setInstrFetch()) {
+        printf("setInstrFetch Unsuccessful!\n");
+    }
+    haltCPU();
 }
 
 /*
-    Starting of the CPU via the HALT_JTAG bit of the JTAG
-    control signal register, which is set to 0 here.
+    Loads the flash mirror and reports how long the load, a
+    PSA check of the mirror and lookups from it take, listing
+    the code at the reset vector. The CPU must be halted.
 */
-void ReleaseCPU() {
-    ClrTCLK();
-    IR_SHIFT(IR_CNTRL_SIG_16BIT);
-    DR_SHIFT((uint16_t) 0x2401);
-    IR_SHIFT(IR_ADDR_CAPTURE);
-    SetTCLK();
+void BenchmarkMirror() {
+    int64_t start = esp_timer_get_time();
+    if (!LoadMirror()) {
+        printf("Mirror: PSA mismatch after load!\n");
+        return;
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+    printf("Mirror: loaded in %lld us\n", (long long) elapsed);
+
+    start = esp_timer_get_time();
+    bool valid = CheckMirror();
+    elapsed = esp_timer_get_time() - start;
+    printf("Mirror: PSA check %s in %lld us\n", valid ? "passed" : "failed", (long long) elapsed);
+
+    uint16_t reset = MirrorWord(0xFFFE);
+    start = esp_timer_get_time();
+    uint16_t prev = MirrorPrev(0xFFFE);
+    elapsed = esp_timer_get_time() - start;
+    printf("Mirror: previous of 0xfffe is 0x%.4x, found in %lld us\n", prev, (long long) elapsed);
+    ListMirror(reset, 8);
 }
 
 /*
-    Reads one word (2 bytes) of memory at addr.
+    Reads one line from the console UART into line, echoing it,
+    without the line ending. Characters past size - 1 are dropped.
 */
-uint16_t ReadMem(uint16_t addr) {
-    ClrTCLK();
-    IR_SHIFT(IR_CNTRL_SIG_16BIT);
-    DR_SHIFT((uint16_t) 0x2409); // one word, not byte
-    IR_SHIFT(IR_ADDR_16BIT);
-    DR_SHIFT(addr);
-    IR_SHIFT(IR_DATA_TO_ADDR);
-    SetTCLK();
-    ClrTCLK();
-    uint16_t data = DR_SHIFT((uint16_t) 0x0000);
-    return data;
-}
+void ReadLine(char *line, int size) {
+    int length = 0;
+    char c;
 
-void WriteMem(uint16_t addr, uint16_t data) {
-    ClrTCLK();
-    IR_SHIFT(IR_CNTRL_SIG_16BIT);
-    DR_SHIFT((uint16_t) 0x2408);
-    // printf("\tcontrol check: \n");
-    // IR_SHIFT(IR_CNTRL_SIG_CAPTURE);
-    // printf("\tcontrol signal is: 0x%.4x\n", DR_SHIFT(0x1111));
-    IR_SHIFT(IR_ADDR_16BIT);
-    DR_SHIFT(addr);
-    // printf("\taddress check: \n");
-    // IR_SHIFT(IR_ADDR_CAPTURE);
-    // printf("\tAddress is: 0x%.4x\n", DR_SHIFT(0x4444));
-    IR_SHIFT(IR_DATA_TO_ADDR);
-    DR_SHIFT(data);
-    SetTCLK();
-}
-
-void RWTest() {
-    // write data
-    uint16_t addr1 = 0xFFF0; // part of RAM (I think)
-    uint16_t addr2 = 0xFF88;
-    uint16_t addr3 = 0x0332;
-    uint16_t addr4 = 0x0200;
-    // WriteMem(addr1, 0xDEAD);
-    // WriteMem(addr2, 0xBEEF);
-    WriteMem(addr3, 0xB0BA);
-    WriteMem(addr4, 0xCAFE);
-    ReadMem(addr1);
-    ReadMem(addr2);
-    ReadMem(addr3);
-    ReadMem(addr4);
-}
-
-void ReadCode(uint16_t start_addr, uint16_t stop_addr) {
-    for (uint16_t curr_addr = start_addr; curr_addr < stop_addr; curr_addr+=4) {
-        if (curr_addr % 64 == 0) {
-            printf("\nAddress 0x%.4x: ", curr_addr);
+    while (true) {
+        if (uart_read_bytes(DUMP_UART, &c, 1, portMAX_DELAY) != 1) {
+            continue;
+        }
+        if (c == '\r' || c == '\n') {
+            break;
+        }
+        if (c == '\b' || c == 0x7F) {
+            if (length > 0) {
+                length--;
+                uart_write_bytes(DUMP_UART, "\b \b", 3);
+            }
+            continue;
+        }
+        if (length < size - 1) {
+            line[length++] = c;
+            uart_write_bytes(DUMP_UART, &c, 1);
         }
-        printf("0x%.4x ", ReadMem(curr_addr));
     }
-    printf("\n");
+    line[length] = '\0';
+    uart_write_bytes(DUMP_UART, "\r\n", 2);
 }
 
-void RegisterTest() {
-    uint8_t output;
-    for (uint8_t i = 0; i < 10; i++) {
-        output = IR_SHIFT(i);
-        if (output != (uint8_t) 0x89) {
-            printf("IR_SHIFT failed to return JTAG ID!\n");
-            return;
-        }
-    }
-    printf("IR_SHIFT test successful...\n");
-    printf("Setting IR to IR_ADDR_16BIT, ie. 0x83\n");
-    IR_SHIFT((uint8_t) 0x83);
-    uint16_t output2;
-    DR_SHIFT((uint16_t) 0);
-    output2 = DR_SHIFT((uint16_t) 0x4411);
-    if (output2 != (uint16_t) 0) {
-        printf("DR_SHIFT failed to return previous input data!\n");
-        printf("Expected: 0x%x\n", (uint16_t) 0x0000);
-        printf("Received: 0x%x\n", (uint16_t) output2);
-        return;
-    }
-    output2 = DR_SHIFT((uint16_t) 0xDEAD);
-    if (output2 != (uint16_t) 0x4411) {
-        printf("DR_SHIFT failed to return previous input data! %x\n", 0x4411);
-        return;
+/*
+    Answers navigation, listing and search commands from the
+    flash mirror until quit is entered, keeping a cursor on
+    an instruction:
+      list [address] [count]  list count instructions from address,
+                              or CONSOLE_LIST from the cursor
+      next, prev              move the cursor one instruction
+      search word             move the cursor to the next occurrence
+                              of word after it, wrapping around
+      check                   compare the mirror with the target PSA
+      quit                    leave the console
+    Numbers are hexadecimal. The mirror must be loaded, and the
+    CPU halted for check.
+*/
+void MirrorConsole() {
+    char line[CONSOLE_LINE];
+    char command[8];
+    unsigned int first, second;
+    uint16_t cursor = MirrorWord(0xFFFE); // the reset vector
+    int32_t found;
+    int64_t start;
+    int args;
+
+    if (!uart_is_driver_installed(DUMP_UART)) {
+        uart_driver_install(DUMP_UART, 256, 0, 0, NULL, 0);
     }
-    output2 = DR_SHIFT((uint16_t) 0xDEAD);
-    if (output2 != (uint16_t) 0xDEAD) {
-        printf("DR_SHIFT failed to return previous input data! %x\n", 0xDEAD);
-        return;
+    printf("Mirror console: list, next, prev, search, check, quit\n");
+    while (true) {
+        printf("0x%.4x> ", cursor);
+        fflush(stdout);
+        ReadLine(line, sizeof(line));
+        args = sscanf(line, "%7s %x %x", command, &first, &second);
+        if (args < 1) {
+            continue;
+        }
+        if (strcmp(command, "quit") == 0) {
+            break;
+        }
+        if (!IsMirrorLoaded()) {
+            printf("Mirror not loaded!\n");
+            continue;
+        }
+        start = esp_timer_get_time();
+        if (strcmp(command, "list") == 0) {
+            ListMirror((args >= 2) ? first : cursor, (args >= 3) ? second : CONSOLE_LIST);
+        } else if (strcmp(command, "next") == 0) {
+            cursor = MirrorNext(cursor);
+            ListMirror(cursor, 1);
+        } else if (strcmp(command, "prev") == 0) {
+            cursor = MirrorPrev(cursor);
+            ListMirror(cursor, 1);
+        } else if (strcmp(command, "search") == 0 && args >= 2) {
+            found = FindMirror(cursor + 2, first);
+            if (found < 0) {
+                found = FindMirror(MIRROR_START, first); // wrap around
+            }
+            if (found < 0) {
+                printf("0x%.4x not found\n", first);
+                continue;
+            }
+            cursor = found;
+            ListMirror(cursor, 1);
+        } else if (strcmp(command, "check") == 0) {
+            printf("Mirror %s\n", CheckMirror() ? "matches the target" : "is stale, dropped");
+        } else {
+            printf("Unknown command %s\n", command);
+            continue;
+        }
+        printf("(%lld us)\n", (long long) (esp_timer_get_time() - start));
     }
+}
 
-    printf("Setting IR to IR_BYPASS, ie. 0xFF\n");
-    IR_SHIFT((uint8_t) 0xFF);
-    DR_SHIFT((uint16_t) 0);
-    output2 = DR_SHIFT((uint16_t) 0x4411);
-    if (output2 != (uint16_t) 0x2208) {
-        printf("DR_SHIFT failed to return previous input data! %x\n", 0x2208);
-        return;
-    }
-    DR_SHIFT((uint16_t) 0xFFFF);
-    output2 = DR_SHIFT((uint16_t) 0x8EAD);
-    if (output2 != (uint16_t) 0x4756) {
-        printf("DR_SHIFT failed to return previous input data! %x\n", 0x4756);
-        return;
+#ifdef JTAG_PIN_TRACE
+/*
+    Checks the edge sequence of a DR_SHIFT against the JTAG
+    state machine: TMS and TDI are sampled at each rising
+    edge of TCK, exactly as the target sees them.
+*/
+void TraceTest() {
+    // TMS at each of the 25 TCK rising edges of a DR_SHIFT
+    const uint8_t tms[25] = {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                             1, 1, 0, 0, 0, 0, 0};
+    const uint16_t data = 0xA5A5;
+    uint32_t tms_level = pinDriven(TMS), tdi_level = pinDriven(TDI);
+    int edge = 0;
+
+    pin_trace_length = 0;
+    DR_SHIFT(data);
+    for (int i = 0; i < pin_trace_length; i++) {
+        if (pin_trace[i].pin == TMS) {
+            tms_level = pin_trace[i].level;
+        } else if (pin_trace[i].pin == TDI) {
+            tdi_level = pin_trace[i].level;
+        } else if (pin_trace[i].pin == TCK && pin_trace[i].level == HIGH) {
+            if (edge >= 25 || tms_level != tms[edge]) {
+                printf("Trace: bad TMS at TCK edge %d\n", edge);
+                return;
+            }
+            // data bits are clocked in at edges 3 to 18, MSB first
+            if (edge >= 3 && edge < 19 && tdi_level != ((data >> (18 - edge)) & 1)) {
+                printf("Trace: bad TDI at TCK edge %d\n", edge);
+                return;
+            }
+            edge++;
+        }
     }
-    DR_SHIFT((uint16_t) 0);
-    output2 = DR_SHIFT((uint16_t) 0xBEEF);
-    if (output2 != (uint16_t) 0x5F77) {
-        printf("DR_SHIFT failed to return previous input data! %x\n", 0x5F77);
+    if (edge != 25) {
+        printf("Trace: %d TCK edges, expected 25\n", edge);
         return;
     }
-
-    printf("DR_SHIFT test successful...\n");
-    return;
+    printf("Trace test successful...\n");
 }
+#endif
 
 /*
     Drives one JTAG command on the MSP430 via standard
@@ -425,68 +426,52 @@ void app_main(void)
     gpio_reset_pin(TDI);
     gpio_reset_pin(TDO);
     gpio_reset_pin(TEN);
-    gpio_set_direction(RST, OUTPUT);
-    gpio_set_direction(TMS, OUTPUT);
-    gpio_set_direction(TCK, OUTPUT);
-    gpio_set_direction(TDI, OUTPUT);
-    gpio_set_direction(TDO, INPUT);
-    gpio_set_direction(TEN, OUTPUT);
-    gpio_set_pull_mode(TDO, GPIO_PULLDOWN_ONLY);
-
-    // enable JTAG access: case 2a, Fig.2-13
-    // RST held low for JTAG, high for SBW
-    gpio_set_level(RST, HIGH);
-    gpio_set_level(TEN, LOW);
-        // there is a ~28 microsecond delay
-    gpio_set_level(TEN, HIGH);
-    gpio_set_level(RST, LOW);
-    gpio_set_level(TEN, LOW);
-    gpio_set_level(TEN, HIGH);
-    gpio_set_level(RST, HIGH);
-
-    // Move TAP FSM to Run/IDLE for fuse check
-    gpio_set_level(TMS, HIGH);
-    for (int i = 0; i < 6; i++) {
-        gpio_set_level(TCK, LOW);
-        gpio_set_level(TCK, HIGH);  // FSM: TLR
+
+#ifdef JTAG_PIN_DEDICATED
+    InitDedicatedPins();
+#endif
+
+    // enable JTAG access and sync, see jtag_fsm.c and jtag_control.c
+    initFSM();
+    printf("Syncing CPU...\n");
+    if (!getDevice()) {
+        printf("Sync failed!\n");
+        releaseFSM();
+        return;
+    }
+    printf("Sync Successful!\n");
+    if (!setInstrFetch()) {
+        printf("setInstrFetch Unsuccessful!\n");
     }
-    gpio_set_level(TMS, LOW);
-    gpio_set_level(TDI, HIGH);  // FSM: IDLE
-    gpio_set_level(TCK, LOW);
-    gpio_set_level(TCK, HIGH);
-
-    gpio_set_level(TCK, LOW); 
-    gpio_set_level(TCK, HIGH);
-
-    // fuse check
-    gpio_set_level(TMS, HIGH);   
-    gpio_set_level(TMS, LOW);   
-    gpio_set_level(TMS, HIGH);
-    gpio_set_level(TMS, LOW);
-    gpio_set_level(TMS, HIGH);
-    gpio_set_level(TMS, LOW);
-
-    // Sync and halt CPU
-    GetDevice();
-    SetInstrFetch();
     printf("Halting CPU...\n");
-    HaltCPU();
+    haltCPU();
+#ifdef JTAG_PIN_TRACE
+    TraceTest();
+#endif
+    BenchmarkTCK();
+    BenchmarkRead();
+    BenchmarkMirror();
 
 
-    // read data
+    // dump flash, see dump_decode.py to rebuild the image
     printf("\n");
-    for (uint16_t curr_start = 0xC000; curr_start <= 0xE000; curr_start += (uint16_t) 0x1000) {
-        ReadCode(curr_start, curr_start + 0x1000);
-        printf("\n");
+    DumpCode(0xC000, 0x10000);
+
+    // the dump leaves the CPU released, check needs it halted
+    if (!setInstrFetch()) {
+        printf("setInstrFetch Unsuccessful!\n");
     }
+    haltCPU();
+    printf("\n");
+    MirrorConsole();
 
     // Exit JTAG
     printf("\n");
     printf("Releasing CPU...\n");
-    ReleaseCPU();
+    releaseCPU();
     // relinquish JTAG access
-    ReleaseDevice();
-    gpio_set_level(TEN, LOW);
+    releaseDevice();
+    releaseFSM();
     vTaskDelay(1 / portTICK_PERIOD_MS);
     // gpio_set_level(RST, LOW);
     // vTaskDelay(1 / portTICK_PERIOD_MS);
@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include "jtag_control.h"
+#include "jtag_mirror.h"
+
+static uint16_t mirror[MIRROR_WORDS];
+static uint16_t mirror_psa;
+static bool mirror_loaded;
+
+/*
+    Returns true if address lies inside a loaded mirror.
+*/
+static inline bool inMirror(uint16_t address) {
+    return mirror_loaded && address >= MIRROR_START && address - MIRROR_START < 2 * MIRROR_WORDS;
+}
+
+/*
+    Burst reads the target flash into the mirror and records
+    its PSA signature. The signature is checked against the
+    PSA of the target straight away, which catches a transfer
+    that went wrong. The CPU must be halted, and is left
+    halted in the instruction-fetch state.
+
+    Returns: True if the mirror was loaded and verified.
+*/
+bool LoadMirror() {
+    mirror_loaded = false;
+    readMemQuick(MIRROR_START, mirror, MIRROR_WORDS);
+    setInstrFetch(); // the burst read leaves the CPU released
+    haltCPU();
+    mirror_psa = calcPSA(MIRROR_START, mirror, MIRROR_WORDS);
+    mirror_loaded = CheckMirror();
+    return mirror_loaded;
+}
+
+/*
+    Compares the PSA of the target flash with the signature of
+    the mirror, so a stale mirror can be detected after the
+    target was reprogrammed or ran. On a mismatch the mirror
+    is dropped until LoadMirror() is called again. The CPU
+    must be halted, and is left halted in the
+    instruction-fetch state.
+
+    Returns: True if the mirror matches the target flash.
+*/
+bool CheckMirror() {
+    uint16_t psa;
+    bool valid = getPSA(MIRROR_START, MIRROR_WORDS, &psa);
+
+    setInstrFetch();
+    haltCPU();
+    if (!valid || psa != mirror_psa) {
+        mirror_loaded = false;
+        return false;
+    }
+    return true;
+}
+
+bool IsMirrorLoaded() {
+    return mirror_loaded;
+}
+
+/*
+    Returns: The word at address, from the mirror if possible.
+*/
+uint16_t MirrorWord(uint16_t address) {
+    if (inMirror(address)) {
+        return mirror[(address - MIRROR_START) >> 1];
+    }
+    return readMem(address);
+}
+
+/*
+    Fills instr with the three words at address that an
+    instruction can span.
+*/
+void MirrorFetch(Instruction *instr, uint16_t address) {
+    instr->address = address;
+    instr->operator = MirrorWord(address);
+    instr->source = MirrorWord(address + 2);
+    instr->destination = MirrorWord(address + 4);
+}
+
+/*
+    Returns: The address of the instruction after the one
+    at address.
+*/
+uint16_t MirrorNext(uint16_t address) {
+    int length = instructionLength(MirrorWord(address));
+    return address + ((length < 0) ? 2 : (length << 1));
+}
+
+/*
+    Returns: The address of the instruction before the one at
+    address, found by decoding forward from MIRROR_START as
+    the debugger does for its up button.
+*/
+uint16_t MirrorPrev(uint16_t address) {
+    uint16_t curr = MIRROR_START, prev = MIRROR_START, next;
+
+    while (curr < address) {
+        prev = curr;
+        next = MirrorNext(curr);
+        if (next <= curr) {
+            break; // wrapped past the end of memory
+        }
+        curr = next;
+    }
+    return prev;
+}
+
+/*
+    Prints one line of a listing.
+*/
+static void printLine(const DecodedInstruction *decoded, const uint16_t *words) {
+    char buffer[INSTRUCTION_TEXT_SIZE];
+
+    formatInstruction(buffer, decoded);
+    printf("0x%.4x: %s\n", decoded->address, buffer);
+}
+
+/*
+    Prints count instructions beginning at address.
+*/
+void ListMirror(uint16_t address, uint16_t count) {
+    disassembleRange(MirrorWord, address, count, printLine);
+}
+
+/*
+    Searches the mirror for word from start onwards.
+
+    Returns: The address of the first match, or -1 if there
+    is none or the mirror is not loaded.
+*/
+int32_t FindMirror(uint16_t start, uint16_t word) {
+    if (!inMirror(start)) {
+        return -1;
+    }
+    for (uint32_t i = (start - MIRROR_START) >> 1; i < MIRROR_WORDS; i++) {
+        if (mirror[i] == word) {
+            return MIRROR_START + 2 * i;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,35 @@
+/*
+    Mirror of the target flash.
+
+    The ESP32-S2 has enough RAM to hold the whole 16KB flash
+    of the G2553, so it is burst read once by LoadMirror()
+    and navigation, listing and search requests are then
+    answered from RAM instead of with JTAG scans. The PSA
+    signature of the image is kept so that CheckMirror() can
+    tell whether the target flash changed with a single PSA
+    pass instead of reading it back.
+
+    Addresses outside the mirror, or any address while the
+    mirror is not loaded, fall back to readMem().
+*/
+#ifndef JTAG_MIRROR_H
+#define JTAG_MIRROR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "disassembler.h"
+
+#define MIRROR_START 0xC000
+#define MIRROR_WORDS 8192 // 16KB, up to the end of the vector table
+
+bool LoadMirror();
+bool CheckMirror();
+bool IsMirrorLoaded();
+uint16_t MirrorWord(uint16_t address);
+void MirrorFetch(Instruction *instr, uint16_t address);
+uint16_t MirrorNext(uint16_t address);
+uint16_t MirrorPrev(uint16_t address);
+void ListMirror(uint16_t address, uint16_t count);
+int32_t FindMirror(uint16_t start, uint16_t word);
+
+#endif
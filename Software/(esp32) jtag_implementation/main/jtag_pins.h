@@ -0,0 +1,213 @@
+/*
+    Pin HAL for the JTAG lines.
+
+    By default pins are driven by writing the GPIO set/clear
+    registers directly, which skips the argument checking
+    and locking of gpio_set_level()/gpio_get_level(). Pins
+    0-31 live in the first GPIO bank and pins 32-53 in the
+    second. The pins are compile time constants, so each
+    call folds down to a single register write.
+
+    Define JTAG_PIN_DEDICATED to drive TCK, TMS and TDI
+    and sample TDO through the dedicated GPIO bundles of
+    the ESP32-S2 instead, which the CPU reaches in a single
+    cycle without going through the APB bus. TCK is then
+    slowed by JTAG_TCK_NOPS per half period so it stays
+    within the 10MHz TCK limit of the target.
+
+    Define JTAG_PIN_DRIVER to go back through the GPIO
+    driver, eg to compare TCK frequencies. Define
+    JTAG_PIN_TRACE to also log every pin write into
+    pin_trace, so the edge sequence of a scan can be
+    checked against the JTAG state machine.
+*/
+#ifndef JTAG_PINS_H
+#define JTAG_PINS_H
+
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+#ifdef JTAG_PIN_DEDICATED
+#include "driver/dedic_gpio.h"
+#include "hal/dedic_gpio_cpu_ll.h"
+#endif
+
+// JTAG pins are from the perspective of the MSP430
+#define RST GPIO_NUM_14 // MSP430 reset                     (RX)  ->  (16) s2 (14/22)(GPIO/PHYSICAL)
+#define TMS GPIO_NUM_45 // JTAG state machine control       (TX)  ->  (7)     (45/26)
+#define TCK GPIO_NUM_34 // JTAG clock input                 (MO)  ->  (6)     (34/26)
+#define TDI GPIO_NUM_33 // JTAG data input and TCLK input   (MI)  ->  (14)    (33/24)
+#define TDO GPIO_NUM_21 // JTAG data output                 (21)  ->  (15)    (21/23)
+#define TEN GPIO_NUM_13 // JTAG enable                      (SCL) ->  (17)    (13/21)
+
+#ifdef JTAG_PIN_TRACE
+#define PIN_TRACE_DEPTH 512
+
+typedef struct {
+    uint8_t pin;
+    uint8_t level;
+} PinEdge;
+
+extern PinEdge pin_trace[PIN_TRACE_DEPTH];
+extern uint16_t pin_trace_length;
+
+static inline void tracePin(gpio_num_t pin, uint32_t level) {
+    if (pin_trace_length < PIN_TRACE_DEPTH) {
+        pin_trace[pin_trace_length].pin = pin;
+        pin_trace[pin_trace_length].level = level;
+        pin_trace_length++;
+    }
+}
+#else
+#define tracePin(pin, level)
+#endif
+
+#ifdef JTAG_PIN_DRIVER
+
+static inline void pinHigh(gpio_num_t pin) {
+    tracePin(pin, 1);
+    gpio_set_level(pin, 1);
+}
+
+static inline void pinLow(gpio_num_t pin) {
+    tracePin(pin, 0);
+    gpio_set_level(pin, 0);
+}
+
+static inline uint32_t pinRead(gpio_num_t pin) {
+    return gpio_get_level(pin);
+}
+
+#else
+
+#ifdef JTAG_PIN_DEDICATED
+#ifndef JTAG_TCK_NOPS
+#define JTAG_TCK_NOPS 8
+#endif
+
+// channels of the output bundle, which must be the first bundle
+// created so that its channels start at bit 0
+#define DEDIC_TCK (1UL << 0)
+#define DEDIC_TMS (1UL << 1)
+#define DEDIC_TDI (1UL << 2)
+// TDO is channel 0 of the input bundle
+#define DEDIC_TDO (1UL << 0)
+
+static inline uint32_t dedicMask(gpio_num_t pin) {
+    return (pin == TCK) ? DEDIC_TCK : (pin == TMS) ? DEDIC_TMS : (pin == TDI) ? DEDIC_TDI : 0;
+}
+
+static inline void tckDelay() {
+    for (int i = 0; i < JTAG_TCK_NOPS; i++) {
+        __asm__ __volatile__("nop");
+    }
+}
+#endif
+
+static inline void pinHigh(gpio_num_t pin) {
+    tracePin(pin, 1);
+#ifdef JTAG_PIN_DEDICATED
+    if (dedicMask(pin) != 0) {
+        dedic_gpio_cpu_ll_write_mask(dedicMask(pin), dedicMask(pin));
+        if (pin == TCK) {
+            tckDelay();
+        }
+        return;
+    }
+#endif
+    if (pin < 32) {
+        REG_WRITE(GPIO_OUT_W1TS_REG, 1UL << pin);
+    } else {
+        REG_WRITE(GPIO_OUT1_W1TS_REG, 1UL << (pin - 32));
+    }
+}
+
+static inline void pinLow(gpio_num_t pin) {
+    tracePin(pin, 0);
+#ifdef JTAG_PIN_DEDICATED
+    if (dedicMask(pin) != 0) {
+        dedic_gpio_cpu_ll_write_mask(dedicMask(pin), 0);
+        if (pin == TCK) {
+            tckDelay();
+        }
+        return;
+    }
+#endif
+    if (pin < 32) {
+        REG_WRITE(GPIO_OUT_W1TC_REG, 1UL << pin);
+    } else {
+        REG_WRITE(GPIO_OUT1_W1TC_REG, 1UL << (pin - 32));
+    }
+}
+
+static inline uint32_t pinRead(gpio_num_t pin) {
+#ifdef JTAG_PIN_DEDICATED
+    if (pin == TDO) {
+        return (dedic_gpio_cpu_ll_read_in() & DEDIC_TDO) != 0;
+    }
+#endif
+    if (pin < 32) {
+        return (REG_READ(GPIO_IN_REG) >> pin) & 1;
+    }
+    return (REG_READ(GPIO_IN1_REG) >> (pin - 32)) & 1;
+}
+
+#endif
+
+/*
+    Sets pin to level.
+*/
+static inline void pinSet(gpio_num_t pin, uint32_t level) {
+    if (level) {
+        pinHigh(pin);
+    } else {
+        pinLow(pin);
+    }
+}
+
+/*
+    Returns the level an output pin is driven to. Unlike
+    pinRead() this works for pins with their input disabled.
+*/
+static inline uint32_t pinDriven(gpio_num_t pin) {
+#ifdef JTAG_PIN_DEDICATED
+    if (dedicMask(pin) != 0) {
+        return (dedic_gpio_cpu_ll_read_out() & dedicMask(pin)) != 0;
+    }
+#endif
+    if (pin < 32) {
+        return (REG_READ(GPIO_OUT_REG) >> pin) & 1;
+    }
+    return (REG_READ(GPIO_OUT1_REG) >> (pin - 32)) & 1;
+}
+
+/*
+    One TCK pulse, low then high.
+*/
+static inline void clockTCK(gpio_num_t tck) {
+    pinLow(tck);
+    pinHigh(tck);
+}
+
+/*
+    Makes TDO an input with a pulldown and the other JTAG
+    pins outputs, keeping the levels already written. Used
+    by initFSM() and resumeFSM() through JTAG_CLAIM_PINS().
+    Pins routed to a dedicated GPIO bundle are left alone,
+    as gpio_set_direction() would reconnect them to the
+    GPIO output registers.
+*/
+static inline void jtagClaimPins() {
+    gpio_set_direction(RST, GPIO_MODE_OUTPUT);
+    gpio_set_direction(TEN, GPIO_MODE_OUTPUT);
+#ifndef JTAG_PIN_DEDICATED
+    gpio_set_direction(TMS, GPIO_MODE_OUTPUT);
+    gpio_set_direction(TCK, GPIO_MODE_OUTPUT);
+    gpio_set_direction(TDI, GPIO_MODE_OUTPUT);
+    gpio_set_direction(TDO, GPIO_MODE_INPUT);
+#endif
+    gpio_set_pull_mode(TDO, GPIO_PULLDOWN_ONLY);
+}
+
+#endif
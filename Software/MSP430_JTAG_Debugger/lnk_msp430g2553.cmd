@@ -61,7 +61,8 @@ MEMORY
     INFOB                   : origin = 0x1080, length = 0x0040
     INFOC                   : origin = 0x1040, length = 0x0040
     INFOD                   : origin = 0x1000, length = 0x0040
-    FLASH                   : origin = 0xC000, length = 0x3FDE
+    CHECKPOINT              : origin = 0xC000, length = 0x0400 /* target checkpoint, see checkpoint_store.h */
+    FLASH                   : origin = 0xC400, length = 0x3BDE
     BSLSIGNATURE            : origin = 0xFFDE, length = 0x0002, fill = 0xFFFF
     INT00                   : origin = 0xFFE0, length = 0x0002
     INT01                   : origin = 0xFFE2, length = 0x0002
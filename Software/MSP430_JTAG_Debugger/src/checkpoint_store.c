@@ -0,0 +1,76 @@
+/*
+ * checkpoint_store.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "jtag_checkpoint.h"
+#include "checkpoint_store.h"
+#include "flash_control.h"
+
+/* A target checkpoint kept in debugger flash, so that it survives a
+ * power cycle of the debugger and does not need RAM a G2553 does not
+ * have. The segments are erased when a new checkpoint is started and
+ * the magic is written last, so an interrupted checkpoint leaves no
+ * record.
+ */
+struct CheckpointRecord {
+    uint16_t words[CHECKPOINT_WORDS];
+    uint16_t magic;
+};
+
+#define CHECKPOINT_RECORD ((volatile struct CheckpointRecord *) CHECKPOINT_STORE_ADDR)
+
+static void saveWords(uint16_t offset, const uint16_t *words, uint16_t count);
+static void loadWords(uint16_t offset, uint16_t *words, uint16_t count);
+
+static const CheckpointStore flash_store = {saveWords, loadWords};
+
+/*
+ * Programs the words of a checkpoint into flash, erasing the record
+ * first when a checkpoint starts at offset 0. Interrupts are held off
+ * while the flash controller is busy.
+ */
+static void saveWords(uint16_t offset, const uint16_t *words, uint16_t count) {
+    uint16_t i, interrupts;
+
+    interrupts = unlockFlash();
+    if (offset == 0) {
+        for (i = 0; i < sizeof(struct CheckpointRecord); i += CHECKPOINT_SEGMENT) {
+            eraseSegment(&CHECKPOINT_RECORD->words[i / 2]);
+        }
+    }
+    for (i = 0; i < count; i++) {
+        writeFlashWord(&CHECKPOINT_RECORD->words[offset + i], words[i]);
+    }
+    if (offset + count == CHECKPOINT_WORDS) {
+        writeFlashWord(&CHECKPOINT_RECORD->magic, CHECKPOINT_MAGIC);
+    }
+    lockFlash(interrupts);
+}
+
+static void loadWords(uint16_t offset, uint16_t *words, uint16_t count) {
+    uint16_t i;
+
+    for (i = 0; i < count; i++) {
+        words[i] = CHECKPOINT_RECORD->words[offset + i];
+    }
+}
+
+/*
+ * Returns the store that keeps a checkpoint in debugger flash, to be
+ * passed to checkpoint() and restore().
+ */
+const CheckpointStore *getFlashStore() {
+    return &flash_store;
+}
+
+/*
+ * Returns: True if a complete checkpoint is held in flash.
+ */
+bool isCheckpointStored() {
+    return CHECKPOINT_RECORD->magic == CHECKPOINT_MAGIC;
+}
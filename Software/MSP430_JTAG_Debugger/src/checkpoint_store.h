@@ -0,0 +1,27 @@
+/*
+ * checkpoint_store.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ */
+
+#ifndef SRC_CHECKPOINT_STORE_H_
+#define SRC_CHECKPOINT_STORE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "jtag_checkpoint.h"
+
+/*** Two main flash segments kept out of the code by the linker command file ***/
+#ifdef __MSP430F5529__
+#define CHECKPOINT_STORE_ADDR (0x4400)
+#else
+#define CHECKPOINT_STORE_ADDR (0xC000)
+#endif
+#define CHECKPOINT_SEGMENT    (512)
+#define CHECKPOINT_MAGIC      (0x4350)
+
+const CheckpointStore *getFlashStore();
+bool isCheckpointStored();
+
+#endif /* SRC_CHECKPOINT_STORE_H_ */
@@ -0,0 +1,62 @@
+/*
+ * flash_control.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ */
+#include <msp430.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "flash_control.h"
+
+/* Programming of the debugger's own flash, shared by the navigation
+ * index and the checkpoint store. Every erase and write goes through
+ * here, so a host build can put a simulated flash in its place.
+ */
+
+/*
+ * Unlocks the flash controller with interrupts held off, which they
+ * must be while it is busy.
+ *
+ * Returns: The interrupt state to pass to lockFlash().
+ */
+uint16_t unlockFlash() {
+    uint16_t interrupts = __get_SR_register() & GIE;
+
+    __disable_interrupt();
+#ifndef __MSP430F5529__
+    FCTL2 = FWKEY + FSSEL_1 + FN1; // MCLK / 3 for the flash timing generator
+#endif
+    FCTL3 = FWKEY; // unlock
+    return interrupts;
+}
+
+/*
+ * Locks the flash controller again and restores the interrupt state
+ * unlockFlash() returned.
+ */
+void lockFlash(uint16_t interrupts) {
+    FCTL3 = FWKEY + LOCK;
+    __bis_SR_register(interrupts);
+}
+
+/*
+ * Erases the flash segment holding address. The flash must be
+ * unlocked.
+ */
+void eraseSegment(volatile uint16_t *address) {
+    FCTL1 = FWKEY + ERASE;
+    *address = 0; // dummy write starts the segment erase
+    FCTL1 = FWKEY;
+}
+
+/*
+ * Programs one word of erased flash. Programming can only clear
+ * bits. The flash must be unlocked.
+ */
+void writeFlashWord(volatile uint16_t *address, uint16_t value) {
+    FCTL1 = FWKEY + WRT;
+    *address = value;
+    FCTL1 = FWKEY;
+}
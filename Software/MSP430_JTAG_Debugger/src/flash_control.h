@@ -0,0 +1,19 @@
+/*
+ * flash_control.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ */
+
+#ifndef SRC_FLASH_CONTROL_H_
+#define SRC_FLASH_CONTROL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+uint16_t unlockFlash();
+void lockFlash(uint16_t interrupts);
+void eraseSegment(volatile uint16_t *address);
+void writeFlashWord(volatile uint16_t *address, uint16_t value);
+
+#endif /* SRC_FLASH_CONTROL_H_ */
@@ -8,6 +8,45 @@
 #include "jtag_control.h"
 #include "disassembler.h"
 #include "buttons.h"
+#include "nav_index.h"
+#ifdef COVERAGE_STEPS
+#include "jtag_coverage.h"
+#endif
+#ifdef CHECKPOINT_TARGET
+#include "checkpoint_store.h"
+#endif
+#ifdef WATCH_ADDRESS
+#include "jtag_eem.h"
+#include "jtag_config.h"
+
+#ifndef WATCH_ACCESS
+#define WATCH_ACCESS (WATCH_WRITE)
+#endif
+#ifndef WATCH_TIMEOUT
+#define WATCH_TIMEOUT (30000) // ms before a watchpoint is given up on
+#endif
+#endif
+
+/*
+ * Debugger state kept in RAM that is left alone at startup, so a
+ * press of RESET can reconnect to a target that is still halted
+ * under JTAG control instead of rerunning the JTAG entry sequence.
+ */
+struct Session {
+    /* SESSION_MAGIC while the rest of the session is valid */
+    uint16_t magic;
+    /* Address of the top displayed instruction */
+    uint16_t curr_addr;
+    /* True while assembly rather than machine code is shown */
+    bool show_asm;
+    /* Level of TCLK when the session was last saved */
+    bool tclk;
+};
+
+#define SESSION_MAGIC (0x5E55)
+
+#pragma NOINIT(session)
+static struct Session session;
 
 #pragma vector=BTN_VECT
 interrupt void buttonIRQ(void) {
@@ -109,104 +148,198 @@ inline void initBackchannel() {
 }
 
 void handleJump(uint16_t *curr_addr) {
-    uint16_t jump_addr, operator, src_bytes;
-    opCode opcode;
-
-    operator = readMem(*curr_addr);
-    opcode = getOpCode(operator);
-    jump_addr = 0;
-    if (opcode.format == JUMP) {
-        jump_addr = getJumpLocation(operator, *curr_addr);
-    } else if (isCall(&opcode)) {
-        src_bytes = readMem(*curr_addr + 2);
-        jump_addr = getCallLocation(operator, src_bytes, *curr_addr);
+    Instruction instr;
+    DecodedInstruction decoded;
+
+    instr.address = *curr_addr;
+    instr.operator = readMem(*curr_addr);
+    instr.source = 0;
+    instr.destination = 0;
+    if (instructionLength(instr.operator) > 1) {
+        instr.source = readMem(*curr_addr + 2); // call target
     }
-    if (jump_addr != 0 && jump_addr >= 0xC000 && jump_addr < 0xFFFF) {
-        *curr_addr = jump_addr;
+    decode(&decoded, &instr);
+    if (decoded.target >= 0xC000 && decoded.target < 0xFFFF) {
+        *curr_addr = decoded.target;
     }
 }
 
 void handleUp(uint16_t *curr_addr) {
-    Instruction instr;
-    uint16_t prev_addr;
-
-    instr.address = 0xC000;
-    while (instr.address < *curr_addr) {
-        instr.operator = readMem(instr.address);
-        instr.source = readMem(instr.address + 2);
-        instr.destination = readMem(instr.address + 4);
-        prev_addr = instr.address;
-        nextAddress(&(instr.address), &instr);
-    }
-    *curr_addr = prev_addr;
+    *curr_addr = prevInstruction(*curr_addr);
 }
 
 void handleDown(uint16_t *curr_addr) {
-    Instruction instr;
+    int length;
 
-    instr.address = *curr_addr;
-    instr.operator = readMem(instr.address);
-    instr.source = readMem(instr.address + 2);
-    instr.destination = readMem(instr.address + 4);
-    nextAddress(curr_addr, &instr);
+    length = instructionLength(readMem(*curr_addr));
+    *curr_addr += (length < 0) ? 2 : (length << 1);
 }
 
-void displayAsm(uint16_t curr_addr) {
-    Instruction instr;
-    char buffer[31];
-    uint16_t i;
-
-    instr.address = curr_addr;
-    for (i = 4; i > 0; i--) {
-        instr.operator = readMem(instr.address);
-        instr.source = readMem(instr.address + 2);
-        instr.destination = readMem(instr.address + 4);
-        waitPrintHex(instr.address);
-        waitPrint(": ");
-        getInstruction(buffer, &instr);
-        waitPrint(buffer);
-        if (i == 4) {
-            waitPrint(" <");
-        }
-        waitPrint("\033[E"); // newline command
-        nextAddress(&(instr.address), &instr);
+static uint16_t view_addr; // the instruction marked by the views
+
+static void printAsm(const DecodedInstruction *decoded, const uint16_t *words) {
+    char buffer[INSTRUCTION_TEXT_SIZE];
+
+    waitPrintHex(decoded->address);
+#ifdef COVERAGE_STEPS
+    waitPrint(isCovered(decoded->address) ? "* " : "  ");
+#endif
+    waitPrint(": ");
+    formatInstruction(buffer, decoded);
+    waitPrint(buffer);
+    if (decoded->address == view_addr) {
+        waitPrint(" <");
+    }
+    waitPrint("\033[E"); // newline command
+}
+
+static void printBin(const DecodedInstruction *decoded, const uint16_t *words) {
+    uint16_t i, length;
+
+    waitPrintHex(decoded->address);
+    waitPrint(": ");
+    length = (decoded->length == 0) ? 1 : decoded->length;
+    for (i = 0; i < length; i++) {
+        waitPrintHex(words[i]);
+        waitPrint(" ");
     }
+    if (decoded->address == view_addr) {
+        waitPrint("<");
+    }
+    waitPrint("\033[E"); // newline command
+}
+
+void displayAsm(uint16_t curr_addr) {
+    view_addr = curr_addr;
+    disassembleRange(readMem, curr_addr, 4, printAsm);
 }
 
 void displayBin(uint16_t curr_addr) {
-    int encodingLength;
-    Instruction instr;
-    uint16_t i;
-
-    instr.address = curr_addr;
-    for (i = 4; i > 0; i--) {
-        instr.operator = readMem(instr.address);
-        instr.source = readMem(instr.address + 2);
-        instr.destination = readMem(instr.address + 4);
-        waitPrintHex(instr.address);
-        waitPrint(": ");
-        encodingLength = nextAddress(NULL, &instr);
-        if (encodingLength == -1) {
-            encodingLength = 1; // next address internally moves 1 word upon error
-        }
-        if (encodingLength >= 1) {
-            waitPrintHex(instr.operator);
-            waitPrint(" ");
-            if (encodingLength >= 2) {
-                waitPrintHex(instr.source);
-                waitPrint(" ");
-                if (encodingLength >= 3) {
-                    waitPrintHex(instr.destination);
-                    waitPrint(" ");
-                }
-            }
+    view_addr = curr_addr;
+    disassembleRange(readMem, curr_addr, 4, printBin);
+}
+
+#ifdef WATCH_ADDRESS
+/*
+ * Polls the EEM of the running target until a watchpoint stops it,
+ * for at most WATCH_TIMEOUT ms. A press of the jump button gives up
+ * early.
+ *
+ * Returns: True if the watchpoint was hit.
+ */
+static bool waitWatchpointHit() {
+    const uint32_t timeout = (uint32_t) WATCH_TIMEOUT * 1000 / JTAG_TIMESTAMP_US;
+    uint32_t elapsed = 0;
+    uint16_t stamp, now;
+
+    stamp = JTAG_TIMESTAMP();
+    while (!isWatchpointHit()) {
+        if (isButtonCmdSet(JUMP_BTN)) {
+            clrButtonCmd(JUMP_BTN);
+            waitPrint(" ABORTED");
+            return false;
         }
-        if (i == 4) {
-            waitPrint("<");
+        // the timer wraps much faster than WATCH_TIMEOUT, so add
+        // up the ticks between polls
+        now = JTAG_TIMESTAMP();
+        elapsed += (uint16_t) (now - stamp);
+        stamp = now;
+        if (elapsed >= timeout) {
+            waitPrint(" TIMEOUT");
+            return false;
         }
-        waitPrint("\033[E"); // newline command
-        nextAddress(&(instr.address), &instr);
     }
+    return true;
+}
+
+/*
+ * Runs the target at full speed until it accesses WATCH_ADDRESS
+ * as given by WATCH_ACCESS, and with WATCH_VALUE if defined, then
+ * points curr_addr at the instruction that made the access. If the
+ * access does not come within WATCH_TIMEOUT, or the jump button is
+ * pressed, the target is stopped wherever it is instead.
+ */
+void waitWatchpoint(uint16_t *curr_addr) {
+    Watchpoint watch;
+    bool hit;
+
+    watch.address = WATCH_ADDRESS;
+#ifdef WATCH_VALUE
+    watch.value = WATCH_VALUE;
+    watch.match_value = true;
+#else
+    watch.value = 0;
+    watch.match_value = false;
+#endif
+    watch.access = WATCH_ACCESS;
+    clrWatchpoints();
+    if (!setWatchpoint(&watch)) {
+        return;
+    }
+    if (!runCPU()) {
+        return;
+    }
+    waitPrint("WATCHING ");
+    waitPrintHex(WATCH_ADDRESS);
+    waitUart();
+    hit = waitWatchpointHit();
+    waitUart();
+
+    // on a hit the CPU stops after the accessing instruction
+    getDevice();
+    haltCPU();
+    clrWatchpoints();
+    *curr_addr = readReg(0);
+    setInstrFetch();
+    haltCPU();
+    if (hit) {
+        handleUp(curr_addr); // back to the accessing instruction
+    }
+}
+#endif
+
+/*
+ * Returns: True if the debugger was reset by RESET or the watchdog
+ *          while a session was open, and JUMP is not held down to
+ *          ask for a cold start.
+ */
+bool isWarmReset() {
+    bool warm = (session.magic == SESSION_MAGIC)
+                && (IFG1 & (RSTIFG + WDTIFG))
+                && !(IFG1 & PORIFG)
+                && !(BTN_IN & JMP_BTN_IFG);
+
+    IFG1 &= ~(RSTIFG + WDTIFG + PORIFG);
+    return warm;
+}
+
+/*
+ * Starts timer A1 free running from SMCLK/8. It times reset to first
+ * frame and is left running as the JTAG_TIMESTAMP() counter.
+ */
+inline void startTimestampTimer() {
+    TA1CTL = TASSEL_2 + ID_3 + MC_2 + TACLR;
+}
+
+static bool latency_shown; // the first frame has been timed
+
+/*
+ * Prints the time from reset to the end of the first frame in
+ * ticks of 8 SMCLK cycles, 0xFFFF if the timer overflowed.
+ */
+void displayLatency(bool warm) {
+    uint16_t ticks;
+
+    waitUart(); // the frame ends once it has been sent
+    ticks = TA1R;
+    if (TA1CTL & TAIFG) {
+        ticks = 0xFFFF;
+    }
+    latency_shown = true;
+    waitPrint("\033[E"); // newline command
+    waitPrint(warm ? "WARM " : "COLD ");
+    waitPrintHex(ticks);
+    waitUart();
 }
 
 /**
@@ -214,24 +347,77 @@ void displayBin(uint16_t curr_addr) {
  */
 int main(void)
 {
-    uint16_t curr_addr;
+    uint16_t curr_addr, signature;
+    bool warm;
 
     WDTCTL = WDTPW | WDTHOLD; // stop watchdog timer
+    startTimestampTimer();
 
     initButtons();
-    setButtonCmd(SHOW_BTN); // indicates showing assembly
+    warm = isWarmReset();
     initBackchannel();
 
     __bis_SR_register(GIE);
     waitPrint("\033[2J"); // clear screen command
     waitPrint("\033[H"); // home cursor command
 
-    // take target under JTAG control
-    initFSM();
-    getDevice();
-    haltCPU();
+    // pick up a target left halted by the last session, otherwise
+    // take target under JTAG control from scratch
+    if (warm) {
+        resumeFSM(session.tclk);
+        warm = resumeDevice();
+    }
+    if (!warm) {
+        session.magic = 0;
+        initFSM();
+        if (!getDevice()) {
+            // no target or a bad connection, wait for a reset
+            waitPrint("NO TARGET");
+            waitUart();
+            releaseFSM();
+            while (true) {
+                // buttons still wake the CPU, go straight back to sleep
+                __bis_SR_register(SCG0 | SCG1 | CPUOFF);
+            }
+        }
+        haltCPU();
+#ifdef CHECKPOINT_TARGET
+        // roll the target back to where it was on the first cold start
+        // since the debugger was flashed, which erases the checkpoint
+        if (isCheckpointStored()) {
+            waitPrint(restore(getFlashStore()) ? "RESTORED " : "RESTORE FAILED ");
+        } else {
+            waitPrint(checkpoint(getFlashStore()) ? "CHECKPOINT " : "CHECKPOINT FAILED ");
+        }
+        waitUart();
+#endif
+        // reuse the saved index while the target flash is unchanged
+        if (getFlashSignature(&signature)) {
+            loadNavIndex(signature);
+        } else {
+            clrNavIndex();
+        }
+        session.curr_addr = 0xC000;
+#ifdef WATCH_ADDRESS
+        waitWatchpoint(&session.curr_addr);
+#endif
+#ifdef COVERAGE_STEPS
+        // run the target under TCLK to see which code it executes
+        clrCoverage();
+        sampleCoverage(COVERAGE_STEPS);
+        writeCoverage(waitPrint);
+        waitUart();
+#endif
+        session.show_asm = true;
+        session.magic = SESSION_MAGIC;
+    } else {
+        resumeNavIndex(); // left in RAM with the session
+    }
+    if (session.show_asm) {
+        setButtonCmd(SHOW_BTN); // indicates showing assembly
+    }
 
-    curr_addr = 0xC000;
+    curr_addr = session.curr_addr;
     while (true) {
         if (isButtonCmdSet(JUMP_BTN)) {
             handleJump(&curr_addr);
@@ -258,8 +444,18 @@ int main(void)
             continue; // missing an interrupt, update again
         }
 
+        if (!latency_shown) {
+            displayLatency(warm);
+        }
+
+        // save the session for a warm reset
+        session.curr_addr = curr_addr;
+        session.show_asm = isButtonCmdSet(SHOW_BTN);
+        session.tclk = getTCLK();
+
         // go to sleep until woken from timer interrupt
         waitUart(); // finish sending uart data
+        saveNavIndex();
         __bis_SR_register(GIE);
         __bis_SR_register(SCG0 | SCG1 | CPUOFF); // LPM3 until GPIO interrupt
     }
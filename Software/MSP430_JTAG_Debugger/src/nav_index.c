@@ -0,0 +1,266 @@
+/*
+ * nav_index.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "jtag_control.h"
+#include "disassembler.h"
+#include "nav_index.h"
+#include "flash_control.h"
+
+/* Instruction boundaries only make sense relative to where decoding
+ * starts, so all of them are defined by a linear walk from NAV_START.
+ * For every block of NAV_BLOCK_WORDS words the index keeps one checkpoint:
+ * the first boundary at or after the start of the block. An instruction
+ * is at most three words long, so that boundary lies 0, 1 or 2 words into
+ * the block and fits in 2 bits, with 0 meaning not yet known:
+ *   entry = (word offset of the boundary) + 1
+ * Checkpoints are recorded as walks cross block starts, so the index
+ * fills in as the user scrolls. Like the session in main.c the index
+ * is kept in RAM through a debugger reset, see resumeNavIndex().
+ */
+#pragma NOINIT(nav_index)
+static uint8_t nav_index[NAV_INDEX_SIZE];
+static bool nav_dirty; // checkpoints added since the last save
+
+/* The index survives a reboot of the debugger in info flash, keyed by
+ * the PSA of the target flash it was built from. Flash programming can
+ * only clear bits, so the record holds the complement of the index:
+ * adding a checkpoint only clears bits and needs no erase. The segment
+ * is erased when the signature changes, or when another round of writes
+ * could exceed the cumulative programming time allowed between erases.
+ * The magic is written last, so an interrupted save leaves no record.
+ */
+struct NavRecord {
+    uint16_t index[NAV_INDEX_SIZE / 2];
+    uint16_t signature;
+    uint16_t magic;
+};
+
+#define NAV_RECORD ((volatile struct NavRecord *) NAV_RECORD_ADDR)
+
+#pragma NOINIT(nav_signature)
+static uint16_t nav_signature;
+#pragma NOINIT(nav_keyed)
+static bool nav_keyed; // nav_signature identifies the target flash
+static uint16_t nav_writes; // flash writes since the record was erased
+
+static inline uint16_t blockStart(uint16_t block) {
+    return NAV_START + (block * (NAV_BLOCK_WORDS << 1));
+}
+
+static inline uint16_t blockOf(uint16_t address) {
+    return (address - NAV_START) / (NAV_BLOCK_WORDS << 1);
+}
+
+static inline uint8_t getCheckpoint(uint16_t block) {
+    return (nav_index[block >> 2] >> ((block & 3) << 1)) & 3;
+}
+
+static inline void setCheckpoint(uint16_t block, uint8_t entry) {
+    uint8_t shift = (block & 3) << 1;
+
+    nav_index[block >> 2] = (nav_index[block >> 2] & ~(3 << shift))
+                            | (entry << shift);
+    nav_dirty = true;
+}
+
+static inline uint16_t recordWord(uint16_t i) {
+    return ~(nav_index[i << 1] | (nav_index[(i << 1) + 1] << 8));
+}
+
+static void writeFlash(volatile uint16_t *address, uint16_t value) {
+    writeFlashWord(address, value);
+    nav_writes++;
+}
+
+static void eraseRecord() {
+    eraseSegment(&NAV_RECORD->magic);
+    nav_writes = 0;
+}
+
+/*
+ * Starts an empty index that is not tied to a target signature, so
+ * it is never saved.
+ */
+void clrNavIndex() {
+    uint16_t i;
+
+    for (i = 0; i < NAV_INDEX_SIZE; i++) {
+        nav_index[i] = 0;
+    }
+    nav_keyed = false;
+    nav_dirty = false;
+}
+
+/*
+ * Loads the index saved in info flash if it was built from a target
+ * flash with the same signature, otherwise starts an empty index that
+ * replaces the saved one on the next save.
+ *
+ * Returns: True if the saved index was reused.
+ */
+bool loadNavIndex(uint16_t signature) {
+    uint16_t i, word;
+
+    nav_signature = signature;
+    nav_writes = NAV_WRITE_LIMIT; // unknown since the last erase
+    if (NAV_RECORD->magic != NAV_MAGIC || NAV_RECORD->signature != signature) {
+        clrNavIndex();
+        nav_keyed = true;
+        return false;
+    }
+    for (i = 0; i < NAV_INDEX_SIZE / 2; i++) {
+        word = ~NAV_RECORD->index[i];
+        nav_index[i << 1] = word;
+        nav_index[(i << 1) + 1] = word >> 8;
+    }
+    nav_keyed = true;
+    nav_dirty = false;
+    return true;
+}
+
+/*
+ * Picks up the index left in RAM by the session before a debugger
+ * reset, which saves taking the PSA of the target flash again. The
+ * caller must know the session to be valid. Checkpoints the reset
+ * cut off before they were saved go out with the next save.
+ */
+void resumeNavIndex() {
+    nav_writes = NAV_WRITE_LIMIT;
+    nav_dirty = true;
+}
+
+/*
+ * Writes checkpoints added since the last save to info flash. Only
+ * changed words are programmed, unless the record belongs to another
+ * signature or the write budget is spent, and the record has to be
+ * erased and rewritten. Interrupts are held off
+ * while the flash controller is busy.
+ */
+void saveNavIndex() {
+    uint16_t i, changed, interrupts;
+
+    if (!nav_dirty || !nav_keyed) {
+        return;
+    }
+    changed = 0;
+    for (i = 0; i < NAV_INDEX_SIZE / 2; i++) {
+        if (NAV_RECORD->index[i] != recordWord(i)) {
+            changed++;
+        }
+    }
+
+    interrupts = unlockFlash();
+    if (NAV_RECORD->magic != NAV_MAGIC || NAV_RECORD->signature != nav_signature
+            || nav_writes + changed > NAV_WRITE_LIMIT) {
+        eraseRecord();
+        for (i = 0; i < NAV_INDEX_SIZE / 2; i++) {
+            if (recordWord(i) != 0xFFFF) {
+                writeFlash(&NAV_RECORD->index[i], recordWord(i));
+            }
+        }
+        writeFlash(&NAV_RECORD->signature, nav_signature);
+        writeFlash(&NAV_RECORD->magic, NAV_MAGIC);
+    } else {
+        for (i = 0; i < NAV_INDEX_SIZE / 2; i++) {
+            if (NAV_RECORD->index[i] != recordWord(i)) {
+                writeFlash(&NAV_RECORD->index[i], recordWord(i));
+            }
+        }
+    }
+    lockFlash(interrupts);
+    nav_dirty = false;
+}
+
+/*
+ * Takes the PSA of the target flash covered by the index, which keys
+ * the saved index. The PSA of a few words is first checked against
+ * the signature of the same words read back, so a target that does
+ * not reproduce the PSA never has a stale index reused. getPSA()
+ * clocks the PC through the whole region, so the PC is read first and
+ * written back after, as checkpoint() does. The target must be halted
+ * through haltCPU(), and is halted again when this returns.
+ *
+ * Returns: True with the signature in signature.
+ */
+bool getFlashSignature(uint16_t *signature) {
+    uint16_t words[8];
+    uint16_t i, pc;
+    bool valid;
+
+    if (!setInstrFetch()) {
+        return false;
+    }
+    pc = readReg(0);
+    if (!setInstrFetch()) {
+        return false;
+    }
+    haltCPU();
+    for (i = 0; i < 8; i++) {
+        words[i] = readMem(NAV_START + 2 * i);
+    }
+    valid = getPSA(NAV_START, 8, signature)
+            && *signature == calcPSA(NAV_START, words, 8);
+    if (valid) {
+        setInstrFetch();
+        haltCPU();
+        valid = getPSA(NAV_START, NAV_BLOCKS * NAV_BLOCK_WORDS, signature);
+    }
+    if (!setInstrFetch()) {
+        return false;
+    }
+    setPC(pc);
+    haltCPU();
+    return valid;
+}
+
+/*
+ * Finds the instruction before address on the walk from NAV_START.
+ * Decoding starts at the closest known checkpoint below address rather
+ * than at NAV_START, so a press costs at most about one block of reads
+ * once the blocks around it have been visited.
+ *
+ * Returns: The address of the previous instruction, or NAV_START if
+ *          address is at or below the start of the index.
+ */
+uint16_t prevInstruction(uint16_t address) {
+    uint16_t block, addr, prev, next;
+    uint8_t entry;
+    int length;
+
+    if (address <= NAV_START) {
+        return NAV_START;
+    }
+
+    addr = NAV_START;
+    block = blockOf(address - 2);
+    while (block > 0) {
+        entry = getCheckpoint(block);
+        if (entry && (blockStart(block) + ((entry - 1) << 1)) < address) {
+            addr = blockStart(block) + ((entry - 1) << 1);
+            break;
+        }
+        block--;
+    }
+
+    prev = addr;
+    while (addr < address) {
+        prev = addr;
+        length = instructionLength(readMem(addr));
+        next = addr + ((length < 0) ? 2 : (length << 1));
+        if (next <= addr) {
+            break; // walked off the top of memory
+        }
+        block = blockOf(next);
+        if (block != blockOf(addr) && block < NAV_BLOCKS) {
+            setCheckpoint(block, ((next - blockStart(block)) >> 1) + 1);
+        }
+        addr = next;
+    }
+    return prev;
+}
@@ -0,0 +1,42 @@
+/*
+ * nav_index.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ */
+
+#ifndef SRC_NAV_INDEX_H_
+#define SRC_NAV_INDEX_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*** Region of target flash covered by the index ***/
+#define NAV_START       (0xC000)
+#define NAV_BLOCK_WORDS (64)
+#define NAV_BLOCKS      (128)
+
+/*** Four 2-bit checkpoints per byte ***/
+#define NAV_INDEX_SIZE  (NAV_BLOCKS / 4)
+
+/*** Info flash segment holding the saved index (INFOD), a host build supplies its own ***/
+#ifndef NAV_RECORD_ADDR
+#ifdef __MSP430F5529__
+#define NAV_RECORD_ADDR (0x1800)
+#else
+#define NAV_RECORD_ADDR (0x1000)
+#endif
+#endif
+#define NAV_MAGIC       (0x4E41)
+
+/*** Flash writes allowed between erases of the record segment ***/
+#define NAV_WRITE_LIMIT (96)
+
+void clrNavIndex();
+bool loadNavIndex(uint16_t signature);
+void resumeNavIndex();
+void saveNavIndex();
+bool getFlashSignature(uint16_t *signature);
+uint16_t prevInstruction(uint16_t address);
+
+#endif /* SRC_NAV_INDEX_H_ */
@@ -0,0 +1,51 @@
+/*
+ * bench.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Shared helpers of the host benchmarks of msp430DisassemblerLib.
+ * Every benchmark runs over all 65536 instruction words ROUNDS
+ * times and prints its rate in millions per second, along with a
+ * checksum of its results so that two builds of the library can
+ * be shown to agree.
+ */
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <stdint.h>
+#include <time.h>
+
+#define ROUNDS (2000)   // passes over the 65536 instruction words
+
+/*
+ * Returns: Processor time used so far, in seconds.
+ */
+static inline double getSeconds() {
+    return (double) clock() / CLOCKS_PER_SEC;
+}
+
+/*
+ * Returns: The rate, in millions per second, of calls operations
+ *          taking seconds.
+ */
+static inline double getMillionsPerSecond(double calls, double seconds) {
+    return calls / seconds / 1e6;
+}
+
+/*
+ * Adds bytes to an FNV-1a checksum started at FNV_START.
+ */
+#define FNV_START (2166136261u)
+
+static inline uint32_t addChecksum(uint32_t checksum, const void *bytes, unsigned int count) {
+    const uint8_t *next = (const uint8_t *) bytes;
+
+    while (count--) {
+        checksum = (checksum ^ *next++) * 16777619u;
+    }
+    return checksum;
+}
+
+#endif /* BENCH_H_ */
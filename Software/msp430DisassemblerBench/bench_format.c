@@ -0,0 +1,51 @@
+/*
+ * bench_format.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Formatting rate of formatInstruction() over decoded instructions,
+ * which excludes the cost of decode(). Every instruction word is
+ * formatted once with fixed extension words to checksum the text,
+ * so a change to the formatter can be shown to leave every line
+ * byte-identical.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "disassembler.h"
+#include "bench.h"
+
+#define TEXT_SIZE (64)  // larger than any line, formatters before INSTRUCTION_TEXT_SIZE did not check
+#define FORMAT_ROUNDS (ROUNDS / 20)
+
+static DecodedInstruction decoded[0x10000];
+
+int main(void) {
+    volatile int sink = 0;
+    Instruction instr = {0xC100, 0, 0x1234, 0xABCD};
+    char text[TEXT_SIZE];
+    uint32_t checksum = FNV_START, word;
+    double start, calls = (double) FORMAT_ROUNDS * 0x10000;
+    int round;
+
+    for (word = 0; word < 0x10000; word++) {
+        instr.operator = word;
+        decode(&decoded[word], &instr);
+        formatInstruction(text, &decoded[word]);
+        checksum = addChecksum(checksum, text, strlen(text) + 1);
+    }
+    printf("text checksum: %08X\n", (unsigned int) checksum);
+
+    start = getSeconds();
+    for (round = 0; round < FORMAT_ROUNDS; round++) {
+        for (word = 0; word < 0x10000; word++) {
+            sink += formatInstruction(text, &decoded[word]);
+        }
+    }
+    printf("formatInstruction: %.1fM lines/s\n", getMillionsPerSecond(calls, getSeconds() - start));
+
+    return 0;
+}
@@ -0,0 +1,45 @@
+/*
+ * bench_length.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Instruction length rate of nextAddress(), which only takes the
+ * instruction word. Only uses functions every version of the
+ * library has, so it also builds against the library as it was
+ * before instructionLength(), see the Makefile.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "disassembler.h"
+#include "bench.h"
+
+int main(void) {
+    volatile int sink = 0;
+    Instruction instr = {0xC000, 0, 0, 0};
+    uint32_t checksum = FNV_START, word;
+    uint16_t next;
+    double start, calls = (double) ROUNDS * 0x10000;
+    int round, length;
+
+    for (word = 0; word < 0x10000; word++) {
+        instr.operator = word;
+        length = nextAddress(&next, &instr);
+        checksum = addChecksum(checksum, &length, sizeof(length));
+        checksum = addChecksum(checksum, &next, sizeof(next));
+    }
+    printf("length checksum: %08X\n", (unsigned int) checksum);
+
+    start = getSeconds();
+    for (round = 0; round < ROUNDS; round++) {
+        for (word = 0; word < 0x10000; word++) {
+            instr.operator = word;
+            sink += nextAddress(&next, &instr);
+        }
+    }
+    printf("nextAddress: %.1fM lookups/s\n", getMillionsPerSecond(calls, getSeconds() - start));
+
+    return 0;
+}
@@ -0,0 +1,71 @@
+/*
+ * bench_opcode.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Opcode lookup rate of the dispatch tables, getOpCodeId() and
+ * getOpCode(), against the CODES[] scan of getOpCodeLinear().
+ * Also counts the words on which the table and the scan disagree,
+ * and the CODES[] entries whose own mask the tables do not map back
+ * to them, both of which must be 0 for the run to pass.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "disassembler.h"
+#include "bench.h"
+
+int main(void) {
+    volatile unsigned int sink = 0;
+    unsigned long mismatches = 0, pairs = 0;
+    opCode table, linear;
+    double start, calls = (double) ROUNDS * 0x10000;
+    uint32_t word;
+    int round, id;
+
+    for (word = 0; word < 0x10000; word++) {
+        table = getOpCode(word);
+        linear = getOpCodeLinear(word);
+        if (table.mask != linear.mask || table.format != linear.format
+                || strcmp(table.repr, linear.repr) != 0) {
+            mismatches++;
+        }
+    }
+    for (id = 0; id < ERROR_ID; id++) {
+        if (getOpCodeId(CODES[id].mask) != id) {
+            printf("%s: mask %04X maps to %s\n", CODES[id].repr, CODES[id].mask,
+                   CODES[getOpCodeId(CODES[id].mask)].repr);
+            pairs++;
+        }
+    }
+    printf("opcode mismatches: %lu, mask/ID pair mismatches: %lu\n", mismatches, pairs);
+
+    start = getSeconds();
+    for (round = 0; round < ROUNDS; round++) {
+        for (word = 0; word < 0x10000; word++) {
+            sink += getOpCodeId(word);
+        }
+    }
+    printf("getOpCodeId: %.1fM decodes/s\n", getMillionsPerSecond(calls, getSeconds() - start));
+
+    start = getSeconds();
+    for (round = 0; round < ROUNDS; round++) {
+        for (word = 0; word < 0x10000; word++) {
+            sink += getOpCode(word).mask;
+        }
+    }
+    printf("getOpCode: %.1fM decodes/s\n", getMillionsPerSecond(calls, getSeconds() - start));
+
+    start = getSeconds();
+    for (round = 0; round < ROUNDS; round++) {
+        for (word = 0; word < 0x10000; word++) {
+            sink += getOpCodeLinear(word).mask;
+        }
+    }
+    printf("getOpCodeLinear: %.1fM decodes/s\n", getMillionsPerSecond(calls, getSeconds() - start));
+
+    return (mismatches == 0 && pairs == 0) ? 0 : 1;
+}
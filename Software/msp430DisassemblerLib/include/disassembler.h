@@ -27,11 +27,86 @@ struct Instruction {
 
 typedef struct Instruction Instruction;
 
+/*
+ * An instruction decoded by decode(), so that navigation can use
+ * its fields without formatting it. 12 bytes.
+ */
+struct DecodedInstruction {
+    /* The address where this instruction is located in target flash */
+    uint16_t address;
+    /* The word used by the source operand, or the single operand */
+    uint16_t source;
+    /* The word used by the destination operand */
+    uint16_t destination;
+    /* The jump or call target, 0 if there is none or it is
+     * only known at run time */
+    uint16_t target;
+    /* The opcode, an opCodeId */
+    unsigned int opcode : 5;
+    /* The formatType of the opcode */
+    unsigned int format : 2;
+    /* Set for .B operations */
+    unsigned int is_byte : 1;
+    /* The number of words encoding the instruction, 0 on error */
+    unsigned int length : 2;
+    /* The addressingMode of the source operand, or the single operand */
+    unsigned int src_mode : 3;
+    /* The addressingMode of the destination operand */
+    unsigned int dest_mode : 3;
+    /* The register of the source operand, or the single operand */
+    unsigned int src_reg : 4;
+    /* The register of the destination operand */
+    unsigned int dest_reg : 4;
+};
+
+typedef struct DecodedInstruction DecodedInstruction;
+
+/***
+ * The buffer size needed for the text of any instruction, such as
+ * "ADDC.W 0x1A1B(R7) 0x2424(R5)" plus its terminator.
+ */
+#define INSTRUCTION_TEXT_SIZE (31)
+
+/*
+ * Write position in a text buffer. Text is appended at next
+ * without rescanning the buffer, and is cut short rather than
+ * written past end. The buffer is kept terminated.
+ */
+struct TextCursor {
+    /* Where the next character goes */
+    char *next;
+    /* The last character of the buffer, kept for the terminator */
+    char *end;
+    /* Set once text had to be cut short */
+    bool overflow;
+};
+
+typedef struct TextCursor TextCursor;
+
+/*
+ * Reads the word of target memory at address, eg readMem().
+ */
+typedef uint16_t (*WordSource)(uint16_t address);
+
+/*
+ * Receives each instruction decoded by disassembleRange(), with
+ * words pointing at the decoded->length words encoding it.
+ */
+typedef void (*InstructionSink)(const DecodedInstruction *decoded, const uint16_t *words);
+
+int instructionLength(uint16_t operator);
 int nextAddress(uint16_t *next_addr, Instruction *instr);
+bool decode(DecodedInstruction *decoded, const Instruction *instr);
+bool formatInstruction(char *buffer, const DecodedInstruction *decoded);
 bool getInstruction(char *buffer, Instruction *instr);
-bool appendOperand(char *result, uint16_t pc, uint16_t reg, uint16_t word, addressingMode mode);
-int searchEmulated(char *result, opCode *op, uint16_t start_addr, uint16_t *byte_code);
+uint16_t disassembleRange(WordSource source, uint16_t start, uint16_t count, InstructionSink sink);
+void initCursor(TextCursor *cursor, char *buffer, uint16_t size);
+void putText(TextCursor *cursor, const char *text);
+void putHex(TextCursor *cursor, uint16_t value);
+bool appendOperand(TextCursor *cursor, uint16_t pc, uint16_t reg, uint16_t word, addressingMode mode);
+opCodeId getOpCodeId(uint16_t byteCode);
 opCode getOpCode(uint16_t byteCode);
+opCode getOpCodeLinear(uint16_t byteCode);
 addressingMode getDestRegisterMode(uint16_t byteCode);
 addressingMode getSourceRegisterMode(uint16_t byteCode, formatType type);
 uint16_t getDestRegister(uint16_t byteCode);
@@ -45,7 +120,8 @@ void parseRegisterNum(char* result, uint16_t regNum);
 void uintToHex(char* result, uint16_t input);
 
 
-// order matters!
+// order matters! getOpCode() dispatches on the same order,
+// see getOpCodeLinear()
 static const opCode CODES[] = {
        {AND_MASK, AND_TYPE, "AND"},
        {XOR_MASK, XOR_TYPE, "XOR"},
@@ -23,6 +23,18 @@ typedef enum {
     JUMP
 } formatType;
 
+/*
+ * Identifies an opcode by its index in CODES[], see disassembler.h.
+ * Must be kept in the same order.
+ */
+typedef enum {
+    AND_ID, XOR_ID, BIS_ID, BIC_ID, BIT_ID, DADD_ID, CMP_ID, SUB_ID,
+    SUBC_ID, ADDC_ID, ADD_ID, MOV_ID,
+    JMP_ID, JL_ID, JGE_ID, JN_ID, JC_ID, JNC_ID, JEQ_ID, JNE_ID,
+    RETI_ID, CALL_ID, PUSH_ID, SXT_ID, RRA_ID, SWPB_ID, RRC_ID,
+    ERROR_ID
+} opCodeId;
+
 typedef struct {
     uint16_t mask;
     formatType format;
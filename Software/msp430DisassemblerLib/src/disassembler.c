@@ -15,17 +15,68 @@
 #include "masks.h"
 #include "types.h"
 
-inline void appendByteOp(char *result, bool isByteOp) {
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+static const char* REGISTER_NAMES[] = { "PC", "SP", "SR", "CG2",
+                                        "R4", "R5", "R6", "R7",
+                                        "R8", "R9", "R10", "R11",
+                                        "R12", "R13", "R14", "R15" };
+
+/**
+ * Points cursor at the start of buffer, which holds size
+ * characters including the terminator, and empties it.
+ */
+void initCursor(TextCursor *cursor, char *buffer, uint16_t size) {
+    cursor->next = buffer;
+    cursor->end = buffer + size - 1;
+    cursor->overflow = false;
+    *buffer = '\0';
+}
+
+/**
+ * Appends one character at cursor.
+ */
+static inline void putChar(TextCursor *cursor, char c) {
+    if (cursor->next < cursor->end) {
+        *cursor->next++ = c;
+        *cursor->next = '\0';
+    } else {
+        cursor->overflow = true;
+    }
+}
+
+/**
+ * Appends text at cursor, stopping at the end of the buffer.
+ */
+void putText(TextCursor *cursor, const char *text) {
+    while (*text != '\0') {
+        putChar(cursor, *text++);
+    }
+}
+
+/**
+ * Appends value formatted as 0xFFFF at cursor.
+ */
+void putHex(TextCursor *cursor, uint16_t value) {
+    putChar(cursor, '0');
+    putChar(cursor, 'x');
+    putChar(cursor, HEX_DIGITS[(value >> 12) & 0x000F]);
+    putChar(cursor, HEX_DIGITS[(value >> 8) & 0x000F]);
+    putChar(cursor, HEX_DIGITS[(value >> 4) & 0x000F]);
+    putChar(cursor, HEX_DIGITS[value & 0x000F]);
+}
+
+inline void appendByteOp(TextCursor *cursor, bool isByteOp) {
     if (isByteOp) {
-        strcat(result, ".B ");
+        putText(cursor, ".B ");
     } else {
-        strcat(result, ".W ");
+        putText(cursor, ".W ");
     }
 }
 
 /**
  * Returns 1 if the addressing mode consumes a byte,
- * 0 otherwise. Used in nextAddress function.
+ * 0 otherwise. Used to find the destination word of an instruction.
  *
  * @param source: true if this is the source operand, false if this
  *                is the destination operand.
@@ -56,142 +107,372 @@ uint16_t modeConsumesByte(bool source, uint16_t reg, addressingMode mode) {
     }
 }
 
+/*
+ * Registers whose source operand takes an extension word, indexed
+ * by the As bits: indexed, symbolic and absolute modes except for
+ * the R3 constant, and immediate mode through the PC.
+ */
+static const uint16_t SRC_EXT_WORDS[4] = {
+       0x0000, // register
+       0xFFF7, // indexed, all but R3
+       0x0000, // indirect
+       0x0001, // autoincrement, PC only
+};
+
+/**
+ * Returns the number of 16-bit words used to encode the instruction
+ * whose first word is operator, from the As/Ad bits and registers
+ * alone, so the source and destination words need not be read.
+ *
+ * Returns: 1, 2 or 3, or -1 if operator is not an instruction.
+ */
+int instructionLength(uint16_t operator) {
+    uint16_t as = (operator >> 4) & 0x3;
+
+    switch (operator >> 12) {
+    case 0x0:
+        return -1;
+    case 0x1:
+        return 1 + ((SRC_EXT_WORDS[as] >> (operator & 0xF)) & 1);
+    case 0x2:
+    case 0x3:
+        return 1;
+    default:
+        return 1 + ((SRC_EXT_WORDS[as] >> ((operator >> 8) & 0xF)) & 1) + ((operator >> 7) & 1);
+    }
+}
+
 /**
  * Finds the address of the next instruction.
  *
- * @param start_addr: The location in memory of the current instruction.
- * @param byte_code: The memory contents beginning at start_addr. This function does
- *                   not care about the source or destination, only the operator.
  * @param next_addr: A pointer to where this function should return the memory location
  *                   of the next instruction to decode, necessary because of variable
  *                   length instructions. If not required, this should be set to NULL.
+ * @param instr: The instruction. Only the address and operator are used.
  *
  * Returns: The number of 16-bit words used to encode the assembly instruction. Returns
  *          -1 if an error occurred, in which case next_addr equals start_addr + 2.
  */
 int nextAddress(uint16_t *next_addr, Instruction *instr) {
-    uint16_t bytes_consumed, srcReg, destReg;
-    addressingMode srcMode, destMode;
-    opCode op;
+    int length;
 
-    op = getOpCode(instr->operator);
-    bytes_consumed = 1; // consume opcode byte
-    switch (op.format) {
+    length = instructionLength(instr->operator);
+    if (next_addr != NULL) {
+        *next_addr = instr->address + ((length < 0) ? 2 : (length << 1));
+    }
+    return length;
+}
+
+
+/**
+ * Decodes instr without formatting it.
+ *
+ * @param decoded: The decoded instruction.
+ * @param instr: The instruction information.
+ *
+ * Returns: True if successful, false if instr is not a valid
+ *          instruction, in which case decoded has the ERROR opcode
+ *          and a length of 0.
+ */
+bool decode(DecodedInstruction *decoded, const Instruction *instr) {
+    opCodeId id;
+    formatType format;
+    int length;
+
+    id = getOpCodeId(instr->operator);
+    format = CODES[id].format;
+    length = instructionLength(instr->operator);
+
+    decoded->address = instr->address;
+    decoded->opcode = id;
+    decoded->format = format;
+    decoded->is_byte = (format == DOUBLE || format == SINGLE) && isByteOperation(instr->operator);
+    decoded->length = (length < 0) ? 0 : length;
+    decoded->src_mode = getSourceRegisterMode(instr->operator, format);
+    decoded->src_reg = getSourceRegister(instr->operator, format);
+    decoded->dest_mode = ADDRESSINGERROR;
+    decoded->dest_reg = 0;
+    decoded->source = instr->source;
+    decoded->destination = instr->source;
+    decoded->target = 0;
+    switch (format) {
     case DOUBLE:
-    {
-        srcMode = getSourceRegisterMode(instr->operator, DOUBLE);
-        destMode = getDestRegisterMode(instr->operator);
-        srcReg = getSourceRegister(instr->operator, DOUBLE);
-        destReg = getDestRegister(instr->operator);
-        bytes_consumed += modeConsumesByte(true, srcReg, srcMode);
-        bytes_consumed += modeConsumesByte(false, destReg, destMode);
+        decoded->dest_mode = getDestRegisterMode(instr->operator);
+        decoded->dest_reg = getDestRegister(instr->operator);
+        if (modeConsumesByte(true, decoded->src_reg, (addressingMode) decoded->src_mode)) {
+            decoded->destination = instr->destination;
+        }
         break;
-    }
     case SINGLE:
-    {
-        srcMode = getSourceRegisterMode(instr->operator, SINGLE);
-        srcReg = getSourceRegister(instr->operator, SINGLE);
-        bytes_consumed += modeConsumesByte(true, srcReg, srcMode);
+        if (id == CALL_ID) {
+            decoded->target = getCallLocation(instr->operator, instr->source, instr->address);
+        }
         break;
-    }
     case JUMP:
-    {
-        // no extra bytes consumed
+        decoded->target = getJumpLocation(instr->operator, instr->address);
         break;
-    }
     default:
-    {
-        // an error occurred, return error address
-        if (next_addr != NULL) {
-            *next_addr = instr->address + 2;
-        }
-        return -1;
-    }
+        return false;
     }
-    if (next_addr != NULL) {
-        *next_addr = instr->address + (bytes_consumed << 1);
+    return true;
+}
+
+/*
+ * Operand constraints of EMULATED_CODES: a register and addressing
+ * mode the operand must use, any operand, or for the source the same
+ * register as the destination with both in register mode.
+ */
+#define OPERAND(reg, mode)  (((mode) << 4) | (reg))
+#define ANY_OPERAND         (0xFF)
+#define SAME_OPERAND        (0xFE)
+
+#define EMULATED_WORD       (0x01) // only matches .W instructions
+#define EMULATED_SIZED      (0x02) // printed with .B or .W
+#define EMULATED_SHOW_SRC   (0x04) // printed with the source operand
+#define EMULATED_SHOW_DEST  (0x08) // printed with the destination operand
+
+struct EmulatedCode {
+    /* The opCodeId of the core instruction */
+    uint8_t opcode;
+    /* The OPERAND() the source must be, or ANY_OPERAND or SAME_OPERAND */
+    uint8_t src;
+    /* The OPERAND() the destination must be, or ANY_OPERAND */
+    uint8_t dest;
+    /* EMULATED_ flags */
+    uint8_t flags;
+    const char *repr;
+};
+
+/*
+ * The emulated instructions of the MSP430 user guide as printed by
+ * CCS. The first match wins, so NOP and RET come before the CLR,
+ * POP and BR rows they are special cases of.
+ */
+static const struct EmulatedCode EMULATED_CODES[] = {
+       {MOV_ID, OPERAND(3, REGISTER), OPERAND(3, REGISTER), EMULATED_WORD, "NOP"},
+       {MOV_ID, OPERAND(1, AUTOINCREMENT), OPERAND(0, REGISTER), EMULATED_WORD, "RET"},
+       {MOV_ID, OPERAND(1, AUTOINCREMENT), ANY_OPERAND, EMULATED_SIZED | EMULATED_SHOW_DEST, "POP"},
+       {MOV_ID, ANY_OPERAND, OPERAND(0, REGISTER), EMULATED_WORD | EMULATED_SHOW_SRC, "BR"},
+       {MOV_ID, OPERAND(3, REGISTER), ANY_OPERAND, EMULATED_SIZED | EMULATED_SHOW_DEST, "CLR"},
+       {BIC_ID, OPERAND(3, INDEXED), OPERAND(2, REGISTER), EMULATED_WORD, "CLRC"},
+       {BIC_ID, OPERAND(3, INDIRECT), OPERAND(2, REGISTER), EMULATED_WORD, "CLRZ"},
+       {BIC_ID, OPERAND(2, INDIRECT), OPERAND(2, REGISTER), EMULATED_WORD, "CLRN"},
+       {BIC_ID, OPERAND(2, AUTOINCREMENT), OPERAND(2, REGISTER), EMULATED_WORD, "DINT"},
+       {BIS_ID, OPERAND(3, INDEXED), OPERAND(2, REGISTER), EMULATED_WORD, "SETC"},
+       {BIS_ID, OPERAND(3, INDIRECT), OPERAND(2, REGISTER), EMULATED_WORD, "SETZ"},
+       {BIS_ID, OPERAND(2, INDIRECT), OPERAND(2, REGISTER), EMULATED_WORD, "SETN"},
+       {BIS_ID, OPERAND(2, AUTOINCREMENT), OPERAND(2, REGISTER), EMULATED_WORD, "EINT"},
+       {ADD_ID, OPERAND(3, INDEXED), ANY_OPERAND, EMULATED_SIZED | EMULATED_SHOW_DEST, "INC"},
+       {ADD_ID, OPERAND(3, INDIRECT), ANY_OPERAND, EMULATED_SIZED | EMULATED_SHOW_DEST, "INCD"},
+       {ADD_ID, SAME_OPERAND, ANY_OPERAND, EMULATED_SIZED | EMULATED_SHOW_DEST, "RLA"},
+       {ADDC_ID, OPERAND(3, REGISTER), ANY_OPERAND, EMULATED_SIZED | EMULATED_SHOW_DEST, "ADC"},
+       {ADDC_ID, SAME_OPERAND, ANY_OPERAND, EMULATED_SIZED | EMULATED_SHOW_DEST, "RLC"},
+       {SUB_ID, OPERAND(3, INDEXED), ANY_OPERAND, EMULATED_SIZED | EMULATED_SHOW_DEST, "DEC"},
+       {SUB_ID, OPERAND(3, INDIRECT), ANY_OPERAND, EMULATED_SIZED | EMULATED_SHOW_DEST, "DECD"},
+       {SUBC_ID, OPERAND(3, REGISTER), ANY_OPERAND, EMULATED_SIZED | EMULATED_SHOW_DEST, "SBC"},
+       {DADD_ID, OPERAND(3, REGISTER), ANY_OPERAND, EMULATED_SIZED | EMULATED_SHOW_DEST, "DADC"},
+       {XOR_ID, OPERAND(3, AUTOINCREMENT), ANY_OPERAND, EMULATED_SIZED | EMULATED_SHOW_DEST, "INV"},
+       {CMP_ID, OPERAND(3, REGISTER), ANY_OPERAND, EMULATED_SIZED | EMULATED_SHOW_DEST, "TST"},
+};
+
+/**
+ * Finds the emulated instruction decoded is printed as, in one
+ * pass over EMULATED_CODES.
+ *
+ * Returns: The matching entry, or NULL if decoded is printed as
+ *          its core instruction.
+ */
+static const struct EmulatedCode *matchEmulated(const DecodedInstruction *decoded) {
+    const struct EmulatedCode *code;
+    uint8_t src, dest;
+    bool same;
+
+    if (decoded->format != DOUBLE) {
+        return NULL;
+    }
+    src = OPERAND(decoded->src_reg, decoded->src_mode);
+    dest = OPERAND(decoded->dest_reg, decoded->dest_mode);
+    same = src == dest && decoded->src_mode == REGISTER;
+    for (code = EMULATED_CODES; code < EMULATED_CODES + sizeof(EMULATED_CODES) / sizeof(EMULATED_CODES[0]); code++) {
+        if (code->opcode == decoded->opcode &&
+                (code->src == ANY_OPERAND || code->src == src || (code->src == SAME_OPERAND && same)) &&
+                (code->dest == ANY_OPERAND || code->dest == dest) &&
+                !((code->flags & EMULATED_WORD) && decoded->is_byte)) {
+            return code;
+        }
     }
-    return bytes_consumed;
+    return NULL;
 }
 
+/**
+ * Appends the emulated instruction code for decoded at cursor.
+ *
+ * Returns: True if successful, false if an error occurred.
+ */
+static bool appendEmulated(TextCursor *cursor, const struct EmulatedCode *code,
+                           const DecodedInstruction *decoded) {
+    putText(cursor, code->repr);
+    if (code->flags & EMULATED_SIZED) {
+        appendByteOp(cursor, decoded->is_byte);
+    } else if (code->flags & (EMULATED_SHOW_SRC | EMULATED_SHOW_DEST)) {
+        putChar(cursor, ' ');
+    }
+    if (code->flags & EMULATED_SHOW_SRC) {
+        return appendOperand(cursor, decoded->address, decoded->src_reg, decoded->source,
+                             (addressingMode) decoded->src_mode);
+    }
+    if (code->flags & EMULATED_SHOW_DEST) {
+        return appendOperand(cursor, decoded->address, decoded->dest_reg, decoded->destination,
+                             (addressingMode) decoded->dest_mode);
+    }
+    return true;
+}
 
 /**
  * Fills buffer with the string assembly
- * instruction corresponding to instr.
+ * instruction corresponding to decoded, using
+ * the emulated instruction where there is one.
  *
  * @param buffer: A string buffer of minimum length 31 that
  *                will store the assembly instruction.
- * @param instr: The instruction information.
+ * @param decoded: The instruction, as filled by decode().
  *
  * Returns: True if successful, false if an error occurred,
  *          in which case the buffer is filled with "ERROR".
  */
-bool getInstruction(char *buffer, Instruction *instr) {
-    addressingMode srcMode, destMode;
-    uint16_t srcReg, destReg, destWord;
-    char pcNewStr[7];
-    bool isByteOp;
-    opCode op;
-
-    op = getOpCode(instr->operator);
-    isByteOp = isByteOperation;
-    strcpy(buffer, op.repr);
-    switch(op.format) {
-    case DOUBLE:
-    {
-        appendByteOp(buffer, isByteOp);
-        // append source operand
-        srcMode = getSourceRegisterMode(instr->operator, DOUBLE);
-        srcReg = getSourceRegister(instr->operator, DOUBLE);
-        if (!appendOperand(buffer, instr->address, srcReg, instr->source, srcMode)) {
-            strcpy(buffer, "ERROR");
-            return false;
-        }
-        strcat(buffer, " ");
-        // append destination operand
-        destMode = getDestRegisterMode(instr->operator);
-        destReg = getDestRegister(instr->operator);
-        destWord = (modeConsumesByte(true, srcReg, srcMode)) ? instr->destination : instr->source;
-        if (!appendOperand(buffer, instr->address, destReg, destWord, destMode)) {
+bool formatInstruction(char *buffer, const DecodedInstruction *decoded) {
+    const struct EmulatedCode *emulated;
+    TextCursor cursor;
+    bool valid;
+
+    initCursor(&cursor, buffer, INSTRUCTION_TEXT_SIZE);
+    emulated = matchEmulated(decoded);
+    if (emulated != NULL) {
+        valid = appendEmulated(&cursor, emulated, decoded);
+        if (!valid || cursor.overflow) {
             strcpy(buffer, "ERROR");
             return false;
         }
+        return true;
+    }
+    putText(&cursor, CODES[decoded->opcode].repr);
+    switch (decoded->format) {
+    case DOUBLE:
+    {
+        appendByteOp(&cursor, decoded->is_byte);
+        valid = appendOperand(&cursor, decoded->address, decoded->src_reg, decoded->source,
+                              (addressingMode) decoded->src_mode);
+        putChar(&cursor, ' ');
+        valid = valid && appendOperand(&cursor, decoded->address, decoded->dest_reg, decoded->destination,
+                                       (addressingMode) decoded->dest_mode);
         break;
     }
     case SINGLE:
     {
-        appendByteOp(buffer, isByteOp);
-        // append source operand
-        srcMode = getSourceRegisterMode(instr->operator, SINGLE);
-        srcReg = getSourceRegister(instr->operator, SINGLE);
-        if (!appendOperand(buffer, instr->address, srcReg, instr->source, srcMode)) {
-            strcpy(buffer, "ERROR");
-            return false;
-        }
+        appendByteOp(&cursor, decoded->is_byte);
+        valid = appendOperand(&cursor, decoded->address, decoded->src_reg, decoded->source,
+                              (addressingMode) decoded->src_mode);
         break;
     }
     case JUMP:
     {
-        uintToHex(pcNewStr, getJumpLocation(instr->operator, instr->address));
-        strcat(buffer, " ");
-        strcat(buffer, pcNewStr);
+        putChar(&cursor, ' ');
+        putHex(&cursor, decoded->target);
+        valid = true;
         break;
     }
     default:
     {
+        valid = false;
+        break;
+    }
+    }
+    if (!valid || cursor.overflow) {
         strcpy(buffer, "ERROR");
         return false;
     }
-    }
     return true;
 }
 
+/**
+ * Fills buffer with the string assembly
+ * instruction corresponding to instr.
+ *
+ * @param buffer: A string buffer of minimum length 31 that
+ *                will store the assembly instruction.
+ * @param instr: The instruction information.
+ *
+ * Returns: True if successful, false if an error occurred,
+ *          in which case the buffer is filled with "ERROR".
+ */
+bool getInstruction(char *buffer, Instruction *instr) {
+    DecodedInstruction decoded;
+
+    if (!decode(&decoded, instr)) {
+        strcpy(buffer, "ERROR");
+        return false;
+    }
+    return formatInstruction(buffer, &decoded);
+}
+
+/**
+ * Decodes count consecutive instructions beginning at start and
+ * passes each to sink. The words are read through a sliding window
+ * of the three words an instruction can span, so every word of the
+ * range is read from source once.
+ *
+ * @param source: Reads the words of the range.
+ * @param start: The address of the first instruction.
+ * @param count: The number of instructions to decode.
+ * @param sink: Called with each decoded instruction, in order. A word
+ *              that is not an instruction is passed with a length of
+ *              0 and skipped as one word.
+ *
+ * Returns: The address after the last instruction decoded.
+ */
+uint16_t disassembleRange(WordSource source, uint16_t start, uint16_t count, InstructionSink sink) {
+    Instruction instr;
+    DecodedInstruction decoded;
+    uint16_t window[3];
+    uint16_t fetch_addr, used, i;
+
+    instr.address = start;
+    fetch_addr = start;
+    for (i = 0; i < 3; i++) {
+        window[i] = source(fetch_addr);
+        fetch_addr += 2;
+    }
+    while (count > 0) {
+        instr.operator = window[0];
+        instr.source = window[1];
+        instr.destination = window[2];
+        decode(&decoded, &instr);
+        sink(&decoded, window);
+
+        used = (decoded.length == 0) ? 1 : decoded.length;
+        instr.address += used << 1;
+        count--;
+        if (count == 0) {
+            break; // do not read past the range
+        }
+        // slide the window past the instruction
+        for (i = 0; i + used < 3; i++) {
+            window[i] = window[i + used];
+        }
+        for (; i < 3; i++) {
+            window[i] = source(fetch_addr);
+            fetch_addr += 2;
+        }
+    }
+    return instr.address;
+}
+
 /**
  * Appends the correct operand format based on the addressing mode
- * to result, but does not append a space.
+ * at cursor, but does not append a space.
  *
- * @param result: The destination string that the operand will be
- *                appended to.
+ * @param cursor: The position in the destination string that the
+ *                operand will be appended at.
  * @param pc:     The program counter, ie start address, of the current
  *                instruction. This is used in symbolic mode.
  * @param reg:    The register number associated with the operand.
@@ -203,13 +484,10 @@ bool getInstruction(char *buffer, Instruction *instr) {
  *
  * Returns: True if successful, false if an error occurred.
  */
-bool appendOperand(char* result, uint16_t pc, uint16_t reg, uint16_t word, addressingMode mode) {
-    // todo: convert to const hashmap instead of function
-    char regStr[4]; // max string "R15\0"
-    char wordStr[7]; // max string "0xFFFF\0"
-
-    parseRegisterNum(regStr, reg);
-    uintToHex(wordStr, word);
+bool appendOperand(TextCursor *cursor, uint16_t pc, uint16_t reg, uint16_t word, addressingMode mode) {
+    if (reg > 15) {
+        return false;
+    }
 
     switch (mode) {
     case REGISTER:
@@ -217,11 +495,11 @@ bool appendOperand(char* result, uint16_t pc, uint16_t reg, uint16_t word, addre
         switch (reg) {
         case 3:
             // R3/CG2 constant
-            strcat(result, "#0");
+            putText(cursor, "#0");
             return true;
         default:
             // register mode
-            strcat(result, regStr);
+            putText(cursor, REGISTER_NAMES[reg]);
             return true;
         }
     }
@@ -230,24 +508,23 @@ bool appendOperand(char* result, uint16_t pc, uint16_t reg, uint16_t word, addre
         switch (reg) {
         case 0:
             // symbolic mode
-            uintToHex(wordStr, pc + word);
-            strcat(result, wordStr);
+            putHex(cursor, pc + word);
             return true;
         case 2:
             // absolute mode
-            strcat(result, "&");
-            strcat(result, wordStr);
+            putChar(cursor, '&');
+            putHex(cursor, word);
             return true;
         case 3:
             // R3/CG2 constant
-            strcat(result, "#1");
+            putText(cursor, "#1");
             return true;
         default:
             // indexed mode
-            strcat(result, wordStr);
-            strcat(result, "(");
-            strcat(result, regStr);
-            strcat(result, ")");
+            putHex(cursor, word);
+            putChar(cursor, '(');
+            putText(cursor, REGISTER_NAMES[reg]);
+            putChar(cursor, ')');
             return true;
         }
     }
@@ -256,16 +533,16 @@ bool appendOperand(char* result, uint16_t pc, uint16_t reg, uint16_t word, addre
         switch (reg) {
         case 2:
             // R2/CG1 constant
-            strcat(result, "#4");
+            putText(cursor, "#4");
             return true;
         case 3:
             // R3/CG2 constant
-            strcat(result, "#2");
+            putText(cursor, "#2");
             return true;
         default:
             // indirect mode
-            strcat(result, "@");
-            strcat(result, regStr);
+            putChar(cursor, '@');
+            putText(cursor, REGISTER_NAMES[reg]);
             return true;
         }
     }
@@ -274,22 +551,22 @@ bool appendOperand(char* result, uint16_t pc, uint16_t reg, uint16_t word, addre
         switch (reg) {
         case 0:
             // immediate mode
-            strcat(result, "#");
-            strcat(result, wordStr);
+            putChar(cursor, '#');
+            putHex(cursor, word);
             return true;
         case 2:
             // R2/CG1 constant
-            strcat(result, "#8");
+            putText(cursor, "#8");
             return true;
         case 3:
             // R3/CG2 constant
-            strcat(result, "#-1");
+            putText(cursor, "#-1");
             return true;
         default:
             // autoincrement mode
-            strcat(result, "@");
-            strcat(result, regStr);
-            strcat(result, "+");
+            putChar(cursor, '@');
+            putText(cursor, REGISTER_NAMES[reg]);
+            putChar(cursor, '+');
             return true;
         }
     }
@@ -301,121 +578,91 @@ bool appendOperand(char* result, uint16_t pc, uint16_t reg, uint16_t word, addre
     return false;
 }
 
-struct emulationData {
-    uint16_t op_bytes;
-    uint16_t srcWord;
-    uint16_t destWord;
-    addressingMode srcMode;
-    addressingMode destMode;
-    uint16_t srcReg;
-    uint16_t destReg;
-    uint16_t startAddr;
-    bool isByteOp;
+/*
+ * Dispatch tables of getOpCodeId(). Every mask in masks.h only uses
+ * bits 15-7 of the instruction word, and the first CODES[] entry
+ * a word matches is decided by the top nibble, then bits 12-10 for
+ * jumps or bits 9-7 for single-operand instructions. Each entry is
+ * placed by its mask, so the tables follow masks.h, and
+ * bench_opcode checks them against getOpCodeLinear().
+ */
+#define NIBBLE_INDEX(mask) ((mask) >> 12)
+#define JUMP_INDEX(mask)   (((mask) >> 10) & 0x7)
+#define SINGLE_INDEX(mask) (((mask) >> 7) & 0x7)
+
+static const uint8_t NIBBLE_CODES[16] = {
+       [0x0] = ERROR_ID, // see SINGLE_CODES and JUMP_CODES
+       [0x1] = ERROR_ID,
+       [0x2] = ERROR_ID,
+       [0x3] = ERROR_ID,
+       [NIBBLE_INDEX(MOV_MASK)] = MOV_ID,
+       [NIBBLE_INDEX(ADD_MASK)] = ADD_ID,
+       [NIBBLE_INDEX(ADDC_MASK)] = ADDC_ID,
+       [NIBBLE_INDEX(SUBC_MASK)] = SUBC_ID,
+       [NIBBLE_INDEX(SUB_MASK)] = SUB_ID,
+       [NIBBLE_INDEX(CMP_MASK)] = CMP_ID,
+       [NIBBLE_INDEX(DADD_MASK)] = DADD_ID,
+       [NIBBLE_INDEX(BIT_MASK)] = BIT_ID,
+       [NIBBLE_INDEX(BIC_MASK)] = BIC_ID,
+       [NIBBLE_INDEX(BIS_MASK)] = BIS_ID,
+       [NIBBLE_INDEX(XOR_MASK)] = XOR_ID,
+       [NIBBLE_INDEX(AND_MASK)] = AND_ID,
 };
 
-bool isADC(struct emulationData *data) {
-    return data->srcReg == 3 && data->srcMode == REGISTER;
-}
-
-bool isRLC(struct emulationData *data) {
-    return data->srcReg == data->destReg &&
-           data->srcMode == REGISTER &&
-           data->destMode == REGISTER;
-}
-
-bool isTest(struct emulationData *data) {
-    return data->srcReg == 3 && data->srcMode == REGISTER;
-}
-
-
-int searchEmulated(char *result, opCode *op, uint16_t start_addr, uint16_t *byte_code) {
-    int totWords = -1;
-
-    struct emulationData data = {
-         byte_code[0], // op_bytes
-         byte_code[1], // srcWord
-         byte_code[2], // destWord
-         getSourceRegisterMode(byte_code[0], DOUBLE), // srcMode
-         getDestRegisterMode(byte_code[0]), // destMode
-         getSourceRegister(byte_code[0], DOUBLE), // srcReg
-         getDestRegister(byte_code[0]), // destReg
-         start_addr, // startAddr
-         isByteOperation(byte_code[0]), // isByteOp
-    };
+static const uint8_t JUMP_CODES[8] = {
+       [JUMP_INDEX(JNE_MASK)] = JNE_ID,
+       [JUMP_INDEX(JEQ_MASK)] = JEQ_ID,
+       [JUMP_INDEX(JNC_MASK)] = JNC_ID,
+       [JUMP_INDEX(JC_MASK)] = JC_ID,
+       [JUMP_INDEX(JN_MASK)] = JN_ID,
+       [JUMP_INDEX(JGE_MASK)] = JGE_ID,
+       [JUMP_INDEX(JL_MASK)] = JL_ID,
+       [JUMP_INDEX(JMP_MASK)] = JMP_ID,
+};
 
-    switch (op->mask) {
-    case ADD_MASK:
-    {
+static const uint8_t SINGLE_CODES[8] = {
+       [SINGLE_INDEX(RRC_MASK)] = RRC_ID,
+       [SINGLE_INDEX(SWPB_MASK)] = SWPB_ID,
+       [SINGLE_INDEX(RRA_MASK)] = RRA_ID,
+       [SINGLE_INDEX(SXT_MASK)] = SXT_ID,
+       [SINGLE_INDEX(PUSH_MASK)] = PUSH_ID,
+       [SINGLE_INDEX(CALL_MASK)] = CALL_ID,
+       [SINGLE_INDEX(RETI_MASK)] = RETI_ID,
+       [SINGLE_INDEX(RETI_MASK | 0x0080)] = RETI_ID, // RETI_MASK matches 0x1380 too
+};
 
-        break;
+/**
+ * Returns the index in CODES[] of the opcode of the instruction
+ * word byteCode in constant time.
+ */
+opCodeId getOpCodeId(uint16_t byteCode) {
+    switch (byteCode >> 12) {
+    case 0x0:
+        return ERROR_ID;
+    case 0x1:
+        return (opCodeId) SINGLE_CODES[(byteCode >> 7) & 0x7];
+    case 0x2:
+    case 0x3:
+        return (opCodeId) JUMP_CODES[(byteCode >> 10) & 0x7];
+    default:
+        return (opCodeId) NIBBLE_CODES[byteCode >> 12];
     }
-    case ADDC_MASK:
-    {
+}
 
-        if (isADC(&data)) {
-            // ADC(.B) dst | ADDC(.B) #0 dst | ADDC(.B) R3 dst
-            strcpy(result, "ADC");
-            appendByteOp(result, data.isByteOp);
-            data.destWord = data.srcWord;
-            totWords = 2;
-            totWords += appendOperand(result, data.startAddr, data.destReg, data.destWord, data.destMode);
-        } else if (isRLC(&data)) {
-            strcpy(result, "RLC");
-            appendByteOp(result, data.isByteOp);
-            appendOperand(result, data.startAddr, data.srcReg, data.srcWord, data.srcMode);
-            totWords = 1;
-        }
-        break;
-    }
-    case MOV_MASK:
-    {
-        break; // TODO: Handle Emulated Instruction
-    }
-    case BIC_MASK:
-    {
-        break; // TODO: Handle Emulated Instruction
-    }
-    case BIS_MASK:
-    {
-        break; // TODO: Handle Emulated Instruction
-    }
-    case DADD_MASK:
-    {
-        break; // TODO: Handle Emulated Instruction
-    }
-    case SUB_MASK:
-    {
-        break; // TODO: Handle Emulated Instruction
-    }
-    case SUBC_MASK:
-    {
-        break; // TODO: Handle Emulated Instruction
-    }
-    case XOR_MASK:
-    {
-        break; // TODO: Handle Emulated Instruction
-    }
-    case CMP_MASK:
-    {
-        if (isTest(&data)) {
-            strcpy(result, "ADC");
-            appendByteOp(result, data.isByteOp);
-            data.destWord = data.srcWord;
-            totWords = 2;
-            totWords += appendOperand(result, data.startAddr, data.destReg, data.destWord, data.destMode);
-        }
-        break;
-    }
-    default: // no valid emulated instruction
-    {
-        break;
-    }
-    }
-    return totWords;
+/**
+ * Returns the opcode of the instruction word byteCode in constant
+ * time. Matches getOpCodeLinear() for every word.
+ */
+opCode getOpCode(uint16_t byteCode) {
+    return CODES[getOpCodeId(byteCode)];
 }
 
+/**
+ * Returns the opcode of byteCode by testing the masks of CODES[]
+ * in order. Kept as the reference for getOpCode().
+ */
 // NOTE: order matters here! some masks are submasks of others!
-opCode getOpCode(uint16_t byteCode) {
+opCode getOpCodeLinear(uint16_t byteCode) {
     // Note: Order of opcodes is set in disassembler.h
     //       and is made so submasks are checked late.
     unsigned int i = 0;
@@ -557,14 +804,10 @@ void byteCodeToOffset(char* result, uint16_t byteCode) {
  * size 4 to not overflow.
  */
 void parseRegisterNum(char* result, uint16_t regNum) {
-    static const char* map[] = { "PC", "SP", "SR", "CG2",
-                                 "R4", "R5", "R6", "R7",
-                                 "R8", "R9", "R10", "R11",
-                                 "R12", "R13", "R14", "R15" };
     if (regNum > 15) {
         result = strcpy(result, "ERR");
     } else {
-        result = strcpy(result, map[regNum]);
+        result = strcpy(result, REGISTER_NAMES[regNum]);
     }
 }
 
@@ -574,14 +817,10 @@ void parseRegisterNum(char* result, uint16_t regNum) {
  * buffer of minimum size 7 to not overflow.
  */
 void uintToHex(char* result, uint16_t input) {
-    char* map = "0123456789ABCDEF";
-    result[0] = '0';
-    result[1] = 'x';
-    result[2] = map[(input >> 12) & 0x000F];
-    result[3] = map[(input >> 8) & 0x000F];
-    result[4] = map[(input >> 4) & 0x000F];
-    result[5] = map[input & 0x000F];
-    result[6] = '\0';
+    TextCursor cursor;
+
+    initCursor(&cursor, result, 7);
+    putHex(&cursor, input);
 }
 
 
@@ -11,15 +11,33 @@
 
 bool test_single_instructions(void);
 bool test_addc(void);
+bool test_opcode_dispatch(void);
+bool test_instruction_length(void);
+bool test_decode(void);
+bool test_format_golden(void);
+bool test_emulated(void);
+bool test_disassemble_range(void);
 
 static bool (*test_funcs[])(void) = {
                                      test_single_instructions,
                                      test_addc,
+                                     test_opcode_dispatch,
+                                     test_instruction_length,
+                                     test_decode,
+                                     test_format_golden,
+                                     test_emulated,
+                                     test_disassemble_range,
 };
 
 static char* test_names[] = {
                              "test_single_instructions",
                              "test_addc",
+                             "test_opcode_dispatch",
+                             "test_instruction_length",
+                             "test_decode",
+                             "test_format_golden",
+                             "test_emulated",
+                             "test_disassemble_range",
 };
 
 
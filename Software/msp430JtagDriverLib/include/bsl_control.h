@@ -0,0 +1,53 @@
+/*
+ * bsl_control.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * BSL Targets: MSP430G2553.
+ *
+ * Reads target memory through the ROM bootstrap loader (BSL) over a
+ * bit banged UART instead of JTAG. A single data block command
+ * returns up to 250 bytes, where readMem() needs six scans for every
+ * word. bslBytesPerSecond() reports the measured rate of a read, to
+ * be compared against the same read over JTAG.
+ * The pins go through the backend of jtag_config.h, so the host
+ * build of msp430JtagHostTest runs this against a model of the BSL.
+ *
+ * BSL Protocol Reference: https://www.ti.com/lit/ug/slau319/slau319.pdf
+ */
+
+#ifndef INCLUDE_BSL_CONTROL_H_
+#define INCLUDE_BSL_CONTROL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+bool bslEnter();
+void bslExit();
+bool bslUnlock(const uint16_t *password);
+bool bslReadBlock(uint16_t address, uint16_t *buffer, uint16_t length);
+uint16_t bslReadMem(uint16_t address);
+uint16_t bslBytesPerSecond();
+
+/***
+ * The largest data block the BSL returns for one TX data
+ * block command, in bytes.
+ */
+#define BSL_MAX_BLOCK (250)
+
+/***
+ * Length of the BSL password, which is the contents of
+ * the interrupt vector table at 0xFFE0-0xFFFF.
+ */
+#define BSL_PASSWORD_WORDS (16)
+
+// BSL Protocol Bytes:
+
+#define BSL_SYNC        (0x80)  // synchronization and frame header
+#define BSL_ACK         (0x90)  // command accepted
+#define BSL_NAK         (0xA0)  // command rejected
+#define BSL_RX_PASSWORD (0x10)  // unlock the BSL with the vector table
+#define BSL_TX_BLOCK    (0x14)  // transmit a block of target memory
+
+#endif /* INCLUDE_BSL_CONTROL_H_ */
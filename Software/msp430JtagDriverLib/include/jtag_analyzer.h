@@ -0,0 +1,82 @@
+/*
+ * jtag_analyzer.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * A logic analyzer built from JTAG memory reads. Byte registers of
+ * the target, such as P1IN and P2IN, are read repeatedly and every
+ * change of value is logged with the JTAG_TIMESTAMP() time and the
+ * number of the sample it was seen in. Between samples the target
+ * CPU can be clocked for a fixed number of TCLK cycles, which makes
+ * the sample number times the cycles an exact target MCLK time
+ * even though the target runs far below full speed.
+ *
+ * With zero cycles between samples the target is frozen and the
+ * analyzer instead measures how fast registers can be read over
+ * the JTAG transport.
+ *
+ * A run is streamed as its changes alone, each timed relative to
+ * the one before, rather than as a waveform, which would take the
+ * debugger far longer to format and send:
+ *
+ *     ANALYZER <channels> <microseconds per timestamp count>
+ *     C<name>                        one per channel, in order
+ *     V<counts> <channel> <value>    one per change
+ *     END <counts>                   from the last change to the end
+ *
+ * Numbers are hexadecimal without leading zeros, counts those of
+ * JTAG_TIMESTAMP() since the previous change or the start of the
+ * run. analyzervcd of msp430JtagHostTest turns the stream into a VCD
+ * waveform with one 8-bit signal per channel.
+ */
+
+#ifndef INCLUDE_JTAG_ANALYZER_H_
+#define INCLUDE_JTAG_ANALYZER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "jtag_text.h"
+
+/*
+ * A target byte register to sample.
+ */
+struct AnalyzerChannel {
+    /* Address of the register, eg 0x0020 for P1IN */
+    uint16_t address;
+    /* Name of the signal in a waveform */
+    char *name;
+};
+
+typedef struct AnalyzerChannel AnalyzerChannel;
+
+/*
+ * A change of value on one channel, 8 bytes per entry.
+ */
+struct AnalyzerEvent {
+    /* JTAG_TIMESTAMP() counts from the start of the run to the
+     * sample, unwrapped to 32 bits */
+    uint32_t time;
+    /* The sample the new value was first seen in */
+    uint16_t sample;
+    /* Index of the channel */
+    uint8_t channel;
+    /* The new value */
+    uint8_t value;
+};
+
+typedef struct AnalyzerEvent AnalyzerEvent;
+
+uint16_t runAnalyzer(const AnalyzerChannel *channels, uint8_t count,
+                     uint16_t samples, uint16_t cycles);
+const AnalyzerEvent *getAnalyzerEvents();
+uint16_t getAnalyzerLength();
+uint32_t getAnalyzerElapsed();
+void writeAnalyzerLog(TextSink sink);
+
+/***
+ * The most channels sampled at once.
+ */
+#define ANALYZER_CHANNELS (8)
+
+#endif /* INCLUDE_JTAG_ANALYZER_H_ */
@@ -0,0 +1,33 @@
+/*
+ * jtag_capture.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Writes the capture log of jtag_fsm.c as text, so a session
+ * recorded on the debugger can be replayed on a host against the
+ * TAP model of msp430JtagHostTest with its jtagreplay tool, which
+ * reports every scan whose TDO differs. Only built with
+ * JTAG_CAPTURE defined.
+ *
+ * The log is a series of lines, all numbers in hexadecimal:
+ *
+ *     CAPTURE <jtag id> <1 if scans were dropped, else 0>
+ *     S<type> <bits 19-16> <input> <output> <timestamp>
+ *     END
+ *
+ * with one S line per record, type being one of the SCAN_ values
+ * of jtag_fsm.h and bits 19-16 packed as in ScanRecord.
+ */
+
+#ifndef INCLUDE_JTAG_CAPTURE_H_
+#define INCLUDE_JTAG_CAPTURE_H_
+
+#include <stdint.h>
+#include "jtag_text.h"
+
+#ifdef JTAG_CAPTURE
+void writeCapture(TextSink sink);
+#endif
+
+#endif /* INCLUDE_JTAG_CAPTURE_H_ */
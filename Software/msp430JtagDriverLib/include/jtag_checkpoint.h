@@ -0,0 +1,59 @@
+/*
+ * jtag_checkpoint.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Checkpoint Targets: MSP430G2553.
+ *
+ * Saves the RAM and CPU registers of a halted target into a debugger
+ * store and writes them back later, so a test case on the target
+ * can be rerun from the same state without reflashing or power
+ * cycling it. Flash and peripheral registers are not saved.
+ *
+ * A checkpoint is CHECKPOINT_WORDS words, 544 bytes, more than the
+ * free RAM of a G2553 debugger. It is therefore moved through the
+ * store CHECKPOINT_CHUNK_WORDS words at a time, so the store can be
+ * debugger flash as well as RAM.
+ */
+
+#ifndef INCLUDE_JTAG_CHECKPOINT_H_
+#define INCLUDE_JTAG_CHECKPOINT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/***
+ * Start and size of the target RAM saved by a checkpoint.
+ */
+#define CHECKPOINT_RAM_START (0x0200)
+#define CHECKPOINT_RAM_WORDS (256)
+
+/***
+ * Layout of a checkpoint: R0 to R15 with R3 unused, then the RAM.
+ */
+#define CHECKPOINT_REGS  (16)
+#define CHECKPOINT_WORDS (CHECKPOINT_REGS + CHECKPOINT_RAM_WORDS)
+
+/***
+ * The most words moved to or from the store at once.
+ */
+#define CHECKPOINT_CHUNK_WORDS (16)
+
+/*
+ * Where a checkpoint is kept. Both functions move count words at a
+ * word offset into the checkpoint. A checkpoint is saved in order
+ * from offset 0 to CHECKPOINT_WORDS, so a store can prepare itself
+ * on offset 0 and mark the checkpoint complete on the last words.
+ */
+struct CheckpointStore {
+    void (*save)(uint16_t offset, const uint16_t *words, uint16_t count);
+    void (*load)(uint16_t offset, uint16_t *words, uint16_t count);
+};
+
+typedef struct CheckpointStore CheckpointStore;
+
+bool checkpoint(const CheckpointStore *store);
+bool restore(const CheckpointStore *store);
+
+#endif /* INCLUDE_JTAG_CHECKPOINT_H_ */
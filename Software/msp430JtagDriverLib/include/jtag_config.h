@@ -8,8 +8,16 @@
 #ifndef JTAG_CONFIG_H_
 #define JTAG_CONFIG_H_
 
-#include <msp430.h>
 #include <stdint.h>
+#ifdef ESP_PLATFORM
+#include "jtag_pins.h"  // ESP32 pin numbers and pin HAL, see the ESP32 project
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#elif defined(JTAG_HOST)
+#include "jtag_host_pins.h"  // pins of the TAP model, see msp430JtagHostTest
+#else
+#include <msp430.h>
+#endif
 
 /*
  * JTAG GPIO Pins
@@ -42,6 +50,183 @@
 #define TCK         (BIT7)      // JTAG clock input: target pin 6
 #endif
 
+#ifdef ESP_PLATFORM
+#define TEST        (TEN)       // JTAG enable pins, named TEN by the ESP32 project
+#endif
+
+/*
+ * Pin Backend
+ *
+ * The JTAG protocol core in jtag_fsm.c only touches the pins through
+ * these macros, so the same core is compiled for every debugger. On
+ * the MSP430 they are single port register operations, on the ESP32
+ * they map onto the inline pin HAL of jtag_pins.h. A host build with
+ * JTAG_HOST defined drives the TAP model of msp430JtagHostTest.
+ *
+ * JTAG_HIGH/JTAG_LOW: drive an output pin
+ * JTAG_READ: sample an input pin
+ * JTAG_DRIVEN: the level an output pin is driven to
+ * JTAG_CLAIM_PINS: make TDO an input with a pulldown, the rest outputs
+ * JTAG_FUSE_DELAY: pad a fuse check TMS phase to 5 microseconds
+ */
+#ifdef ESP_PLATFORM
+#define JTAG_HIGH(pin)      pinHigh(pin)
+#define JTAG_LOW(pin)       pinLow(pin)
+#define JTAG_READ(pin)      (pinRead(pin) != 0)
+#define JTAG_DRIVEN(pin)    (pinDriven(pin) != 0)
+#define JTAG_CLAIM_PINS()   jtagClaimPins()
+#define JTAG_FUSE_DELAY()   esp_rom_delay_us(5)
+#elif defined(JTAG_HOST)
+#define JTAG_HIGH(pin)      pinHigh(pin)
+#define JTAG_LOW(pin)       pinLow(pin)
+#define JTAG_READ(pin)      (pinRead(pin) != 0)
+#define JTAG_DRIVEN(pin)    (pinDriven(pin) != 0)
+#define JTAG_CLAIM_PINS()   hostClaimPins()
+#define JTAG_FUSE_DELAY()   hostDelay(4)
+#else
+#define JTAG_HIGH(pin)      (JTAGOUT |= (pin))
+#define JTAG_LOW(pin)       (JTAGOUT &= ~(pin))
+#define JTAG_READ(pin)      ((JTAGIN & (pin)) != 0)
+#define JTAG_DRIVEN(pin)    ((JTAGOUT & (pin)) != 0)
+#define JTAG_CLAIM_PINS()   do { JTAGREN = TDO; JTAGDIR = 0xFF; JTAGDIR &= ~TDO; } while (0)
+#define JTAG_FUSE_DELAY()   __delay_cycles(4) // one more port write at 1MHz
+#endif
+
+/*
+ * Spy-Bi-Wire Pins
+ *
+ * Defining JTAG_SBW selects the 2-wire Spy-Bi-Wire transport, which
+ * only uses the TEST and RST connections of the target. TDO, TDI,
+ * TMS and TCK are then left untouched for other use, such as the
+ * display data bus.
+ */
+#ifdef JTAG_SBW
+#define SBWTCK      (TEST)      // Spy-Bi-Wire clock on the TEST pin
+#define SBWTDIO     (RST)       // Spy-Bi-Wire data on the RST pin
+#define SBW_LOW_MAX_US (7)      // longest SBWTCK low phase before the target drops out
+#endif
+
+/*
+ * Timing and Direction Backend
+ *
+ * The pin operations the Spy-Bi-Wire transport and the BSL UART need
+ * on top of the pin backend above. Neither is built for the ESP32.
+ * Every SBWTCK low phase is at most two port accesses, which is 8us
+ * at the 1MHz MCLK, so a target held to SBW_LOW_MAX_US needs the
+ * debugger MCLK at 2MHz or more.
+ *
+ * JTAG_INPUT/JTAG_OUTPUT: turn a pin around, eg SBWTDIO for the TDO slot
+ * JTAG_CLAIM_SBW_PINS: make SBWTCK and SBWTDIO outputs, no resistors
+ * JTAG_CLAIM_BSL_PINS: make TEST, RST and BSLOUT outputs, BSLIN a bare input
+ * JTAG_DELAY_CYCLES: wait a number of MCLK cycles
+ * JTAG_HOLD_INTERRUPTS: save the interrupt state and disable them
+ * JTAG_RESTORE_INTERRUPTS: restore the state JTAG_HOLD_INTERRUPTS saved
+ */
+#if defined(ESP_PLATFORM)
+#ifdef JTAG_SBW
+#error "Spy-Bi-Wire is only implemented for the MSP430 and host builds"
+#endif
+#elif defined(JTAG_HOST)
+#define JTAG_INPUT(pin)         pinInput(pin)
+#define JTAG_OUTPUT(pin)        pinOutput(pin)
+#define JTAG_CLAIM_SBW_PINS()   hostClaimSbwPins()
+#define JTAG_CLAIM_BSL_PINS()   hostClaimBslPins()
+#define JTAG_DELAY_CYCLES(n)    hostDelay(n)
+#define JTAG_HOLD_INTERRUPTS(state)     ((state) = 0)
+#define JTAG_RESTORE_INTERRUPTS(state)  ((void) (state))
+#else
+#define JTAG_INPUT(pin)         (JTAGDIR &= ~(pin))
+#define JTAG_OUTPUT(pin)        (JTAGDIR |= (pin))
+#define JTAG_CLAIM_SBW_PINS()   do { JTAGREN &= ~(SBWTCK + SBWTDIO); JTAGDIR |= SBWTCK + SBWTDIO; } while (0)
+#define JTAG_CLAIM_BSL_PINS()   do { JTAGDIR |= TEST + RST + BSLOUT; JTAGDIR &= ~BSLIN; JTAGREN &= ~BSLIN; } while (0)
+#define JTAG_DELAY_CYCLES(n)    __delay_cycles(n)
+#define JTAG_HOLD_INTERRUPTS(state)     do { (state) = __get_SR_register() & GIE; __disable_interrupt(); } while (0)
+#define JTAG_RESTORE_INTERRUPTS(state)  __bis_SR_register(state)
+#endif
+
+/*
+ * Bootstrap Loader (BSL) Pins
+ *
+ * The target ROM BSL receives on its P1.5, which is already wired to
+ * the TMS line, and transmits on its P1.1, which must be jumpered to
+ * the TDO line for BSL transfers. The UART is bit banged at BSL_BAUD
+ * assuming the 1MHz calibrated DCO set up by the backchannel.
+ */
+#define BSLOUT      (TMS)       // debugger to target BSL (target P1.5)
+#define BSLIN       (TDO)       // target BSL to debugger (target P1.1)
+#define BSL_BAUD        (9600)
+#define BSL_BIT_CYCLES  (104)   // MCLK cycles per UART bit at 1MHz
+#define BSL_TIMEOUT     (20000) // polls of BSLIN before a reply is abandoned
+#ifdef JTAG_HOST
+#define BSL_LOOP_CYCLES (4)     // per bit, the port access is all the host model counts
+#else
+#define BSL_LOOP_CYCLES (12)    // per bit, the port access, shift and loop count
+#endif
+
+/*
+ * JTAG Sync Limits
+ *
+ * Bound the time spent waiting on an unresponsive target so that a
+ * bad connection fails fast instead of hanging the debugger.
+ */
+#define SYNC_POLLS      (50)    // TCE polls per sync attempt
+#define SYNC_RETRIES    (3)     // JTAG re-entries through initFSM() after a failed attempt
+#define SYNC_BACKOFF    (100)   // delay loops before the first re-entry, doubled per retry
+#define FETCH_TRIES     (8)     // TCLK cycles allowed to reach the instruction-fetch state
+
+/*
+ * Free-running counter used to timestamp sync attempts, captured
+ * scans and analyzer samples. The debugger keeps timer A1 running
+ * in continuous mode from SMCLK/8, 8us per count at 1MHz, so the
+ * count wraps every 524ms and differences are taken modulo 2^16.
+ * The ESP32 uses the low bits of its microsecond timer, a host
+ * build counts the cycles of a modelled 1MHz MCLK, see tap_model.c.
+ */
+#ifdef ESP_PLATFORM
+#define JTAG_TIMESTAMP() ((uint16_t) esp_timer_get_time())
+#define JTAG_TIMESTAMP_US (1)   // microseconds per count
+#elif defined(JTAG_HOST)
+#define JTAG_TIMESTAMP() (hostTimestamp())
+#define JTAG_TIMESTAMP_US (1)   // microseconds per count
+#else
+#define JTAG_TIMESTAMP() (TA1R)
+#define JTAG_TIMESTAMP_US (8)   // microseconds per count
+#endif
+
+/*
+ * Number of records kept by the capture log when JTAG_CAPTURE is
+ * defined, 8 bytes each. Kept small for the 512 bytes of RAM on
+ * the G2553.
+ */
+#if defined(__MSP430F5529__) || defined(ESP_PLATFORM) || defined(JTAG_HOST)
+#define JTAG_CAPTURE_DEPTH (256)
+#endif
+#ifdef __MSP430G2553__
+#define JTAG_CAPTURE_DEPTH (24)
+#endif
+
+/*
+ * Window of target flash tracked by the coverage bitmap, which takes
+ * two bits of debugger RAM per word. The F5529 covers all 16KB of
+ * G2553 flash, the G2553 only the first 1KB.
+ */
+#define COVERAGE_START (0xC000)
+#if defined(__MSP430F5529__) || defined(ESP_PLATFORM)
+#define COVERAGE_WORDS (8192)
+#endif
+#ifdef __MSP430G2553__
+#define COVERAGE_WORDS (512)
+#endif
+
+/*
+ * Number of value changes kept by the logic analyzer, 8 bytes each.
+ */
+#if defined(__MSP430F5529__) || defined(ESP_PLATFORM) || defined(JTAG_HOST)
+#define ANALYZER_DEPTH (1024)
+#endif
+#ifdef __MSP430G2553__
+#define ANALYZER_DEPTH (16)
+#endif
 
 
 #endif /* JTAG_CONFIG_H_ */
@@ -9,16 +9,60 @@
 #define INCLUDE_JTAG_CONTROL_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 
-void getDevice();
+/*
+ * Telemetry for target sync, kept so that a bad connection on a
+ * fixture can be diagnosed after the fact. Timestamps are raw
+ * JTAG_TIMESTAMP() counts, see jtag_config.h.
+ */
+struct SyncStats {
+    /* Calls to getDevice() that synced with the target */
+    uint16_t syncs;
+    /* Calls to getDevice() that gave up on the target */
+    uint16_t failures;
+    /* Times the JTAG entry sequence was rerun to recover a sync */
+    uint16_t reentries;
+    /* Calls to setInstrFetch() that gave up on the target */
+    uint16_t fetch_failures;
+    /* TCE polls needed by the most recent successful sync */
+    uint16_t last_polls;
+    /* Largest number of TCE polls needed by any successful sync */
+    uint16_t max_polls;
+    /* Timestamp taken when the most recent getDevice() began */
+    uint16_t last_start;
+    /* Timestamp taken when the most recent getDevice() returned */
+    uint16_t last_end;
+};
+
+typedef struct SyncStats SyncStats;
+
+bool getDevice();
+bool resumeDevice();
+bool waitInstrFetch(uint16_t tries);
 bool setInstrFetch();
+const SyncStats *getSyncStats();
+void clrSyncStats();
 void setPC(uint16_t address);
 void haltCPU();
 void releaseCPU();
+bool runCPU();
 void executePOR();
 void releaseDevice();
 uint16_t readMem(uint16_t address);
+uint8_t readMemByte(uint16_t address);
 void writeMem(uint16_t address, uint16_t data);
+uint16_t readReg(uint8_t reg);
+void writeReg(uint8_t reg, uint16_t value);
+void readMemQuick(uint16_t address, uint16_t *buffer, uint16_t length);
+void writeMemQuick(uint16_t address, const uint16_t *buffer, uint16_t length);
+bool getPSA(uint16_t address, uint16_t length, uint16_t *psa);
+uint16_t calcPSA(uint16_t address, const uint16_t *buffer, uint16_t length);
+uint8_t getJtagId();
+void setPC20(uint32_t address);
+uint16_t readMem20(uint32_t address);
+void writeMem20(uint32_t address, uint16_t data);
+void readMemQuick20(uint32_t address, uint16_t *buffer, uint16_t length);
 
 
 #endif /* INCLUDE_JTAG_CONTROL_H_ */
@@ -0,0 +1,38 @@
+/*
+ * jtag_coverage.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Code coverage of an uninstrumented target. The target is run one
+ * instruction fetch at a time by stepping TCLK, and the address of
+ * every instruction fetched inside the window set in jtag_config.h
+ * is marked in a bitmap of one bit per flash word.
+ *
+ * The bitmap is streamed as the runs of words covered since the last
+ * stream, so a host only receives what changed. Runs are run-length
+ * encoded relative to the end of the run before, or the window start
+ * for the first, so each line is a few digits:
+ *
+ *     COVERAGE <window start> <window words>
+ *     D<words skipped> <words covered>   one per run of newly covered words
+ *     END
+ *
+ * Numbers are hexadecimal without leading zeros. Successive streams
+ * can be appended to one file, which covreport of msp430Simulator
+ * renders as a disassembly listing of what was covered.
+ */
+
+#ifndef INCLUDE_JTAG_COVERAGE_H_
+#define INCLUDE_JTAG_COVERAGE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "jtag_text.h"
+
+void clrCoverage();
+uint16_t sampleCoverage(uint16_t steps);
+bool isCovered(uint16_t address);
+void writeCoverage(TextSink sink);
+
+#endif /* INCLUDE_JTAG_COVERAGE_H_ */
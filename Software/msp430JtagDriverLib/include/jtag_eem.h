@@ -0,0 +1,88 @@
+/*
+ * jtag_eem.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * EEM Targets: MSP430G2553 (EEM-S, two triggers).
+ *
+ * Data watchpoints built from the triggers of the target's Embedded
+ * Emulation Module (EEM). A watchpoint compares the memory address
+ * bus (MAB) against an address and optionally the memory data bus
+ * (MDB) against a value, and stops the CPU when a matching read or
+ * write happens while the target runs at full speed through runCPU().
+ * A watchpoint on a value takes two triggers, one without takes one.
+ *
+ * EEM Reference: https://www.ti.com/lit/ug/slau414f/slau414f.pdf
+ */
+
+#ifndef INCLUDE_JTAG_EEM_H_
+#define INCLUDE_JTAG_EEM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * A watchpoint on one word of target memory.
+ */
+struct Watchpoint {
+    /* The address to watch */
+    uint16_t address;
+    /* The value the access must carry, if match_value is set */
+    uint16_t value;
+    /* Only stop on accesses carrying value */
+    bool match_value;
+    /* WATCH_READ, WATCH_WRITE or both */
+    uint8_t access;
+};
+
+typedef struct Watchpoint Watchpoint;
+
+bool setWatchpoint(const Watchpoint *watch);
+void clrWatchpoints();
+bool isWatchpointHit();
+
+#define WATCH_READ  (0x01)
+#define WATCH_WRITE (0x02)
+
+/***
+ * The number of EEM triggers of the target.
+ */
+#define EEM_TRIGGERS (2)
+
+// EEM registers, selected by the DR_SHIFT after IR_EMEX_DATA_EXCHANGE
+// with EEM_READ or EEM_WRITE added. Trigger n has its registers at an
+// offset of 8 * n.
+
+#define EEM_WRITE        (0x0000)
+#define EEM_READ         (0x0001)
+#define EEM_MBTRIGxVAL   (0x0000)
+#define EEM_MBTRIGxCTL   (0x0002)
+#define EEM_MBTRIGxMSK   (0x0004)
+#define EEM_MBTRIGxCMB   (0x0006)
+#define EEM_BREAKREACT   (0x0080)
+#define EEM_GENCTRL      (0x0082)
+
+// MBTRIGxCTL bits
+
+#define EEM_MAB          (0x0000)
+#define EEM_MDB          (0x0001)
+#define EEM_CMP_EQUAL    (0x0000)
+#define EEM_ACCESS_RW    (0x0040) // read or write, but no instruction fetch
+#define EEM_ACCESS_READ  (0x0080) // read, but no instruction fetch
+#define EEM_ACCESS_WRITE (0x00A0) // write, but no instruction fetch
+
+// GENCTRL bits
+
+#define EEM_EN           (0x0001)
+#define EEM_CLEAR_STOP   (0x0002)
+#define EEM_CLK_EN       (0x0004)
+#define EEM_FEAT_EN      (0x0008)
+
+/***
+ * Set in the EEM control register once a trigger has stopped
+ * the CPU, read through IR_EMEX_READ_CONTROL.
+ */
+#define EEM_STOPPED      (0x0080)
+
+#endif /* INCLUDE_JTAG_EEM_H_ */
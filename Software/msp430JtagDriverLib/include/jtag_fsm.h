@@ -4,11 +4,13 @@
  *  Created on: Jun 19, 2023
  *      Author: Jaden Baptista
  *
- * JTAG Targets: MSP430G2553.
+ * JTAG Targets: MSP430G2553, MSP430Xv2 (20-bit memory access).
  *
  * Function definitions to drive the target's JTAG finite state machine (FSM).
  * This is accomplished through the use of bit banging. Interrupts won't cause
  * failure because the JTAG clock input (TCK) has no minimum switching speed.
+ * The 4-wire transport only reaches the pins through the pin backend of
+ * jtag_config.h, so it is shared by the MSP430 and ESP32 debuggers.
  *
  * JTAG Interface Reference: https://www.ti.com/lit/ug/slau320aj/slau320aj.pdf
  */
@@ -19,13 +21,101 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/*
+ * Running totals of JTAG traffic, used to measure the cost
+ * of debugger actions in scans. Only kept when JTAG_SCAN_COUNTS
+ * is defined, as counting costs time on every scan and TCLK edge.
+ */
+struct ScanCounts {
+    /* IR_SHIFT calls */
+    uint16_t ir_scans;
+    /* DR_SHIFT and DR_SHIFT20 calls */
+    uint16_t dr_scans;
+    /* SetTCLK and ClrTCLK calls */
+    uint16_t tclk_edges;
+};
+
+typedef struct ScanCounts ScanCounts;
+
+/*
+ * One entry of the capture log, 8 bytes per scan or TCLK edge.
+ */
+struct ScanRecord {
+    /* The kind of scan, one of the SCAN_ values below */
+    uint8_t type;
+    /* Bits 19-16 of a 20-bit scan: input in the low nibble,
+     * captured output in the high nibble */
+    uint8_t high;
+    /* JTAG_TIMESTAMP() when the scan completed */
+    uint16_t timestamp;
+    /* The bits shifted in, or the new level of TCLK */
+    uint16_t input;
+    /* The bits captured from TDO */
+    uint16_t output;
+};
+
+typedef struct ScanRecord ScanRecord;
+
+#define SCAN_IR         (0)
+#define SCAN_DR         (1)
+#define SCAN_DR20       (2)
+#define SCAN_TCLK_SET   (3)
+#define SCAN_TCLK_CLR   (4)
+#define SCAN_PSA        (5)
+#define SCAN_START      (6)     // opens the log, input holds the TCLK level
+#define SCAN_RESET      (7)     // initFSM()
+
 void initFSM();
+void resumeFSM(bool tclk);
+bool getTCLK();
 uint8_t IR_SHIFT(uint8_t input_data);
 uint16_t DR_SHIFT(uint16_t input_data);
-inline void SetTCLK();
-inline void ClrTCLK();
+uint32_t DR_SHIFT20(uint32_t input_data);
+void ClockPSA();
 void releaseFSM();
 
+#ifdef JTAG_SCAN_COUNTS
+const ScanCounts *getScanCounts();
+void clrScanCounts();
+#endif
+
+/*
+ * With nothing to count or record, TCLK on the 4-wire link is a
+ * single write to TDI, so SetTCLK() and ClrTCLK() are expanded in
+ * place rather than called on the hot path of memory accesses.
+ */
+#if !defined(JTAG_SCAN_COUNTS) && !defined(JTAG_CAPTURE) && !defined(JTAG_SBW)
+#include "jtag_config.h"
+#define JTAG_INLINE_TCLK
+#define SetTCLK()   JTAG_HIGH(TDI)
+#define ClrTCLK()   JTAG_LOW(TDI)
+#else
+void SetTCLK();
+void ClrTCLK();
+#endif
+
+#ifdef JTAG_CAPTURE
+void startCapture();
+void stopCapture();
+const ScanRecord *getCapture();
+uint16_t getCaptureLength();
+bool isCaptureOverflowed();
+uint16_t replayCapture();
+#endif
+
+/***
+ * The JTAG ID shifted out on TDO by every IR_SHIFT once the
+ * target is under JTAG control (See pg.64 of interface reference).
+ */
+#define JTAG_ID (0x89)
+
+/***
+ * The JTAG ID of MSP430Xv2 targets such as the F5529, which
+ * have a 20-bit address bus and use their own control word
+ * values in the 20-bit access functions of jtag_control.h.
+ */
+#define JTAG_ID_XV2 (0x91)
+
 // JTAG Instructions: (pg. 14)
 
 /***
@@ -69,6 +159,14 @@ void releaseFSM();
  */
 #define IR_DATA_16BIT (0x41)
 
+/***
+ * This instruction captures the value on the MSP430 MDB with the
+ * next data access without driving it, so the CPU keeps control
+ * of the MDB. Together with an instruction that writes a register
+ * to memory this reads out the CPU registers.
+ */
+#define IR_DATA_CAPTURE (0x42)
+
 /***
  * This instruction enables setting of the MSP430 MDB to a specified
  * value shifted in with the next JTAG data access. The MSp430 MDB
@@ -137,6 +235,12 @@ void releaseFSM();
  */
 #define IR_SHIFT_OUT_PSA (0x46)
 
+/***
+ * The feedback polynomial of the PSA register, used to compute the
+ * expected signature of a block of memory on the debugger side.
+ */
+#define PSA_POLYNOMIAL (0x0805)
+
 /***
  * This instruction sets the MSP430 into program-fuse mode.
  */
@@ -154,5 +258,23 @@ void releaseFSM();
  */
 #define IR_JMB_EXCHANGE (0x61)
 
+/***
+ * This instruction gives access to the registers of the Embedded
+ * Emulation Module (EEM). The next DR_SHIFT selects a register and
+ * the direction of the access, the one after it carries the data.
+ */
+#define IR_EMEX_DATA_EXCHANGE (0x09)
+
+/***
+ * This instruction enables writing of the EEM control register.
+ */
+#define IR_EMEX_WRITE_CONTROL (0x0A)
+
+/***
+ * This instruction enables reading of the EEM control register,
+ * which reports whether a trigger has stopped the CPU.
+ */
+#define IR_EMEX_READ_CONTROL (0x0B)
+
 
 #endif /* JTAG_FSM_H_ */
@@ -0,0 +1,37 @@
+/*
+ * jtag_snapshot.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Snapshot Targets: MSP430G2553.
+ *
+ * Captures the CPU registers, RAM, information memory and flash of a
+ * halted target as text, so a field state can be archived and resumed
+ * in the host simulator of msp430Simulator. Peripheral registers are
+ * left out because reading some of them, such as UCA0RXBUF, clears
+ * interrupt flags.
+ *
+ * The snapshot is a series of lines, all numbers in hexadecimal:
+ *
+ *     SNAPSHOT <jtag id>
+ *     R<n> <value>                  one per register, R3 excluded
+ *     M<address> <word> ... <word>  SNAPSHOT_LINE_WORDS words each
+ *     END
+ */
+
+#ifndef INCLUDE_JTAG_SNAPSHOT_H_
+#define INCLUDE_JTAG_SNAPSHOT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "jtag_text.h"
+
+bool writeSnapshot(TextSink sink);
+
+/***
+ * Words of memory on each M line of a snapshot.
+ */
+#define SNAPSHOT_LINE_WORDS (8)
+
+#endif /* INCLUDE_JTAG_SNAPSHOT_H_ */
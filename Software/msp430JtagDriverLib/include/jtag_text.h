@@ -0,0 +1,22 @@
+/*
+ * jtag_text.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Text output shared by the snapshot, coverage, analyzer and VCD
+ * writers. Text is handed to a sink one string at a time, so
+ * waitPrint() can stream it over the backchannel.
+ */
+
+#ifndef INCLUDE_JTAG_TEXT_H_
+#define INCLUDE_JTAG_TEXT_H_
+
+#include <stdint.h>
+
+typedef void (*TextSink)(char *text);
+
+void writeHex(TextSink sink, uint16_t value, int digits);
+void writeNumber(TextSink sink, uint32_t value);
+
+#endif /* INCLUDE_JTAG_TEXT_H_ */
@@ -0,0 +1,57 @@
+/*
+ * jtag_vcd.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Writes Value Change Dump (VCD) waveforms, viewable in any
+ * waveform viewer such as GTKWave. The waveform is written to a
+ * text sink, see jtag_text.h.
+ *
+ * VCD Format Reference: IEEE 1364-2005, section 18.
+ */
+
+#ifndef INCLUDE_JTAG_VCD_H_
+#define INCLUDE_JTAG_VCD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "jtag_text.h"
+
+void vcdBegin(TextSink sink, char *scope, char *const *names,
+              const uint8_t *widths, uint8_t count);
+void vcdAdvance(uint32_t cycles);
+void vcdSet(uint8_t signal, bool level);
+void vcdSetBus(uint8_t signal, uint8_t width, uint16_t value);
+void vcdEnd();
+
+#ifdef JTAG_CAPTURE
+void writeCaptureVcd(TextSink sink);
+#endif
+
+/***
+ * The most signals a single waveform can hold.
+ */
+#define VCD_MAX_SIGNALS (16)
+
+// MCLK cycle model of the 4-wire bit banging in jtag_fsm.c,
+// estimated from the instruction timings of the shift loops.
+
+/***
+ * Cycles taken by one read-modify-write of JTAGOUT.
+ */
+#define VCD_EDGE_CYCLES (5)
+
+/***
+ * Cycles between TCK pulses while shifting a bit, covering the
+ * setLevel() call, the TDO sample and the loop overhead.
+ */
+#define VCD_BIT_CYCLES (24)
+
+/***
+ * Cycles between the end of one scan and the start of the next,
+ * covering the call and return of the scan functions.
+ */
+#define VCD_SCAN_GAP_CYCLES (40)
+
+#endif /* INCLUDE_JTAG_VCD_H_ */
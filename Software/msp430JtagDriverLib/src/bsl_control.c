@@ -0,0 +1,299 @@
+/*
+ * bsl_control.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "bsl_control.h"
+#include "jtag_config.h"
+
+#define BIT_DELAY (BSL_BIT_CYCLES - BSL_LOOP_CYCLES) // bit time less the loop overhead
+
+static uint16_t stamp;          // JTAG_TIMESTAMP() at the last byte
+static uint32_t elapsed;        // timestamp counts of the last bslReadBlock()
+static uint16_t bytes_read;     // bytes of the last bslReadBlock()
+
+/*
+ * Adds the time since the last byte to elapsed. Called once a
+ * byte, a few milliseconds, so the 16-bit timestamp never wraps
+ * between calls, where a whole block can take longer than the
+ * counter's period.
+ */
+static void timeByte() {
+    uint16_t now = JTAG_TIMESTAMP();
+
+    elapsed += (uint16_t) (now - stamp);
+    stamp = now;
+}
+
+/*
+ * Returns the even parity bit of data, ie 1 if data
+ * has an odd number of bits set.
+ */
+static uint16_t parityOf(uint8_t data) {
+    data ^= data >> 4;
+    data ^= data >> 2;
+    data ^= data >> 1;
+    return data & 1;
+}
+
+/*
+ * Transmits one byte to the target BSL as an 8E1 UART frame.
+ */
+static void bslSendByte(uint8_t data) {
+    // start bit, data LSB first, parity and stop bit
+    uint16_t frame = ((uint16_t) data << 1) | (parityOf(data) << 9) | BITA;
+    uint16_t interrupts;
+    int i;
+
+    JTAG_HOLD_INTERRUPTS(interrupts); // keep bit timing
+    for (i = 0; i < 11; i++) {
+        if (frame & 1) {
+            JTAG_HIGH(BSLOUT);
+        } else {
+            JTAG_LOW(BSLOUT);
+        }
+        frame >>= 1;
+        JTAG_DELAY_CYCLES(BIT_DELAY);
+    }
+    JTAG_RESTORE_INTERRUPTS(interrupts);
+    timeByte();
+}
+
+/*
+ * Receives one 8E1 UART frame from the target BSL.
+ *
+ * Returns: True if a well formed frame arrived before
+ *          BSL_TIMEOUT polls, false otherwise.
+ */
+static bool bslRecvByte(uint8_t *data) {
+    uint16_t polls = BSL_TIMEOUT;
+    uint16_t frame = 0;
+    uint16_t interrupts;
+    int i;
+
+    JTAG_HOLD_INTERRUPTS(interrupts); // keep bit timing
+    while (JTAG_READ(BSLIN)) {
+        if (--polls == 0) {
+            JTAG_RESTORE_INTERRUPTS(interrupts);
+            timeByte();
+            return false; // no start bit
+        }
+    }
+    JTAG_DELAY_CYCLES(BSL_BIT_CYCLES / 2); // sample mid bit
+    for (i = 0; i < 10; i++) {
+        JTAG_DELAY_CYCLES(BIT_DELAY);
+        if (JTAG_READ(BSLIN)) {
+            frame |= 1 << i;
+        }
+    }
+    JTAG_RESTORE_INTERRUPTS(interrupts);
+    timeByte();
+    *data = (uint8_t) frame;
+    // frame bit 8 is parity and bit 9 the stop bit
+    return (frame & BIT9) && parityOf(*data) == ((frame >> 8) & 1);
+}
+
+/*
+ * Sends the synchronization byte and waits for the BSL
+ * to acknowledge it, which is required before every frame.
+ */
+static bool bslSync() {
+    uint8_t reply;
+
+    bslSendByte(BSL_SYNC);
+    return bslRecvByte(&reply) && reply == BSL_ACK;
+}
+
+/*
+ * Sends a complete BSL frame: header, command, length,
+ * address and block length fields, data and checksum.
+ *
+ * cmd: The BSL command.
+ * address: The address field of the command.
+ * length: The block length field of the command.
+ * data: The data bytes of the frame, or NULL if num_data is 0.
+ * num_data: The number of data bytes in the frame.
+ */
+static void bslSendFrame(uint8_t cmd, uint16_t address, uint16_t length,
+                         const uint8_t *data, uint8_t num_data) {
+    uint8_t header[8];
+    uint8_t checksum[2] = {0, 0};
+    uint16_t i;
+
+    header[0] = BSL_SYNC;
+    header[1] = cmd;
+    header[2] = num_data + 4;
+    header[3] = num_data + 4;
+    header[4] = (uint8_t) address;
+    header[5] = (uint8_t) (address >> 8);
+    header[6] = (uint8_t) length;
+    header[7] = (uint8_t) (length >> 8);
+    for (i = 0; i < 8; i++) {
+        checksum[i & 1] ^= header[i];
+        bslSendByte(header[i]);
+    }
+    for (i = 0; i < num_data; i++) {
+        checksum[i & 1] ^= data[i]; // header length is even
+        bslSendByte(data[i]);
+    }
+    bslSendByte(~checksum[0]);
+    bslSendByte(~checksum[1]);
+}
+
+/*
+ * Starts the target ROM BSL using the TEST and RST entry
+ * sequence: two TEST pulses while RST is held low, then RST
+ * released while TEST is high. The target leaves JTAG control,
+ * which must be reentered through initFSM() after bslExit().
+ *
+ * Returns: True if the BSL answered the first sync.
+ */
+bool bslEnter() {
+    JTAG_LOW(TEST);
+    JTAG_LOW(RST);
+    JTAG_HIGH(BSLOUT); // UART idles high
+    JTAG_CLAIM_BSL_PINS();
+    JTAG_DELAY_CYCLES(1000);
+
+    JTAG_HIGH(TEST);
+    JTAG_DELAY_CYCLES(100);
+    JTAG_LOW(TEST);
+    JTAG_DELAY_CYCLES(100);
+    JTAG_HIGH(TEST);
+    JTAG_DELAY_CYCLES(100);
+    JTAG_HIGH(RST); // BSL starts on this rising edge
+    JTAG_DELAY_CYCLES(100);
+    JTAG_LOW(TEST);
+    JTAG_DELAY_CYCLES(10000); // let the BSL initialize
+
+    return bslSync();
+}
+
+/*
+ * Resets the target out of the BSL so that it runs its
+ * application again.
+ */
+void bslExit() {
+    JTAG_LOW(TEST);
+    JTAG_LOW(RST);
+    JTAG_DELAY_CYCLES(1000);
+    JTAG_HIGH(RST);
+}
+
+/*
+ * Unlocks the BSL, which is required before memory can be
+ * read. The password is the target's interrupt vector table,
+ * and may be read over JTAG beforehand from 0xFFE0.
+ *
+ * password: BSL_PASSWORD_WORDS words of the vector table.
+ *
+ * Returns: True if the BSL accepted the password.
+ */
+bool bslUnlock(const uint16_t *password) {
+    uint8_t bytes[2 * BSL_PASSWORD_WORDS];
+    uint8_t reply;
+    int i;
+
+    for (i = 0; i < BSL_PASSWORD_WORDS; i++) {
+        bytes[2 * i] = (uint8_t) password[i];
+        bytes[2 * i + 1] = (uint8_t) (password[i] >> 8);
+    }
+    if (!bslSync()) {
+        return false;
+    }
+    bslSendFrame(BSL_RX_PASSWORD, 0xFFE0, sizeof(bytes), bytes, sizeof(bytes));
+    return bslRecvByte(&reply) && reply == BSL_ACK;
+}
+
+/*
+ * Reads length words beginning at address into buffer through
+ * TX data block commands of up to BSL_MAX_BLOCK bytes. The BSL
+ * must have been unlocked with bslUnlock().
+ *
+ * Returns: True if every block arrived with a valid checksum,
+ *          false otherwise, in which case buffer is partially
+ *          filled.
+ */
+bool bslReadBlock(uint16_t address, uint16_t *buffer, uint16_t length) {
+    uint8_t checksum[2];
+    uint8_t byte, num_bytes;
+    uint16_t i;
+
+    stamp = JTAG_TIMESTAMP();
+    elapsed = 0;
+    bytes_read = 0;
+    while (length > 0) {
+        num_bytes = (length > BSL_MAX_BLOCK / 2) ? BSL_MAX_BLOCK : length * 2;
+        if (!bslSync()) {
+            return false;
+        }
+        bslSendFrame(BSL_TX_BLOCK, address, num_bytes, NULL, 0);
+
+        // reply: header, 0x00, length twice, data and checksum
+        checksum[0] = 0;
+        checksum[1] = 0;
+        for (i = 0; i < num_bytes + 6; i++) {
+            if (!bslRecvByte(&byte)) {
+                return false;
+            }
+            checksum[i & 1] ^= byte;
+            if (i >= 4 && i < num_bytes + 4) {
+                if (i & 1) {
+                    *buffer++ |= (uint16_t) byte << 8;
+                } else {
+                    *buffer = byte;
+                }
+            }
+        }
+        // data xor its inverted checksum leaves all bits set
+        if (checksum[0] != 0xFF || checksum[1] != 0xFF) {
+            return false;
+        }
+        address += num_bytes;
+        length -= num_bytes / 2;
+        bytes_read += num_bytes;
+    }
+    return true;
+}
+
+/*
+ * Reads one word of target memory through the BSL. This has
+ * the same signature as readMem() so either transport can be
+ * handed to code that reads memory through a function pointer.
+ *
+ * Returns: The word at address, or 0xFFFF (erased flash) if the
+ *          BSL did not answer.
+ */
+uint16_t bslReadMem(uint16_t address) {
+    uint16_t data;
+
+    if (!bslReadBlock(address, &data, 1)) {
+        return 0xFFFF;
+    }
+    return data;
+}
+
+/*
+ * Returns the throughput of the last bslReadBlock() in bytes per
+ * second, timed with JTAG_TIMESTAMP() over the syncs, requests and
+ * replies of the blocks it received intact. Each byte takes 11 bit times
+ * and every block carries 18 bytes of framing, so full blocks at
+ * 9600 baud cannot pass 814 bytes per second. Time the same read
+ * through readMem() or readMemQuick() to compare the transports.
+ *
+ * Returns: Bytes per second, or 0 if nothing was read.
+ */
+uint16_t bslBytesPerSecond() {
+    uint32_t us_per_byte;
+
+    if (bytes_read == 0) {
+        return 0;
+    }
+    // microseconds per byte first, bytes times 10^6 overflows 32 bits
+    us_per_byte = elapsed * JTAG_TIMESTAMP_US / bytes_read;
+    return (us_per_byte == 0) ? 0xFFFF : (uint16_t) (1000000UL / us_per_byte);
+}
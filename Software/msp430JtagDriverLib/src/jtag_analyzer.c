@@ -0,0 +1,144 @@
+/*
+ * jtag_analyzer.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "jtag_analyzer.h"
+#include "jtag_control.h"
+#include "jtag_fsm.h"
+#include "jtag_config.h"
+
+static AnalyzerEvent analyzer_log[ANALYZER_DEPTH];
+static uint16_t analyzer_length;
+static uint32_t analyzer_elapsed;   // JTAG_TIMESTAMP() counts of the last run
+static const AnalyzerChannel *analyzer_channels;
+static uint8_t analyzer_count;
+
+/*
+ * Samples count channels the given number of times, clocking the
+ * target CPU for cycles TCLK cycles between samples. Logging stops
+ * early once ANALYZER_DEPTH changes have been seen, or when the
+ * target stops fetching instructions between samples. The target
+ * must be halted through haltCPU(), and is halted again when this
+ * returns unless it stopped fetching.
+ *
+ * Returns: The number of samples taken.
+ */
+uint16_t runAnalyzer(const AnalyzerChannel *channels, uint8_t count,
+                     uint16_t samples, uint16_t cycles) {
+    uint8_t last[ANALYZER_CHANNELS];
+    uint16_t sample, stamp, prev_stamp, i;
+    uint32_t now;
+    uint8_t channel, value;
+
+    if (count > ANALYZER_CHANNELS) {
+        count = ANALYZER_CHANNELS;
+    }
+    analyzer_channels = channels;
+    analyzer_count = count;
+    analyzer_length = 0;
+
+    now = 0;
+    prev_stamp = JTAG_TIMESTAMP();
+    for (sample = 0; sample < samples; sample++) {
+        // a sample takes far less than a wrap of the counter
+        stamp = JTAG_TIMESTAMP();
+        now += (uint16_t) (stamp - prev_stamp);
+        prev_stamp = stamp;
+        for (channel = 0; channel < count; channel++) {
+            value = readMemByte(channels[channel].address);
+            if (sample != 0 && value == last[channel]) {
+                continue;
+            }
+            last[channel] = value;
+            if (analyzer_length == ANALYZER_DEPTH) {
+                break;
+            }
+            analyzer_log[analyzer_length].time = now;
+            analyzer_log[analyzer_length].sample = sample;
+            analyzer_log[analyzer_length].channel = channel;
+            analyzer_log[analyzer_length].value = value;
+            analyzer_length++;
+        }
+        if (analyzer_length == ANALYZER_DEPTH) {
+            break;
+        }
+
+        // let the target run until the next sample
+        if (cycles != 0) {
+            releaseCPU();
+            for (i = 0; i < cycles; i++) {
+                ClrTCLK();
+                SetTCLK();
+            }
+            if (!setInstrFetch()) {
+                sample++; // the target stopped fetching, eg in LPM
+                break;
+            }
+            haltCPU();
+        }
+    }
+    analyzer_elapsed = now + (uint16_t) (JTAG_TIMESTAMP() - prev_stamp);
+    return sample;
+}
+
+/*
+ * Returns: The changes logged by the last run.
+ */
+const AnalyzerEvent *getAnalyzerEvents() {
+    return analyzer_log;
+}
+
+/*
+ * Returns: The number of changes logged by the last run.
+ */
+uint16_t getAnalyzerLength() {
+    return analyzer_length;
+}
+
+/*
+ * Returns: The JTAG_TIMESTAMP() counts taken by the last run,
+ *          which over the samples taken gives the sample rate.
+ */
+uint32_t getAnalyzerElapsed() {
+    return analyzer_elapsed;
+}
+
+/*
+ * Streams the changes logged by the last run in the compact format
+ * described in jtag_analyzer.h, which analyzervcd of
+ * msp430JtagHostTest turns into a waveform on the host.
+ */
+void writeAnalyzerLog(TextSink sink) {
+    const AnalyzerEvent *event;
+    uint32_t time = 0;
+    uint8_t i;
+
+    sink("ANALYZER ");
+    writeNumber(sink, analyzer_count);
+    sink(" ");
+    writeNumber(sink, JTAG_TIMESTAMP_US);
+    sink("\n");
+    for (i = 0; i < analyzer_count; i++) {
+        sink("C");
+        sink(analyzer_channels[i].name);
+        sink("\n");
+    }
+    for (event = analyzer_log; event < analyzer_log + analyzer_length; event++) {
+        sink("V");
+        writeNumber(sink, event->time - time);
+        sink(" ");
+        writeNumber(sink, event->channel);
+        sink(" ");
+        writeNumber(sink, event->value);
+        sink("\n");
+        time = event->time;
+    }
+    sink("END ");
+    writeNumber(sink, analyzer_elapsed - time);
+    sink("\n");
+}
@@ -0,0 +1,41 @@
+/*
+ * jtag_capture.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "jtag_capture.h"
+#include "jtag_fsm.h"
+#include "jtag_control.h"
+
+#ifdef JTAG_CAPTURE
+/*
+ * Writes the capture log to the sink in the format described in
+ * jtag_capture.h. The JTAG ID is the one getDevice() last read,
+ * which tells the replay whether to model an MSP430Xv2 target.
+ */
+void writeCapture(TextSink sink) {
+    const ScanRecord *record = getCapture();
+    uint16_t i, length = getCaptureLength();
+
+    sink("CAPTURE ");
+    writeHex(sink, getJtagId(), 2);
+    sink(isCaptureOverflowed() ? " 1\n" : " 0\n");
+    for (i = 0; i < length; i++, record++) {
+        sink("S");
+        writeHex(sink, record->type, 1);
+        sink(" ");
+        writeHex(sink, record->high, 2);
+        sink(" ");
+        writeHex(sink, record->input, 4);
+        sink(" ");
+        writeHex(sink, record->output, 4);
+        sink(" ");
+        writeHex(sink, record->timestamp, 4);
+        sink("\n");
+    }
+    sink("END\n");
+}
+#endif
@@ -0,0 +1,111 @@
+/*
+ * jtag_checkpoint.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ */
+#include <msp430.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "jtag_checkpoint.h"
+#include "jtag_control.h"
+
+/*
+ * Saves the registers and RAM of the target into the store. The
+ * target must be halted through haltCPU(), and is halted again at
+ * the same PC when this returns.
+ *
+ * Returns: False if the target could not be set to the
+ *          instruction-fetch state, in which case the checkpoint
+ *          in the store is incomplete.
+ */
+bool checkpoint(const CheckpointStore *store) {
+    uint16_t regs[CHECKPOINT_REGS];
+    uint16_t chunk[CHECKPOINT_CHUNK_WORDS];
+    uint16_t offset, count;
+    uint8_t reg;
+
+    if (!setInstrFetch()) {
+        return false;
+    }
+    for (reg = 0; reg < 16; reg++) {
+        if (reg != 3) {
+            regs[reg] = readReg(reg);
+        }
+    }
+    regs[3] = 0;
+    store->save(0, regs, CHECKPOINT_REGS);
+
+    for (offset = 0; offset < CHECKPOINT_RAM_WORDS; offset += count) {
+        count = CHECKPOINT_RAM_WORDS - offset;
+        if (count > CHECKPOINT_CHUNK_WORDS) {
+            count = CHECKPOINT_CHUNK_WORDS;
+        }
+        // readMemQuick() releases the CPU and moves the PC
+        if (!setInstrFetch()) {
+            return false;
+        }
+        haltCPU();
+        readMemQuick(CHECKPOINT_RAM_START + 2 * offset, chunk, count);
+        store->save(CHECKPOINT_REGS + offset, chunk, count);
+    }
+
+    if (!setInstrFetch()) {
+        return false;
+    }
+    setPC(regs[0]);
+    haltCPU();
+    return true;
+}
+
+/*
+ * Writes a checkpoint taken by checkpoint() back to the target.
+ * RAM is written first with burst writes, then the PC, then the
+ * other registers with SR last, so that a saved low-power mode
+ * only takes effect once everything else is in place. The target
+ * must be halted through haltCPU(), and is halted again when this
+ * returns.
+ *
+ * Returns: False if the target could not be set to the
+ *          instruction-fetch state, in which case only part of
+ *          the checkpoint was written.
+ */
+bool restore(const CheckpointStore *store) {
+    uint16_t regs[CHECKPOINT_REGS];
+    uint16_t chunk[CHECKPOINT_CHUNK_WORDS];
+    uint16_t offset, count;
+    uint8_t reg;
+
+    for (offset = 0; offset < CHECKPOINT_RAM_WORDS; offset += count) {
+        count = CHECKPOINT_RAM_WORDS - offset;
+        if (count > CHECKPOINT_CHUNK_WORDS) {
+            count = CHECKPOINT_CHUNK_WORDS;
+        }
+        store->load(CHECKPOINT_REGS + offset, chunk, count);
+        // writeMemQuick() releases the CPU and moves the PC
+        if (!setInstrFetch()) {
+            return false;
+        }
+        haltCPU();
+        writeMemQuick(CHECKPOINT_RAM_START + 2 * offset, chunk, count);
+    }
+
+    store->load(0, regs, CHECKPOINT_REGS);
+    if (!setInstrFetch()) {
+        return false;
+    }
+    setPC(regs[0]);
+    haltCPU();
+    for (reg = 1; reg < 16; reg++) {
+        if (reg != 2 && reg != 3) {
+            writeReg(reg, regs[reg]);
+        }
+    }
+    writeReg(2, regs[2]);
+    if (!setInstrFetch()) {
+        return false;
+    }
+    haltCPU();
+    return true;
+}
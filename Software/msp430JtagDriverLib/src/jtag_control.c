@@ -4,53 +4,204 @@
  *  Created on: May 31, 2024
  *      Author: bapti
  */
-#include <msp430.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include "jtag_control.h"
 #include "jtag_fsm.h"
+#include "jtag_config.h"
+
+static SyncStats sync_stats;
+static uint8_t target_id;
+
+/*
+ * Busy waits for the given number of loop iterations. Used to
+ * back off between sync attempts so a target that is still
+ * powering up has time to settle.
+ */
+static void backoff(uint16_t loops) {
+    volatile uint16_t counter = loops;
+    while (counter != 0) {
+        counter--;
+    }
+}
+
+/*
+ * Requests JTAG control of the target CPU and polls TCE until
+ * the target reports sync, at most SYNC_POLLS times.
+ *
+ * Returns: The number of polls needed to sync, or 0 if the
+ *          target never synced or did not answer with its
+ *          JTAG ID.
+ */
+static uint16_t syncTarget() {
+    uint16_t polls;
+
+    target_id = IR_SHIFT(IR_CNTRL_SIG_16BIT);
+    if (target_id == JTAG_ID) {
+        DR_SHIFT(0x2401);
+    } else if (target_id == JTAG_ID_XV2) {
+        DR_SHIFT(0x1501);
+    } else {
+        return 0; // nothing is answering on the JTAG port
+    }
+    IR_SHIFT(IR_CNTRL_SIG_CAPTURE);
+    for (polls = 1; polls <= SYNC_POLLS; polls++) {
+        if (DR_SHIFT(0) & BIT9) {
+            return polls;
+        }
+    }
+    return 0;
+}
 
 /*
  * Takes the target CPU under JTAG control by setting TCE1 of
  * the JTAG control register to 1. Checks TCE to test if sync
- * with JTAG control was successful.
+ * with JTAG control was successful. A failed attempt is retried
+ * up to SYNC_RETRIES times, rerunning the JTAG entry sequence
+ * through initFSM() with an increasing delay before each retry.
+ *
+ * Return: True if the target CPU synced with JTAG control,
+ *         false if every attempt failed.
  */
-void getDevice() {
-    IR_SHIFT(IR_CNTRL_SIG_16BIT);
-    DR_SHIFT(0x2401);
+bool getDevice() {
+    uint16_t polls, delay_loops;
+    int attempt;
+
+    sync_stats.last_start = JTAG_TIMESTAMP();
+    delay_loops = SYNC_BACKOFF;
+    for (attempt = 0; attempt <= SYNC_RETRIES; attempt++) {
+        if (attempt > 0) {
+            backoff(delay_loops);
+            delay_loops <<= 1;
+            initFSM(); // re-enter JTAG from scratch
+            sync_stats.reentries++;
+        }
+        polls = syncTarget();
+        if (polls != 0) {
+            sync_stats.syncs++;
+            sync_stats.last_polls = polls;
+            if (polls > sync_stats.max_polls) {
+                sync_stats.max_polls = polls;
+            }
+            sync_stats.last_end = JTAG_TIMESTAMP();
+            return true;
+        }
+    }
+    sync_stats.failures++;
+    sync_stats.last_end = JTAG_TIMESTAMP();
+    return false;
+}
+
+/*
+ * Checks that a target left halted under JTAG control is still
+ * synced, so that a debugger which was reset can pick up its
+ * session after resumeFSM() instead of running initFSM() and
+ * getDevice() again. Only the 16-bit control signal register
+ * layout is checked, so Xv2 targets always report false.
+ *
+ * Return: True if the target answered with its JTAG ID and both
+ *         TCE and HALT_JTAG are still set.
+ */
+bool resumeDevice() {
+    uint16_t control;
+
+    target_id = IR_SHIFT(IR_CNTRL_SIG_CAPTURE);
+    if (target_id != JTAG_ID) {
+        return false;
+    }
+    control = DR_SHIFT(0);
+    return (control & BIT9) && (control & BIT3);
+}
+
+/*
+ * Clocks TCLK until the target CPU reaches the instruction-fetch
+ * state, at most the given number of cycles. Nothing is counted
+ * in the sync telemetry, so callers for which a target that stops
+ * fetching is expected, eg one entering a low-power mode, can test
+ * for it without it showing up as a fetch failure. The INSTR_LOAD
+ * flag is BIT7 of the captured control signal register on both the
+ * 1xx/2xx and the Xv2 layout, so the same check serves both kinds
+ * of target.
+ *
+ * Return: True if the target CPU is in the instruction-fetch state.
+ */
+bool waitInstrFetch(uint16_t tries) {
+    uint16_t i;
+
     IR_SHIFT(IR_CNTRL_SIG_CAPTURE);
-    while (!(DR_SHIFT(0) & BIT9)) {} // wait for sync
+    for (i = 0; i < tries; i++) {
+        if (DR_SHIFT(0) & BIT7) {
+            return true;
+        }
+        ClrTCLK();
+        SetTCLK();
+    }
+    return false;
 }
 
 /*
  * Sets the target CPU to the instruction-fetch state. In this
  * state the target CPU loads and executes an instruction as
  * it would in normal operation, except that the instruction is
- * transmitted through JTAG.
+ * transmitted through JTAG. The target is given FETCH_TRIES
+ * TCLK cycles to reach the state. It is not resynced on a
+ * failure, since getDevice() may reset it through initFSM(),
+ * so the caller decides whether to give up or start over.
  *
- * Return: 0 if the target CPU was successfully set to
+ * Return: True if the target CPU was successfully set to
  *         the instruction-fetch state.
- *         1 if a JTAG access error has occurred and a JTAG
+ *         False if a JTAG access error has occurred and a JTAG
  *         reset is recommended.
  */
 bool setInstrFetch() {
-    IR_SHIFT(IR_CNTRL_SIG_CAPTURE);
-    int i;
-    for (i = 0; i < 8; i++) {
-        if (!(DR_SHIFT(0) & BIT7)) {
-            return true;
-        }
-        ClrTCLK();
-        SetTCLK();
+    if (waitInstrFetch(FETCH_TRIES)) {
+        return true;
     }
+    sync_stats.fetch_failures++;
     return false;
 }
 
+/*
+ * Returns the JTAG ID reported by the target during the most
+ * recent sync attempt, JTAG_ID_XV2 for targets that need the
+ * 20-bit access functions.
+ */
+uint8_t getJtagId() {
+    return target_id;
+}
+
+/*
+ * Returns the sync telemetry collected since the last call
+ * to clrSyncStats().
+ */
+const SyncStats *getSyncStats() {
+    return &sync_stats;
+}
+
+/*
+ * Resets all sync telemetry counters and timestamps.
+ */
+void clrSyncStats() {
+    sync_stats.syncs = 0;
+    sync_stats.failures = 0;
+    sync_stats.reentries = 0;
+    sync_stats.fetch_failures = 0;
+    sync_stats.last_polls = 0;
+    sync_stats.max_polls = 0;
+    sync_stats.last_start = 0;
+    sync_stats.last_end = 0;
+}
+
 /*
  * Sets the target CPU program counter to the address provided.
+ * On an Xv2 target this is done through setPC20().
  */
 void setPC(uint16_t address) {
+    if (target_id == JTAG_ID_XV2) {
+        setPC20(address);
+        return;
+    }
     IR_SHIFT(IR_CNTRL_SIG_16BIT);
     DR_SHIFT(0x3401); // release low byte
     IR_SHIFT(IR_DATA_16BIT);
@@ -69,9 +220,24 @@ void setPC(uint16_t address) {
 /*
  * Sets the target CPU to a defined halt state. This is used to
  * access memory locations before the CPU is returned to normal
- * operation via releaseCPU().
+ * operation via releaseCPU(). The Xv2 control signal register
+ * has no HALT_JTAG bit, so there the JMP $ alone holds the CPU
+ * while JTAG takes over the RW line, as in the full-emulation
+ * state of the interface reference.
  */
 void haltCPU() {
+    if (target_id == JTAG_ID_XV2) {
+        ClrTCLK();
+        IR_SHIFT(IR_DATA_16BIT);
+        SetTCLK();
+        DR_SHIFT(0x3FFF); // JMP $
+        ClrTCLK();
+        IR_SHIFT(IR_CNTRL_SIG_16BIT);
+        DR_SHIFT(0x0501); // JTAG controls RW
+        IR_SHIFT(IR_ADDR_CAPTURE);
+        SetTCLK();
+        return;
+    }
     IR_SHIFT(IR_DATA_16BIT);
     DR_SHIFT(0x3FFF); // JMP $ instruction to keep
                       // CPU from changing state
@@ -88,11 +254,44 @@ void haltCPU() {
 void releaseCPU() {
     ClrTCLK();
     IR_SHIFT(IR_CNTRL_SIG_16BIT);
-    DR_SHIFT(0x2401); // clear HALT_JTAG bit
+    if (target_id == JTAG_ID_XV2) {
+        DR_SHIFT(0x0401); // CPU controls RW again
+    } else {
+        DR_SHIFT(0x2401); // clear HALT_JTAG bit
+    }
     IR_SHIFT(IR_ADDR_CAPTURE);
     SetTCLK();
 }
 
+/*
+ * Lets the target CPU run at full speed from its current PC.
+ * Unlike releaseDevice() the target is not reset, and unlike
+ * releaseCPU() the CPU is no longer clocked by TCLK. The target
+ * can be taken back under JTAG control with getDevice() and
+ * haltCPU(), eg once an EEM watchpoint has stopped it.
+ *
+ * Return: True if the target is running, false if it could not
+ *         be set to the instruction-fetch state and is left halted.
+ */
+bool runCPU() {
+    uint16_t pc;
+
+    if (!setInstrFetch()) {
+        return false;
+    }
+    pc = readReg(0);
+    if (!setInstrFetch()) {
+        return false;
+    }
+    setPC(pc);
+    SetTCLK();
+    IR_SHIFT(IR_CNTRL_SIG_16BIT);
+    DR_SHIFT(0x0401); // clear TCE1, CPU clocked from MCLK
+    IR_SHIFT(IR_ADDR_CAPTURE);
+    IR_SHIFT(IR_CNTRL_SIG_RELEASE);
+    return true;
+}
+
 /*
  * Force a power-up reset of the target. This may be necessary
  * while the target is under JTAG control, such as before
@@ -129,9 +328,13 @@ void releaseDevice() {
  * to a halt state through haltCPU() before memory accesses
  * can begin. When memory accesses are complete,
  * releaseCPU() should be called to return the target CPU
- * to normal operation.
+ * to normal operation. On an Xv2 target this is done through
+ * readMem20().
  */
 uint16_t readMem(uint16_t address) {
+    if (target_id == JTAG_ID_XV2) {
+        return readMem20(address);
+    }
     ClrTCLK();
     IR_SHIFT(IR_CNTRL_SIG_16BIT);
     DR_SHIFT(0x2409); // read one word from memory. To read
@@ -145,15 +348,42 @@ uint16_t readMem(uint16_t address) {
     return output;
 }
 
+/*
+ * Reads a byte from any memory address location of the target,
+ * odd addresses included, as readMem() does for words. Byte
+ * peripherals such as the port registers must be read this way,
+ * since a word access at an odd address leaves half of the word
+ * undefined. The target must be halted through haltCPU().
+ */
+uint8_t readMemByte(uint16_t address) {
+    uint16_t output;
+
+    ClrTCLK();
+    IR_SHIFT(IR_CNTRL_SIG_16BIT);
+    DR_SHIFT(0x2419); // read one byte from memory
+    IR_SHIFT(IR_ADDR_16BIT);
+    DR_SHIFT(address);
+    IR_SHIFT(IR_DATA_TO_ADDR);
+    SetTCLK();
+    ClrTCLK();
+    output = DR_SHIFT(0);
+    return (uint8_t) output; // the byte is delivered in the low half
+}
+
 /*
  * Writes to a memory location in peripherals or to RAM (but
  * not to flash or FRAM) of the target. The target CPU must
  * be set to a halt state through haltCPU() before memory
  * manipulation can begin. When memory manipulation is
  * complete, releaseCPU() should be called to return the
- * target CPU to normal operation.
+ * target CPU to normal operation. On an Xv2 target this is
+ * done through writeMem20().
  */
 void writeMem(uint16_t address, uint16_t data) {
+    if (target_id == JTAG_ID_XV2) {
+        writeMem20(address, data);
+        return;
+    }
     ClrTCLK();
     IR_SHIFT(IR_CNTRL_SIG_16BIT);
     DR_SHIFT(0x2408); // write one word to memory. For a
@@ -165,4 +395,276 @@ void writeMem(uint16_t address, uint16_t data) {
     SetTCLK();
 }
 
+/*
+ * Reads a CPU register of the target by injecting a MOV Rn,&0x01FE
+ * instruction and capturing the value it puts on the MDB. A JMP $-4
+ * is injected first so that the PC is back where it started once
+ * the MOV has executed. Reading R0 returns the PC. The target is
+ * left in the instruction-fetch state with HALT_JTAG cleared, so
+ * haltCPU() must be called again before memory accesses. Nothing
+ * is injected if the instruction-fetch state cannot be reached,
+ * callers that must tell this apart from a register holding 0
+ * should call setInstrFetch() first.
+ */
+uint16_t readReg(uint8_t reg) {
+    uint16_t value;
+
+    if (!setInstrFetch()) {
+        return 0;
+    }
+    IR_SHIFT(IR_CNTRL_SIG_16BIT);
+    DR_SHIFT(0x3401); // CPU controls RW and BYTE
+    IR_SHIFT(IR_DATA_16BIT);
+    DR_SHIFT(0x3FFD); // JMP $-4, takes two TCLK cycles
+    ClrTCLK();
+    SetTCLK();
+    DR_SHIFT(0x4082 | ((uint16_t) (reg & 0x0F) << 8)); // MOV Rn,&0x01FE
+    ClrTCLK();
+    SetTCLK();
+    DR_SHIFT(0x01FE);
+    ClrTCLK();
+    SetTCLK();
+    IR_SHIFT(IR_DATA_CAPTURE);
+    SetTCLK();
+    value = DR_SHIFT(0); // Rn as written to 0x01FE
+    ClrTCLK();
+    IR_SHIFT(IR_CNTRL_SIG_16BIT);
+    DR_SHIFT(0x2401); // JTAG controls RW and BYTE
+    SetTCLK();
+    return value;
+}
 
+/*
+ * Writes a CPU register of the target by injecting a MOV #value,Rn
+ * instruction, preceded by a JMP $-4 as in readReg() so the PC is
+ * left unchanged. Use setPC() to write R0. The target is left in
+ * the same state as after readReg(), and as there nothing is
+ * injected if the instruction-fetch state cannot be reached.
+ */
+void writeReg(uint8_t reg, uint16_t value) {
+    if (!setInstrFetch()) {
+        return;
+    }
+    IR_SHIFT(IR_CNTRL_SIG_16BIT);
+    DR_SHIFT(0x3401); // CPU controls RW and BYTE
+    IR_SHIFT(IR_DATA_16BIT);
+    DR_SHIFT(0x3FFD); // JMP $-4, takes two TCLK cycles
+    ClrTCLK();
+    SetTCLK();
+    DR_SHIFT(0x4030 | (reg & 0x0F)); // MOV #value,Rn
+    ClrTCLK();
+    SetTCLK();
+    DR_SHIFT(value);
+    ClrTCLK();
+    SetTCLK();
+    ClrTCLK();
+    IR_SHIFT(IR_CNTRL_SIG_16BIT);
+    DR_SHIFT(0x2401); // JTAG controls RW and BYTE
+    SetTCLK();
+}
+
+/*
+ * Burst reads length consecutive words beginning at address into
+ * buffer. The PC is pointed just before address and auto-incremented
+ * by IR_DATA_QUICK, so each word costs a single DR_SHIFT instead of
+ * the five scans of readMem(). The target must be halted and its PC
+ * is left past the last word read, so save it with readReg() first
+ * if the target is to be resumed. As in ReadMemQuick of the interface
+ * reference the CPU is released afterwards, so setInstrFetch() and
+ * haltCPU() are needed before the next access.
+ */
+void readMemQuick(uint16_t address, uint16_t *buffer, uint16_t length) {
+    uint16_t i;
+
+    setPC(address - 4);
+    haltCPU();
+    ClrTCLK();
+    IR_SHIFT(IR_CNTRL_SIG_16BIT);
+    DR_SHIFT(0x2409); // read memory
+    IR_SHIFT(IR_DATA_QUICK);
+    for (i = 0; i < length; i++) {
+        SetTCLK();
+        ClrTCLK();
+        buffer[i] = DR_SHIFT(0);
+    }
+    SetTCLK();
+    releaseCPU();
+}
+
+/*
+ * Burst writes length words from buffer to consecutive RAM or
+ * peripheral addresses beginning at address, the counterpart of
+ * readMemQuick(). As with writeMem(), flash cannot be written
+ * this way, the PC is left past the last word written and the CPU
+ * is released as by readMemQuick().
+ */
+void writeMemQuick(uint16_t address, const uint16_t *buffer, uint16_t length) {
+    uint16_t i;
+
+    setPC(address - 4);
+    haltCPU();
+    ClrTCLK();
+    IR_SHIFT(IR_CNTRL_SIG_16BIT);
+    DR_SHIFT(0x2408); // write memory
+    IR_SHIFT(IR_DATA_QUICK);
+    for (i = 0; i < length; i++) {
+        DR_SHIFT(buffer[i]);
+        SetTCLK();
+        ClrTCLK();
+    }
+    SetTCLK();
+    releaseCPU();
+}
+
+/*
+ * Runs length words of memory beginning at address through the PSA
+ * register of the target, following VerifyPSA of the interface
+ * reference: the PC is loaded with address - 2, then every word
+ * takes a TCLK cycle with a pass of the TAP through the DR path,
+ * and a single scan shifts the signature out. A large range can so
+ * be checked against a copy without reading it back. Compare
+ * against calcPSA() over the expected words. The target must be
+ * halted. Its PC is left past the last word, so setInstrFetch()
+ * and haltCPU() are needed before further memory accesses.
+ *
+ * Return: True with the signature of the memory range in psa,
+ *         false if the target could not be set to the
+ *         instruction-fetch state.
+ */
+bool getPSA(uint16_t address, uint16_t length, uint16_t *psa) {
+    uint16_t i;
+
+    if (!setInstrFetch()) {
+        return false;
+    }
+    setPC(address - 2);
+    SetTCLK();
+    ClrTCLK();
+    IR_SHIFT(IR_DATA_PSA);
+    for (i = 0; i < length; i++) {
+        ClockPSA();
+    }
+    IR_SHIFT(IR_SHIFT_OUT_PSA);
+    *psa = DR_SHIFT(0);
+    SetTCLK();
+    return true;
+}
+
+/*
+ * Computes the signature getPSA() returns for length words of
+ * memory beginning at address, given their expected contents.
+ *
+ * Return: The PSA signature of buffer.
+ */
+uint16_t calcPSA(uint16_t address, const uint16_t *buffer, uint16_t length) {
+    uint16_t i, psa;
+
+    psa = address - 2; // the PSA register is seeded from the MAB
+    for (i = 0; i < length; i++) {
+        if (psa & 0x8000) {
+            psa ^= PSA_POLYNOMIAL;
+            psa <<= 1;
+            psa |= 1;
+        } else {
+            psa <<= 1;
+        }
+        psa ^= buffer[i];
+    }
+    return psa;
+}
+
+/*
+ * Sets the program counter of an MSP430Xv2 target CPU to a
+ * 20-bit address by injecting a MOVA #imm20, PC instruction.
+ */
+void setPC20(uint32_t address) {
+    uint16_t mova = 0x0080 | (uint16_t) ((address >> 8) & 0x0F00);
+
+    ClrTCLK();
+    IR_SHIFT(IR_DATA_16BIT);
+    SetTCLK();
+    DR_SHIFT(mova); // MOVA #imm20, PC with address bits 19-16
+    ClrTCLK();
+    IR_SHIFT(IR_CNTRL_SIG_16BIT);
+    DR_SHIFT(0x1400); // release low byte
+    IR_SHIFT(IR_DATA_16BIT);
+    ClrTCLK();
+    SetTCLK();
+    DR_SHIFT((uint16_t) address); // address bits 15-0
+    ClrTCLK();
+    SetTCLK();
+    DR_SHIFT(0x4303); // NOP while the PC is loaded
+    ClrTCLK();
+    IR_SHIFT(IR_ADDR_CAPTURE);
+    DR_SHIFT20(0);
+}
+
+/*
+ * Reads a word from any 20-bit address of an MSP430Xv2 target,
+ * reaching memory above 0xFFFF that readMem() cannot address.
+ * The target must have been synced through getDevice() with
+ * getJtagId() reporting JTAG_ID_XV2.
+ */
+uint16_t readMem20(uint32_t address) {
+    uint16_t output;
+
+    ClrTCLK();
+    IR_SHIFT(IR_CNTRL_SIG_16BIT);
+    DR_SHIFT(0x0501); // read one word. For a byte, 0x0511.
+    IR_SHIFT(IR_ADDR_16BIT);
+    DR_SHIFT20(address);
+    IR_SHIFT(IR_DATA_TO_ADDR);
+    SetTCLK();
+    ClrTCLK();
+    output = DR_SHIFT(0);
+    SetTCLK();
+    ClrTCLK();
+    SetTCLK();
+    return output;
+}
+
+/*
+ * Writes a word to RAM or a peripheral at any 20-bit address
+ * of an MSP430Xv2 target. As with writeMem(), flash cannot
+ * be written this way.
+ */
+void writeMem20(uint32_t address, uint16_t data) {
+    ClrTCLK();
+    IR_SHIFT(IR_CNTRL_SIG_16BIT);
+    DR_SHIFT(0x0500); // write one word. For a byte, 0x0510.
+    IR_SHIFT(IR_ADDR_16BIT);
+    DR_SHIFT20(address);
+    SetTCLK();
+    IR_SHIFT(IR_DATA_TO_ADDR);
+    DR_SHIFT(data);
+    ClrTCLK();
+    IR_SHIFT(IR_CNTRL_SIG_16BIT);
+    DR_SHIFT(0x0501);
+    SetTCLK();
+    ClrTCLK();
+    SetTCLK();
+}
+
+/*
+ * Burst reads length consecutive words beginning at a 20-bit
+ * address of an MSP430Xv2 target into buffer. The target PC
+ * is loaded once and auto-incremented by IR_DATA_QUICK, so
+ * each word costs a single DR_SHIFT instead of the five scans
+ * of readMem20(). The PC is left past the last word read.
+ */
+void readMemQuick20(uint32_t address, uint16_t *buffer, uint16_t length) {
+    uint16_t i;
+
+    setPC20(address);
+    SetTCLK();
+    IR_SHIFT(IR_CNTRL_SIG_16BIT);
+    DR_SHIFT(0x0501);
+    IR_SHIFT(IR_ADDR_CAPTURE);
+    IR_SHIFT(IR_DATA_QUICK);
+    for (i = 0; i < length; i++) {
+        SetTCLK();
+        ClrTCLK();
+        buffer[i] = DR_SHIFT(0);
+    }
+    SetTCLK();
+}
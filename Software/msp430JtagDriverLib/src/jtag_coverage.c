@@ -0,0 +1,113 @@
+/*
+ * jtag_coverage.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "jtag_coverage.h"
+#include "jtag_control.h"
+#include "jtag_fsm.h"
+#include "jtag_config.h"
+
+#define COVERAGE_BYTES (COVERAGE_WORDS / 8)
+
+static uint8_t covered[COVERAGE_BYTES];  // every word ever fetched
+static uint8_t fresh[COVERAGE_BYTES];    // words fetched since the last stream
+
+/*
+ * Clears the coverage bitmap.
+ */
+void clrCoverage() {
+    uint16_t i;
+
+    for (i = 0; i < COVERAGE_BYTES; i++) {
+        covered[i] = 0;
+        fresh[i] = 0;
+    }
+}
+
+/*
+ * Runs the target for the given number of instructions by stepping
+ * TCLK, marking the address of each instruction fetch. The target
+ * must be halted through haltCPU(), and is halted again at the
+ * instruction after the last one sampled.
+ *
+ * A target that stops fetching, eg in a low-power mode, ends the
+ * run without being counted as a fetch failure or resynced.
+ *
+ * Returns: The number of instructions sampled, less than steps if
+ *          the target stopped fetching.
+ */
+uint16_t sampleCoverage(uint16_t steps) {
+    uint16_t i, address, word;
+
+    releaseCPU(); // TCLK now clocks the CPU
+    for (i = 0; i < steps; i++) {
+        if (!waitInstrFetch(FETCH_TRIES)) {
+            break;
+        }
+        IR_SHIFT(IR_ADDR_CAPTURE);
+        address = DR_SHIFT(0);
+        word = (address - COVERAGE_START) >> 1;
+        if (address >= COVERAGE_START && word < COVERAGE_WORDS) {
+            if (!(covered[word >> 3] & (1 << (word & 7)))) {
+                covered[word >> 3] |= 1 << (word & 7);
+                fresh[word >> 3] |= 1 << (word & 7);
+            }
+        }
+        ClrTCLK(); // move past the fetch
+        SetTCLK();
+    }
+    waitInstrFetch(FETCH_TRIES);
+    haltCPU();
+    return i;
+}
+
+/*
+ * Returns: True if an instruction was fetched from address.
+ */
+bool isCovered(uint16_t address) {
+    uint16_t word = (address - COVERAGE_START) >> 1;
+
+    if (address < COVERAGE_START || word >= COVERAGE_WORDS) {
+        return false;
+    }
+    return (covered[word >> 3] & (1 << (word & 7))) != 0;
+}
+
+/*
+ * Streams the words covered since the last call as runs, in the
+ * format described in jtag_coverage.h, then forgets them so the
+ * next call only streams new coverage.
+ */
+void writeCoverage(TextSink sink) {
+    uint16_t word, run = 0, end = 0;
+    bool set;
+
+    sink("COVERAGE ");
+    writeHex(sink, COVERAGE_START, 4);
+    sink(" ");
+    writeHex(sink, COVERAGE_WORDS, 4);
+    sink("\n");
+    for (word = 0; word <= COVERAGE_WORDS; word++) {
+        set = (word < COVERAGE_WORDS) && (fresh[word >> 3] & (1 << (word & 7)));
+        if (set) {
+            run++;
+        } else if (run != 0) {
+            sink("D");
+            writeNumber(sink, word - run - end);
+            sink(" ");
+            writeNumber(sink, run);
+            sink("\n");
+            end = word;
+            run = 0;
+        }
+        if ((word & 7) == 7) {
+            fresh[word >> 3] = 0;
+        }
+    }
+    sink("END\n");
+}
@@ -0,0 +1,88 @@
+/*
+ * jtag_eem.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "jtag_eem.h"
+#include "jtag_fsm.h"
+
+static uint8_t triggers_used;
+static uint16_t break_react; // BREAKREACT, which reads back shifted
+
+/*
+ * Writes value to an EEM register.
+ */
+static void eemWrite(uint16_t reg, uint16_t value) {
+    IR_SHIFT(IR_EMEX_DATA_EXCHANGE);
+    DR_SHIFT(reg + EEM_WRITE);
+    DR_SHIFT(value);
+}
+
+/*
+ * Programs one trigger to compare a bus against value and feed
+ * the given combination trigger.
+ */
+static void setTrigger(uint8_t trigger, uint16_t value, uint16_t control,
+                       uint8_t combination) {
+    eemWrite(8 * trigger + EEM_MBTRIGxVAL, value);
+    eemWrite(8 * trigger + EEM_MBTRIGxCTL, control);
+    eemWrite(8 * trigger + EEM_MBTRIGxMSK, 0x0000); // compare all bits
+    eemWrite(8 * trigger + EEM_MBTRIGxCMB, 1 << combination);
+}
+
+/*
+ * Programs a watchpoint into the next free EEM triggers. A
+ * watchpoint on a value ANDs an MAB trigger with an MDB trigger
+ * through the combination trigger of the first. The target must
+ * be halted through haltCPU().
+ *
+ * Returns: False if not enough triggers are left.
+ */
+bool setWatchpoint(const Watchpoint *watch) {
+    uint8_t first = triggers_used;
+    uint8_t needed = watch->match_value ? 2 : 1;
+    uint16_t access;
+
+    if (first + needed > EEM_TRIGGERS) {
+        return false;
+    }
+    if ((watch->access & WATCH_READ) && (watch->access & WATCH_WRITE)) {
+        access = EEM_ACCESS_RW;
+    } else if (watch->access & WATCH_WRITE) {
+        access = EEM_ACCESS_WRITE;
+    } else {
+        access = EEM_ACCESS_READ;
+    }
+
+    eemWrite(EEM_GENCTRL, EEM_EN + EEM_CLEAR_STOP + EEM_CLK_EN + EEM_FEAT_EN);
+    setTrigger(first, watch->address, EEM_MAB + access + EEM_CMP_EQUAL, first);
+    if (watch->match_value) {
+        setTrigger(first + 1, watch->value, EEM_MDB + access + EEM_CMP_EQUAL, first);
+    }
+    break_react |= 1 << first;
+    eemWrite(EEM_BREAKREACT, break_react);
+    triggers_used += needed;
+    return true;
+}
+
+/*
+ * Removes every watchpoint and clears a stop caused by one.
+ */
+void clrWatchpoints() {
+    triggers_used = 0;
+    break_react = 0;
+    eemWrite(EEM_BREAKREACT, break_react);
+    eemWrite(EEM_GENCTRL, EEM_EN + EEM_CLEAR_STOP + EEM_CLK_EN + EEM_FEAT_EN);
+}
+
+/*
+ * Returns: True once a watchpoint has stopped the target CPU.
+ */
+bool isWatchpointHit() {
+    IR_SHIFT(IR_EMEX_READ_CONTROL);
+    return (DR_SHIFT(0) & EEM_STOPPED) != 0;
+}
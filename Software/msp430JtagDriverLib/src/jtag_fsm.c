@@ -5,85 +5,104 @@
  *      Author: Jaden Baptista
  */
 
-#include <msp430.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include "jtag_fsm.h"
 #include "jtag_config.h"
 
-volatile void delay() {
-    volatile uint16_t timer = 0xF;
-    while (timer != 0) {
-        timer--;
-    }
-}
-
 /*
- * Clocks port.pin.
+ * Clocks pin, leaving it high.
  */
-volatile inline void clock(volatile uint8_t* port, int pin) {
-    *port &= ~pin;
-    *port |= pin;
+static inline void clock(int pin) {
+    JTAG_LOW(pin);
+    JTAG_HIGH(pin);
 }
 
 
 /*
- * Has a total period of 2 * 7.62microseconds, which satisfies
- * the fuse check time of 5microseconds.
+ * Clocks pin with both phases padded, for the fuse check time
+ * of 5microseconds.
  */
-volatile inline void slowClock(volatile uint8_t* port, int pin) {
-    *port &= ~pin;
-    *port &= ~pin;
-    *port |= pin;
-    *port |= pin;
-
+static inline void slowClock(int pin) {
+    JTAG_LOW(pin);
+    JTAG_FUSE_DELAY();
+    JTAG_HIGH(pin);
+    JTAG_FUSE_DELAY();
 }
 
 /*
- * Sets port.pin high if value is true (1) and
+ * Sets pin high if value is true (1) and
  * low if value is false (0).
  */
-volatile void setLevel(volatile uint8_t* port, int pin, uint16_t value) {
+static inline void setLevel(int pin, uint16_t value) {
     if (value) {
-        *port |= pin;
+        JTAG_HIGH(pin);
     } else {
-        *port &= ~pin;
+        JTAG_LOW(pin);
     }
 }
 
+#ifndef JTAG_SBW
 /*
- * Initializes the JTAG FSM to the IDLE state.
+ * Runs the JTAG entry sequence and brings the JTAG FSM to the
+ * IDLE state.
  */
-void initFSM() {
-    // configure JTAG GPIO pins
-    JTAGDIR = 0xFF;  // Begin with all pins set to output
-    JTAGDIR &= ~TDO; // Set TDO to input
-    JTAGOUT = 0x00;  // Set output pins low and resistors down
-    JTAGREN = 0x00;
-    JTAGREN |= TDO;  // Turn on TDO pulldown resistor
+static void enterFSM() {
+    // configure JTAG GPIO pins, all outputs low
+    JTAG_LOW(TEST);
+    JTAG_LOW(RST);
+    JTAG_LOW(TMS);
+    JTAG_LOW(TCK);
+    JTAG_LOW(TDI);
+    JTAG_CLAIM_PINS();
 
     // JTAG entry sequence: case 2b, Fig.2-13
-    JTAGOUT |= TEST;
-    clock(&JTAGOUT, TEST); // low->high
-    JTAGOUT |= RST;
+    JTAG_HIGH(TEST);
+    clock(TEST); // low->high
+    JTAG_HIGH(RST);
 
     // Reset FSM to IDLE
-    JTAGOUT |= TMS;
+    JTAG_HIGH(TMS);
     int i;
     for (i = 0; i < 7; i++) {
-        clock(&JTAGOUT, TCK);    // FSM: TLR
+        clock(TCK);    // FSM: TLR
     }
-    JTAGOUT &= ~TCK;
-    JTAGOUT &= ~TMS;
-    JTAGOUT |= TDI;              // FSM: IDLE
-    JTAGOUT |= TCK;
+    JTAG_LOW(TCK);
+    JTAG_LOW(TMS);
+    JTAG_HIGH(TDI);              // FSM: IDLE
+    JTAG_HIGH(TCK);
 
     // Perform fuse check
     // this needs a low phase of 5microseconds
-    slowClock(&JTAGOUT, TMS);
-    slowClock(&JTAGOUT, TMS);
-    slowClock(&JTAGOUT, TMS);
-    JTAGOUT &= ~TMS;
+    slowClock(TMS);
+    slowClock(TMS);
+    slowClock(TMS);
+    JTAG_LOW(TMS);
+}
+
+/*
+ * Reclaims the JTAG pins for a target that should still be under
+ * JTAG control, eg after the debugger itself was reset. Unlike
+ * initFSM() the entry sequence, TAP reset and fuse check are
+ * skipped: the pins are driven straight back to the levels they
+ * idle at between scans, with TCLK at the given level. The caller
+ * must confirm the target is still synced, see resumeDevice().
+ */
+void resumeFSM(bool tclk) {
+    JTAG_HIGH(TEST);
+    JTAG_HIGH(RST);
+    JTAG_HIGH(TCK);
+    JTAG_LOW(TMS);
+    setLevel(TDI, tclk);
+    JTAG_CLAIM_PINS();
+}
+
+/*
+ * Returns: The current level of TCLK.
+ */
+bool getTCLK() {
+    return JTAG_DRIVEN(TDI);
 }
 
 /*
@@ -93,28 +112,28 @@ void initFSM() {
  *
  * Returns: 8-bit JTAG ID (See pg.64 of interface reference).
  */
-uint8_t IR_SHIFT(uint8_t input_data) {
+static uint8_t shiftIR(uint8_t input_data) {
     uint8_t output_data = 0;
-    int prev_TDI = (JTAGOUT & TDI);
+    int prev_TDI = JTAG_DRIVEN(TDI);
 
     // Set FSM to Shift-IR state
     // FSM set through falling and rising edge
-    JTAGOUT |= TMS;     // TMS high
-    clock(&JTAGOUT, TCK);    // (1) FSM: Select-DR
-    clock(&JTAGOUT, TCK);    // (1) FSM: Select-IR
-    JTAGOUT &= ~TMS;    // TMS low
-    clock(&JTAGOUT, TCK);     // (0) FSM: Capture-IR
-    clock(&JTAGOUT, TCK);     // (0) FSM: Shift-IR
+    JTAG_HIGH(TMS);     // TMS high
+    clock(TCK);    // (1) FSM: Select-DR
+    clock(TCK);    // (1) FSM: Select-IR
+    JTAG_LOW(TMS);    // TMS low
+    clock(TCK);     // (0) FSM: Capture-IR
+    clock(TCK);     // (0) FSM: Shift-IR
 
     // Shift data into IR LSB first
     volatile uint8_t bit;
     int i;
     for (i = 0; i < 7; i++) {
         bit = (input_data >> i) & 1;
-        setLevel(&JTAGOUT, TDI, bit);
-        clock(&JTAGOUT, TCK);
+        setLevel(TDI, bit);
+        clock(TCK);
         uint8_t level = 1;
-        if ((JTAGIN & TDO) == 0) {
+        if (!JTAG_READ(TDO)) {
             level = 0;
         }
         output_data |= level << (7 - i);
@@ -122,21 +141,21 @@ uint8_t IR_SHIFT(uint8_t input_data) {
 
     // Send MSB and return to IDLE state
     bit = (input_data >> 7) & 1;
-    JTAGOUT |= TMS;
-    setLevel(&JTAGOUT, TDI, bit);
-    clock(&JTAGOUT, TCK);    // (1) FSM: Exit-IR
-    if ((JTAGIN & TDO) == 0) {
+    JTAG_HIGH(TMS);
+    setLevel(TDI, bit);
+    clock(TCK);    // (1) FSM: Exit-IR
+    if (!JTAG_READ(TDO)) {
         output_data &= ~1;
     } else {
         output_data |= 1;
     }
-    setLevel(&JTAGOUT, TDI, prev_TDI);
-    clock(&JTAGOUT, TCK);    // (1) FSM: Update-IR
-    JTAGOUT &= ~TMS;
-    clock(&JTAGOUT, TCK);    // (0) FSM: IDLE
+    setLevel(TDI, prev_TDI);
+    clock(TCK);    // (1) FSM: Update-IR
+    JTAG_LOW(TMS);
+    clock(TCK);    // (0) FSM: IDLE
 
     for (i = 0; i < 4; i++) {
-        clock(&JTAGOUT, TCK);
+        clock(TCK);
     }
 
     return output_data;
@@ -149,27 +168,27 @@ uint8_t IR_SHIFT(uint8_t input_data) {
  *
  * Returns: Last captured and stored value in the addressed DR.
  */
-uint16_t DR_SHIFT(uint16_t input_data) {
+static uint16_t shiftDR(uint16_t input_data) {
     uint16_t output_data = 0;
-    int prev_TDI = JTAGOUT & TDI;
+    int prev_TDI = JTAG_DRIVEN(TDI);
 
     // Set FSM to Shift-IR state
     // FSM set through falling and rising edge
-    JTAGOUT |= TMS;     // TMS high
-    clock(&JTAGOUT, TCK);    // (1) FSM: Select-DR
-    JTAGOUT &= ~TMS;    // TMS low
-    clock(&JTAGOUT, TCK);     // (0) FSM: Capture-DR
-    clock(&JTAGOUT, TCK);     // (0) FSM: Shift-DR
+    JTAG_HIGH(TMS);     // TMS high
+    clock(TCK);    // (1) FSM: Select-DR
+    JTAG_LOW(TMS);    // TMS low
+    clock(TCK);     // (0) FSM: Capture-DR
+    clock(TCK);     // (0) FSM: Shift-DR
 
     // Shift data into DR MSB first
     uint16_t bit;
     int i;
     for (i = 15; i > 0; i--) {
         bit = (input_data >> i) & 1;
-        setLevel(&JTAGOUT, TDI, bit);
-        clock(&JTAGOUT, TCK);
+        setLevel(TDI, bit);
+        clock(TCK);
         volatile uint16_t level = 1;
-          if ((JTAGIN & TDO) == 0) {
+          if (!JTAG_READ(TDO)) {
             level = 0;
         } else {
             level = 1;
@@ -179,41 +198,637 @@ uint16_t DR_SHIFT(uint16_t input_data) {
 
     // Send LSB and return to IDLE state
     bit = input_data & 1;
-    JTAGOUT |= TMS;
-    setLevel(&JTAGOUT, TDI, bit);
-    clock(&JTAGOUT, TCK);    // (1) FSM: Exit-DR
-    if ((JTAGIN & TDO) == 0) {
+    JTAG_HIGH(TMS);
+    setLevel(TDI, bit);
+    clock(TCK);    // (1) FSM: Exit-DR
+    if (!JTAG_READ(TDO)) {
         output_data &= ~1;
     } else {
         output_data |= 1;
     }
 
-    setLevel(&JTAGOUT, TDI, prev_TDI);
-    clock(&JTAGOUT, TCK);    // (1) FSM: Update-DR
-    JTAGOUT &= ~TMS;
-    clock(&JTAGOUT, TCK);    // (0) FSM: IDLE
+    setLevel(TDI, prev_TDI);
+    clock(TCK);    // (1) FSM: Update-DR
+    JTAG_LOW(TMS);
+    clock(TCK);    // (0) FSM: IDLE
+
+    for (i = 0; i < 4; i++) {
+        clock(TCK);
+    }
+
+    return output_data;
+}
+
+/*
+ * Shifts a 20-bit address into a JTAG data register (DR). Used
+ * with IR_ADDR_16BIT and IR_ADDR_CAPTURE on MSP430X targets,
+ * whose MAB is 20 bits wide.
+ *
+ * input_data: The address to be shifted into the addressed DR,
+ *             only the lowest 20 bits are used.
+ *
+ * Returns: Last captured and stored 20-bit value in the
+ *          addressed DR.
+ */
+static uint32_t shiftDR20(uint32_t input_data) {
+    uint32_t output_data = 0;
+    int prev_TDI = JTAG_DRIVEN(TDI);
+
+    // Set FSM to Shift-DR state
+    JTAG_HIGH(TMS);     // TMS high
+    clock(TCK);    // (1) FSM: Select-DR
+    JTAG_LOW(TMS);    // TMS low
+    clock(TCK);     // (0) FSM: Capture-DR
+    clock(TCK);     // (0) FSM: Shift-DR
+
+    // Shift data into DR MSB first
+    uint16_t bit;
+    int i;
+    for (i = 19; i > 0; i--) {
+        bit = (input_data >> i) & 1;
+        setLevel(TDI, bit);
+        clock(TCK);
+        if (JTAG_READ(TDO)) {
+            output_data |= (uint32_t) 1 << i;
+        }
+    }
+
+    // Send LSB and return to IDLE state
+    bit = input_data & 1;
+    JTAG_HIGH(TMS);
+    setLevel(TDI, bit);
+    clock(TCK);    // (1) FSM: Exit-DR
+    if (JTAG_READ(TDO)) {
+        output_data |= 1;
+    }
+
+    setLevel(TDI, prev_TDI);
+    clock(TCK);    // (1) FSM: Update-DR
+    JTAG_LOW(TMS);
+    clock(TCK);    // (0) FSM: IDLE
 
     for (i = 0; i < 4; i++) {
-        clock(&JTAGOUT, TCK);
+        clock(TCK);
+    }
+
+    // the captured MAB leaves with bits 19-16 last,
+    // swap them back into place as DR_Shift20 of the interface
+    // reference does
+    return ((output_data << 16) + (output_data >> 4)) & 0x000FFFFF;
+}
+
+/*
+ * Sets TCLK to 1.
+ */
+static inline void tclkHigh() {
+    JTAG_HIGH(TDI);
+}
+
+/*
+ * Sets TCLK to 0.
+ */
+static inline void tclkLow() {
+    JTAG_LOW(TDI);
+}
+
+/*
+ * Clocks one word into the PSA register under IR_DATA_PSA: TCLK
+ * is raised, the TAP makes a pass through the DR path to capture
+ * and update the register, then TCLK is lowered. This is the loop
+ * body of VerifyPSA in the interface reference.
+ */
+static void psaStep() {
+    tclkHigh();
+    JTAG_LOW(TCK);
+    JTAG_HIGH(TMS);
+    JTAG_HIGH(TCK);     // (1) FSM: Select-DR
+    JTAG_LOW(TCK);
+    JTAG_LOW(TMS);
+    JTAG_HIGH(TCK);     // (0) FSM: Capture-DR
+    JTAG_LOW(TCK);
+    JTAG_HIGH(TCK);     // (0) FSM: Shift-DR
+    JTAG_LOW(TCK);
+    JTAG_HIGH(TMS);
+    JTAG_HIGH(TCK);     // (1) FSM: Exit-DR
+    JTAG_LOW(TCK);
+    JTAG_HIGH(TCK);     // (1) FSM: Update-DR
+    JTAG_LOW(TMS);
+    JTAG_LOW(TCK);
+    JTAG_HIGH(TCK);     // (0) FSM: IDLE
+    tclkLow();
+}
+
+#else /* JTAG_SBW */
+
+/*
+ * Spy-Bi-Wire transport. Every TCK cycle of the 4-wire interface
+ * becomes three SBWTCK time slots on the TEST pin: a TMS slot, a
+ * TDI slot and a TDO slot, with SBWTDIO on the RST pin carrying the
+ * data of each slot. A scan therefore takes three SBWTCK pulses per
+ * TCK, so an IR_SHIFT costs 42 and a DR_SHIFT 63 SBWTCK pulses
+ * compared with 19 and 25 TCK pulses over 4-wire. In exchange TDO,
+ * TDI, TMS and TCK are left free for the display.
+ *
+ * SBWTCK must never stay low for more than 7 microseconds or the
+ * target leaves Spy-Bi-Wire mode, so interrupts are held off for
+ * the duration of each scan.
+ */
+
+static uint8_t tclk_level; // TCLK, ie the level of the last TDI slot in IDLE
+
+/*
+ * Clocks one Spy-Bi-Wire TCK cycle.
+ *
+ * tms: The TMS value of the cycle.
+ * tdi: The TDI value of the cycle, which doubles as TCLK in IDLE.
+ *
+ * Returns: The TDO value of the cycle.
+ */
+static uint8_t sbwCycle(uint8_t tms, uint8_t tdi) {
+    uint8_t hold = !tms && tclk_level; // decided before SBWTCK goes low
+    uint8_t tdo;
+
+    // TMS slot
+    setLevel(SBWTDIO, tms);
+    JTAG_LOW(SBWTCK);
+    if (hold) {
+        JTAG_HIGH(SBWTDIO); // hold TCLK high across the TMS slot
+    }
+    JTAG_HIGH(SBWTCK);
+
+    // TDI slot
+    setLevel(SBWTDIO, tdi);
+    clock(SBWTCK);
+    tclk_level = tdi;
+
+    // TDO slot, the target drives SBWTDIO while SBWTCK is low
+    JTAG_INPUT(SBWTDIO);
+    JTAG_LOW(SBWTCK);
+    tdo = JTAG_READ(SBWTDIO);
+    JTAG_HIGH(SBWTCK);
+    JTAG_OUTPUT(SBWTDIO);
+
+    return tdo;
+}
+
+/*
+ * Shifts the lowest bits of input_data MSB first through a data
+ * register, starting and ending in the IDLE state.
+ */
+static uint32_t sbwShiftDR(uint32_t input_data, int bits) {
+    uint32_t output_data = 0;
+    uint8_t tclk = tclk_level; // the data bits overwrite tclk_level
+    uint16_t interrupts;
+    int i;
+
+    JTAG_HOLD_INTERRUPTS(interrupts);
+    sbwCycle(1, tclk);          // FSM: Select-DR
+    sbwCycle(0, tclk);          // FSM: Capture-DR
+    sbwCycle(0, tclk);          // FSM: Shift-DR
+    for (i = bits - 1; i > 0; i--) {
+        if (sbwCycle(0, (input_data >> i) & 1)) {
+            output_data |= (uint32_t) 1 << i;
+        }
+    }
+    if (sbwCycle(1, input_data & 1)) {  // FSM: Exit-DR
+        output_data |= 1;
+    }
+    sbwCycle(1, tclk);          // FSM: Update-DR
+    sbwCycle(0, tclk);          // FSM: IDLE
+    JTAG_RESTORE_INTERRUPTS(interrupts);
+
+    return output_data;
+}
+
+/*
+ * Runs the Spy-Bi-Wire entry sequence and brings the JTAG FSM
+ * to the IDLE state. Only the TEST and RST pins are configured.
+ */
+static void enterFSM() {
+    int i;
+
+    // configure Spy-Bi-Wire GPIO pins
+    JTAG_LOW(SBWTCK);
+    JTAG_HIGH(SBWTDIO);
+    JTAG_CLAIM_SBW_PINS();
+
+    // Spy-Bi-Wire entry sequence: SBWTCK held low with RST
+    // high, then raised to enable the target's SBW logic
+    JTAG_DELAY_CYCLES(800);
+    JTAG_HIGH(SBWTCK);
+    JTAG_DELAY_CYCLES(800);
+
+    // Reset FSM to IDLE
+    for (i = 0; i < 6; i++) {
+        sbwCycle(1, 1);          // FSM: TLR
+    }
+    sbwCycle(0, 1);              // FSM: IDLE
+
+    // Perform fuse check through TMS pulses, the TDI slots of
+    // which clock the FSM around the DR path back to IDLE
+    sbwCycle(1, 1);
+    sbwCycle(0, 1);
+    sbwCycle(1, 1);
+    sbwCycle(0, 1);
+    sbwCycle(1, 1);
+    sbwCycle(1, 1);
+    sbwCycle(0, 1);              // FSM: IDLE
+}
+
+/*
+ * Reclaims the Spy-Bi-Wire pins without the entry sequence, see
+ * the 4-wire resumeFSM(). The target drops out of Spy-Bi-Wire once
+ * SBWTCK has been low for 100 microseconds, so this only succeeds
+ * if SBWTCK was held high through the debugger reset.
+ */
+void resumeFSM(bool tclk) {
+    tclk_level = tclk;
+    JTAG_HIGH(SBWTCK);
+    JTAG_HIGH(SBWTDIO);
+    JTAG_CLAIM_SBW_PINS();
+}
+
+/*
+ * Returns: The current level of TCLK.
+ */
+bool getTCLK() {
+    return tclk_level != 0;
+}
+
+/*
+ * Shifts an 8-bit JTAG instruction into the JTAG instruction register (IR).
+ *
+ * input_data: The JTAG instruction to be shifted into the IR.
+ *
+ * Returns: 8-bit JTAG ID (See pg.64 of interface reference).
+ */
+static uint8_t shiftIR(uint8_t input_data) {
+    uint8_t output_data = 0;
+    uint8_t tclk = tclk_level; // the data bits overwrite tclk_level
+    uint16_t interrupts;
+    int i;
+
+    JTAG_HOLD_INTERRUPTS(interrupts);
+    sbwCycle(1, tclk);          // FSM: Select-DR
+    sbwCycle(1, tclk);          // FSM: Select-IR
+    sbwCycle(0, tclk);          // FSM: Capture-IR
+    sbwCycle(0, tclk);          // FSM: Shift-IR
+
+    // Shift data into IR LSB first
+    for (i = 0; i < 7; i++) {
+        if (sbwCycle(0, (input_data >> i) & 1)) {
+            output_data |= 1 << (7 - i);
+        }
+    }
+    if (sbwCycle(1, (input_data >> 7) & 1)) { // FSM: Exit-IR
+        output_data |= 1;
+    }
+    sbwCycle(1, tclk);          // FSM: Update-IR
+    sbwCycle(0, tclk);          // FSM: IDLE
+    JTAG_RESTORE_INTERRUPTS(interrupts);
+
+    return output_data;
+}
+
+/*
+ * Shifts a 16-bit word into a JTAG data register (DR).
+ *
+ * input_data: The data to be shifted into the addressed DR.
+ *
+ * Returns: Last captured and stored value in the addressed DR.
+ */
+static uint16_t shiftDR(uint16_t input_data) {
+    return (uint16_t) sbwShiftDR(input_data, 16);
+}
+
+/*
+ * Shifts a 20-bit address into a JTAG data register (DR), see
+ * the 4-wire shiftDR20() for the reordering of the result.
+ */
+static uint32_t shiftDR20(uint32_t input_data) {
+    uint32_t output_data = sbwShiftDR(input_data, 20);
+    return ((output_data << 16) + (output_data >> 4)) & 0x000FFFFF;
+}
+
+/*
+ * Sets TCLK to 1. Over Spy-Bi-Wire this takes an IDLE cycle
+ * with TCLK in its TDI slot.
+ */
+static void tclkHigh() {
+    uint16_t interrupts;
+
+    JTAG_HOLD_INTERRUPTS(interrupts);
+    sbwCycle(0, 1);
+    JTAG_RESTORE_INTERRUPTS(interrupts);
+}
+
+/*
+ * Sets TCLK to 0. Over Spy-Bi-Wire this takes an IDLE cycle
+ * with TCLK in its TDI slot.
+ */
+static void tclkLow() {
+    uint16_t interrupts;
+
+    JTAG_HOLD_INTERRUPTS(interrupts);
+    sbwCycle(0, 0);
+    JTAG_RESTORE_INTERRUPTS(interrupts);
+}
+
+/*
+ * Clocks one word into the PSA register, see the 4-wire
+ * psaStep(). TCLK is carried in the TDI slots.
+ */
+static void psaStep() {
+    uint16_t interrupts;
+
+    JTAG_HOLD_INTERRUPTS(interrupts);
+    sbwCycle(0, 1);             // TCLK high
+    sbwCycle(1, 1);             // FSM: Select-DR
+    sbwCycle(0, 1);             // FSM: Capture-DR
+    sbwCycle(0, 1);             // FSM: Shift-DR
+    sbwCycle(1, 1);             // FSM: Exit-DR
+    sbwCycle(1, 1);             // FSM: Update-DR
+    sbwCycle(0, 1);             // FSM: IDLE
+    sbwCycle(0, 0);             // TCLK low
+    JTAG_RESTORE_INTERRUPTS(interrupts);
+}
+
+#endif /* JTAG_SBW */
+
+#ifdef JTAG_SCAN_COUNTS
+static ScanCounts scan_counts;
+#endif
+
+#ifdef JTAG_CAPTURE
+static ScanRecord capture_log[JTAG_CAPTURE_DEPTH];
+static uint16_t capture_length;
+static bool capture_on;
+static bool capture_overflow;
+
+/*
+ * Appends a scan to the capture log while capturing. Once the
+ * log is full further scans are dropped and the overflow flag is
+ * raised, so a log always replays from its first record.
+ */
+static void recordScan(uint8_t type, uint32_t input, uint32_t output) {
+    ScanRecord *record;
+
+    if (!capture_on) {
+        return;
+    }
+    if (capture_length == JTAG_CAPTURE_DEPTH) {
+        capture_overflow = true;
+        return;
     }
+    record = &capture_log[capture_length++];
+    record->type = type;
+    record->high = (uint8_t) (((input >> 16) & 0x0F) | ((output >> 12) & 0xF0));
+    record->timestamp = JTAG_TIMESTAMP();
+    record->input = (uint16_t) input;
+    record->output = (uint16_t) output;
+}
+#endif
+
+/*
+ * Initializes the JTAG FSM to the IDLE state.
+ */
+void initFSM() {
+    enterFSM();
+#ifdef JTAG_CAPTURE
+    recordScan(SCAN_RESET, 0, 0);
+#endif
+}
+
+/*
+ * Shifts an 8-bit JTAG instruction into the JTAG instruction register (IR).
+ *
+ * input_data: The JTAG instruction to be shifted into the IR.
+ *
+ * Returns: 8-bit JTAG ID (See pg.64 of interface reference).
+ */
+uint8_t IR_SHIFT(uint8_t input_data) {
+    uint8_t output_data = shiftIR(input_data);
 
+#ifdef JTAG_SCAN_COUNTS
+    scan_counts.ir_scans++;
+#endif
+#ifdef JTAG_CAPTURE
+    recordScan(SCAN_IR, input_data, output_data);
+#endif
     return output_data;
 }
 
+/*
+ * Shifts a 16-bit word into a JTAG data register (DR).
+ *
+ * input_data: The data to be shifted into the addressed DR.
+ *
+ * Returns: Last captured and stored value in the addressed DR.
+ */
+uint16_t DR_SHIFT(uint16_t input_data) {
+    uint16_t output_data = shiftDR(input_data);
+
+#ifdef JTAG_SCAN_COUNTS
+    scan_counts.dr_scans++;
+#endif
+#ifdef JTAG_CAPTURE
+    recordScan(SCAN_DR, input_data, output_data);
+#endif
+    return output_data;
+}
+
+/*
+ * Shifts a 20-bit address into a JTAG data register (DR).
+ *
+ * input_data: The address to be shifted into the addressed DR,
+ *             only the lowest 20 bits are used.
+ *
+ * Returns: Last captured and stored 20-bit value in the
+ *          addressed DR.
+ */
+uint32_t DR_SHIFT20(uint32_t input_data) {
+    uint32_t output_data = shiftDR20(input_data);
+
+#ifdef JTAG_SCAN_COUNTS
+    scan_counts.dr_scans++;
+#endif
+#ifdef JTAG_CAPTURE
+    recordScan(SCAN_DR20, input_data, output_data);
+#endif
+    return output_data;
+}
+
+#ifndef JTAG_INLINE_TCLK
 /*
  * Sets TCLK to 1.
  */
-inline void SetTCLK() {
-    JTAGOUT |= TDI;
+void SetTCLK() {
+    tclkHigh();
+#ifdef JTAG_SCAN_COUNTS
+    scan_counts.tclk_edges++;
+#endif
+#ifdef JTAG_CAPTURE
+    recordScan(SCAN_TCLK_SET, 1, 0);
+#endif
 }
 
 /*
  * Sets TCLK to 0.
  */
-inline void ClrTCLK() {
-    JTAGOUT &= ~TDI;
+void ClrTCLK() {
+    tclkLow();
+#ifdef JTAG_SCAN_COUNTS
+    scan_counts.tclk_edges++;
+#endif
+#ifdef JTAG_CAPTURE
+    recordScan(SCAN_TCLK_CLR, 0, 0);
+#endif
+}
+#endif
+
+/*
+ * Clocks one memory word into the PSA register after IR_DATA_PSA
+ * has been shifted in. Leaves TCLK low.
+ */
+void ClockPSA() {
+    psaStep();
+#ifdef JTAG_SCAN_COUNTS
+    scan_counts.tclk_edges += 2;
+#endif
+#ifdef JTAG_CAPTURE
+    recordScan(SCAN_PSA, 0, 0);
+#endif
+}
+
+#ifdef JTAG_SCAN_COUNTS
+/*
+ * Returns the number of scans and TCLK edges issued since the
+ * last call to clrScanCounts(). Clearing the counts before a
+ * debugger action and reading them after gives its JTAG cost.
+ */
+const ScanCounts *getScanCounts() {
+    return &scan_counts;
+}
+
+/*
+ * Resets the scan and TCLK edge counts.
+ */
+void clrScanCounts() {
+    scan_counts.ir_scans = 0;
+    scan_counts.dr_scans = 0;
+    scan_counts.tclk_edges = 0;
+}
+#endif
+
+#ifdef JTAG_CAPTURE
+/*
+ * Clears the capture log and begins recording every scan and
+ * TCLK edge into it. The log opens with the level TCLK is at, so
+ * a capture can start in the middle of a session as well as
+ * before initFSM().
+ */
+void startCapture() {
+    capture_length = 0;
+    capture_overflow = false;
+    capture_on = true;
+    recordScan(SCAN_START, getTCLK(), 0);
+}
+
+/*
+ * Stops recording, leaving the capture log intact.
+ */
+void stopCapture() {
+    capture_on = false;
+}
+
+/*
+ * Returns the capture log, which holds getCaptureLength()
+ * records in the order the scans were issued.
+ */
+const ScanRecord *getCapture() {
+    return capture_log;
+}
+
+uint16_t getCaptureLength() {
+    return capture_length;
+}
+
+/*
+ * Returns true if scans were dropped because the capture log
+ * filled up, in which case only a prefix of the session is
+ * available for replay.
+ */
+bool isCaptureOverflowed() {
+    return capture_overflow;
+}
+
+/*
+ * Reissues every scan and TCLK edge in the capture log against
+ * the target and compares each captured TDO value with the one
+ * originally recorded. The pins are first brought back to where
+ * the capture started through resumeFSM(), and every initFSM()
+ * made while capturing is redone, so a capture started in the
+ * middle of a session replays against a target still in the
+ * state it was in then. Replay does not record itself, so the
+ * log is left unchanged.
+ *
+ * Returns: The number of scans whose TDO differed, or 0 if
+ *          the target reproduced the capture exactly.
+ */
+uint16_t replayCapture() {
+    const ScanRecord *record;
+    uint32_t input, output, expected;
+    uint16_t i, mismatches = 0;
+    bool was_on = capture_on;
+
+    capture_on = false;
+    for (i = 0; i < capture_length; i++) {
+        record = &capture_log[i];
+        input = ((uint32_t) (record->high & 0x0F) << 16) | record->input;
+        expected = ((uint32_t) (record->high & 0xF0) << 12) | record->output;
+        switch (record->type) {
+        case SCAN_START:
+            resumeFSM(input != 0);
+            output = 0;
+            break;
+        case SCAN_RESET:
+            enterFSM();
+            output = 0;
+            break;
+        case SCAN_IR:
+            output = shiftIR((uint8_t) input);
+            break;
+        case SCAN_DR:
+            output = shiftDR((uint16_t) input);
+            break;
+        case SCAN_DR20:
+            output = shiftDR20(input);
+            break;
+        case SCAN_TCLK_SET:
+            tclkHigh();
+            output = 0;
+            break;
+        case SCAN_TCLK_CLR:
+            tclkLow();
+            output = 0;
+            break;
+        case SCAN_PSA:
+            psaStep();
+            output = 0;
+            break;
+        default:
+            output = ~expected; // corrupt record
+            break;
+        }
+        if (output != expected) {
+            mismatches++;
+        }
+    }
+    capture_on = was_on;
+    return mismatches;
 }
+#endif
 
 void releaseFSM() {
-    JTAGOUT &= ~TEST;
+    JTAG_LOW(TEST);
 }
@@ -0,0 +1,95 @@
+/*
+ * jtag_snapshot.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ */
+#include <msp430.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "jtag_snapshot.h"
+#include "jtag_control.h"
+
+/*
+ * A block of target memory included in a snapshot.
+ */
+struct MemoryRange {
+    uint16_t start;
+    uint16_t words;
+};
+
+// RAM, information memory and flash of the MSP430G2553
+static const struct MemoryRange snapshot_ranges[] = {
+    {0x0200, 256},
+    {0x1000, 128},
+    {0xC000, 8192},
+};
+
+/*
+ * Writes a snapshot of the target to the sink in the format
+ * described in jtag_snapshot.h. The target must be halted
+ * through haltCPU(), and is halted again when this returns,
+ * with its registers unchanged.
+ *
+ * Returns: False if the target could not be set to the
+ *          instruction-fetch state, in which case nothing is
+ *          written.
+ */
+bool writeSnapshot(TextSink sink) {
+    const struct MemoryRange *range;
+    uint16_t regs[16];
+    uint16_t address, end;
+    uint8_t reg;
+    int i;
+
+    // registers first, readReg() leaves the CPU running
+    if (!setInstrFetch()) {
+        return false;
+    }
+    for (reg = 0; reg < 16; reg++) {
+        if (reg != 3) {
+            regs[reg] = readReg(reg);
+        }
+    }
+    if (!setInstrFetch()) {
+        return false;
+    }
+    haltCPU();
+
+    sink("SNAPSHOT ");
+    writeHex(sink, getJtagId(), 2);
+    sink("\n");
+    for (reg = 0; reg < 16; reg++) {
+        if (reg == 3) {
+            continue; // constant generator, holds no state
+        }
+        sink("R");
+        writeHex(sink, reg, 1);
+        sink(" ");
+        writeHex(sink, regs[reg], 4);
+        sink("\n");
+    }
+
+    for (range = snapshot_ranges;
+         range < snapshot_ranges + sizeof(snapshot_ranges) / sizeof(snapshot_ranges[0]);
+         range++) {
+        address = range->start;
+        end = range->start + 2 * (range->words - SNAPSHOT_LINE_WORDS);
+        while (true) {
+            sink("M");
+            writeHex(sink, address, 4);
+            for (i = 0; i < SNAPSHOT_LINE_WORDS; i++) {
+                sink(" ");
+                writeHex(sink, readMem(address + 2 * i), 4);
+            }
+            sink("\n");
+            if (address == end) {
+                break; // the flash range ends at 0xFFFF
+            }
+            address += 2 * SNAPSHOT_LINE_WORDS;
+        }
+    }
+    sink("END\n");
+    return true;
+}
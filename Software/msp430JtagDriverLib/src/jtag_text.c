@@ -0,0 +1,44 @@
+/*
+ * jtag_text.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ */
+#include <stdint.h>
+#include "jtag_text.h"
+
+/*
+ * Writes the lowest digits of value, at most 4, as uppercase
+ * hexadecimal to the sink.
+ */
+void writeHex(TextSink sink, uint16_t value, int digits) {
+    char text[5];
+    uint8_t nibble;
+    int i;
+
+    text[digits] = '\0';
+    for (i = digits - 1; i >= 0; i--) {
+        nibble = value & 0xF;
+        text[i] = (nibble < 10) ? '0' + nibble : 'A' + nibble - 10;
+        value >>= 4;
+    }
+    sink(text);
+}
+
+/*
+ * Writes value as hexadecimal without leading zeros to the sink, for
+ * counts and deltas that are usually small.
+ */
+void writeNumber(TextSink sink, uint32_t value) {
+    int digits = 1;
+
+    if ((value >> 16) != 0) {
+        writeNumber(sink, value >> 16);
+        writeHex(sink, (uint16_t) value, 4);
+        return;
+    }
+    while (digits < 4 && (value >> (4 * digits)) != 0) {
+        digits++;
+    }
+    writeHex(sink, (uint16_t) value, digits);
+}
@@ -0,0 +1,302 @@
+/*
+ * jtag_vcd.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "jtag_vcd.h"
+#include "jtag_fsm.h"
+
+static TextSink vcd_sink;
+static uint32_t vcd_time;       // current time in MCLK cycles
+static uint32_t vcd_dumped;     // last time written to the sink
+static uint16_t vcd_levels;     // one bit per single bit signal
+
+/*
+ * Writes value as a decimal string to the sink.
+ */
+static void vcdDecimal(uint32_t value) {
+    char digits[11];
+    int i = 10;
+
+    digits[i] = '\0';
+    do {
+        digits[--i] = '0' + (char) (value % 10);
+        value /= 10;
+    } while (value != 0);
+    vcd_sink(&digits[i]);
+}
+
+/*
+ * Writes the current time to the sink if it moved on since the
+ * last value change.
+ */
+static void vcdStamp() {
+    if (vcd_time != vcd_dumped) {
+        vcd_sink("#");
+        vcdDecimal(vcd_time);
+        vcd_sink("\n");
+        vcd_dumped = vcd_time;
+    }
+}
+
+/*
+ * Begins a waveform of count signals, all starting at 0 at time 0.
+ * Signals are afterwards referred to by their index in names. Time
+ * is measured in MCLK cycles of a 1MHz clock, so one VCD time unit
+ * is one microsecond.
+ *
+ * sink: Receives the waveform text, eg waitPrint().
+ * scope: The module name the signals are grouped under.
+ * names: The name of every signal.
+ * widths: The width in bits of every signal, or NULL if all
+ *         signals are single bits. Set single bits with vcdSet()
+ *         and wider signals with vcdSetBus().
+ * count: The number of signals, at most VCD_MAX_SIGNALS.
+ */
+void vcdBegin(TextSink sink, char *scope, char *const *names,
+              const uint8_t *widths, uint8_t count) {
+    char id[2] = {'!', '\0'};
+    uint8_t i, width;
+
+    vcd_sink = sink;
+    vcd_time = 0;
+    vcd_dumped = 0;
+    vcd_levels = 0;
+    if (count > VCD_MAX_SIGNALS) {
+        count = VCD_MAX_SIGNALS;
+    }
+
+    vcd_sink("$timescale 1us $end\n$scope module ");
+    vcd_sink(scope);
+    vcd_sink(" $end\n");
+    for (i = 0; i < count; i++) {
+        id[0] = '!' + i;
+        width = (widths != NULL) ? widths[i] : 1;
+        vcd_sink("$var wire ");
+        vcdDecimal(width);
+        vcd_sink(" ");
+        vcd_sink(id);
+        vcd_sink(" ");
+        vcd_sink(names[i]);
+        vcd_sink(" $end\n");
+    }
+    vcd_sink("$upscope $end\n$enddefinitions $end\n#0\n");
+    for (i = 0; i < count; i++) {
+        id[0] = '!' + i;
+        width = (widths != NULL) ? widths[i] : 1;
+        vcd_sink((width == 1) ? "0" : "b0 ");
+        vcd_sink(id);
+        vcd_sink("\n");
+    }
+}
+
+/*
+ * Moves the waveform forward by the given number of cycles.
+ */
+void vcdAdvance(uint32_t cycles) {
+    vcd_time += cycles;
+}
+
+/*
+ * Sets a signal to level at the current time, writing a value
+ * change only if the level differs from the previous one.
+ */
+void vcdSet(uint8_t signal, bool level) {
+    char change[4] = {'0', '!', '\n', '\0'};
+    uint16_t mask = 1 << signal;
+
+    if (((vcd_levels & mask) != 0) == level) {
+        return;
+    }
+    vcd_levels ^= mask;
+    vcdStamp();
+    change[0] = level ? '1' : '0';
+    change[1] = '!' + signal;
+    vcd_sink(change);
+}
+
+/*
+ * Writes the value of a signal wider than one bit at the current
+ * time. Unlike vcdSet() the change is always written.
+ */
+void vcdSetBus(uint8_t signal, uint8_t width, uint16_t value) {
+    char text[22];
+    int i;
+
+    vcdStamp();
+    text[0] = 'b';
+    for (i = 0; i < width; i++) {
+        text[1 + i] = ((value >> (width - 1 - i)) & 1) ? '1' : '0';
+    }
+    text[1 + width] = ' ';
+    text[2 + width] = '!' + signal;
+    text[3 + width] = '\n';
+    text[4 + width] = '\0';
+    vcd_sink(text);
+}
+
+/*
+ * Closes the waveform by writing the final time.
+ */
+void vcdEnd() {
+    vcd_sink("#");
+    vcdDecimal(vcd_time);
+    vcd_sink("\n");
+}
+
+#ifdef JTAG_CAPTURE
+
+// signal indices of the JTAG waveform
+#define SIG_TCK  (0)
+#define SIG_TMS  (1)
+#define SIG_TDI  (2)
+#define SIG_TDO  (3)
+#define SIG_TEST (4)
+#define SIG_RST  (5)
+
+/*
+ * Pulses TCK low then high, as clock() in jtag_fsm.c does.
+ */
+static void vcdClockTCK() {
+    vcdSet(SIG_TCK, false);
+    vcdAdvance(VCD_EDGE_CYCLES);
+    vcdSet(SIG_TCK, true);
+    vcdAdvance(VCD_EDGE_CYCLES);
+}
+
+/*
+ * Replays the TMS/TCK walk of a scan, mirroring IR_SHIFT and
+ * DR_SHIFT in jtag_fsm.c. IR bits are clocked LSB first and DR
+ * bits MSB first, tdo holds the bits in the order they left the
+ * target.
+ */
+static void vcdScan(bool ir, uint32_t input, uint32_t tdo, int bits, bool tclk) {
+    int i, bit;
+
+    vcdSet(SIG_TMS, true);
+    vcdAdvance(VCD_EDGE_CYCLES);
+    vcdClockTCK();                      // Select-DR
+    if (ir) {
+        vcdClockTCK();                  // Select-IR
+    }
+    vcdSet(SIG_TMS, false);
+    vcdAdvance(VCD_EDGE_CYCLES);
+    vcdClockTCK();                      // Capture
+    vcdClockTCK();                      // Shift
+    for (i = 0; i < bits; i++) {
+        bit = ir ? i : bits - 1 - i;
+        if (i == bits - 1) {
+            vcdSet(SIG_TMS, true);      // last bit exits the shift
+        }
+        vcdSet(SIG_TDI, (input >> bit) & 1);
+        vcdAdvance(VCD_BIT_CYCLES - 2 * VCD_EDGE_CYCLES);
+        vcdClockTCK();
+        vcdSet(SIG_TDO, (tdo >> bit) & 1);
+    }
+    vcdSet(SIG_TDI, tclk);
+    vcdAdvance(VCD_EDGE_CYCLES);
+    vcdClockTCK();                      // Update
+    vcdSet(SIG_TMS, false);
+    vcdAdvance(VCD_EDGE_CYCLES);
+    for (i = 0; i < 5; i++) {
+        vcdClockTCK();                  // IDLE
+    }
+    vcdAdvance(VCD_SCAN_GAP_CYCLES);
+}
+
+/*
+ * Replays the pass through the DR path that clocks a word into
+ * the PSA register, mirroring psaStep() in jtag_fsm.c.
+ */
+static void vcdPSA() {
+    vcdSet(SIG_TDI, true);
+    vcdSet(SIG_TMS, true);
+    vcdAdvance(VCD_EDGE_CYCLES);
+    vcdClockTCK();                      // Select-DR
+    vcdSet(SIG_TMS, false);
+    vcdClockTCK();                      // Capture
+    vcdClockTCK();                      // Shift
+    vcdSet(SIG_TMS, true);
+    vcdClockTCK();                      // Exit
+    vcdClockTCK();                      // Update
+    vcdSet(SIG_TMS, false);
+    vcdClockTCK();                      // IDLE
+    vcdSet(SIG_TDI, false);
+    vcdAdvance(VCD_SCAN_GAP_CYCLES);
+}
+
+/*
+ * Writes the capture log as a waveform of the TCK, TMS, TDI
+ * (TCLK), TDO, TEST and RST lines of the 4-wire link, timed by
+ * the MCLK cycle model in jtag_vcd.h. TEST and RST are shown high
+ * throughout, and TCLK starts at the level the log opens with.
+ * The edges are rebuilt from the scans rather than recorded, so
+ * for the exact pin sequence replay the log on a host with
+ * jtagreplay -v, which dumps the pins jtag_fsm.c really drives.
+ */
+void writeCaptureVcd(TextSink sink) {
+    static char *const names[] = {"TCK", "TMS", "TDI", "TDO", "TEST", "RST"};
+    const ScanRecord *record = getCapture();
+    uint16_t i, length = getCaptureLength();
+    uint32_t input, output, raw;
+    bool tclk = true;
+    int bit;
+
+    vcdBegin(sink, "jtag", names, NULL, 6);
+    vcdSet(SIG_TEST, true);
+    vcdSet(SIG_RST, true);
+    vcdSet(SIG_TCK, true);
+    vcdSet(SIG_TDI, tclk);
+    for (i = 0; i < length; i++, record++) {
+        input = ((uint32_t) (record->high & 0x0F) << 16) | record->input;
+        output = ((uint32_t) (record->high & 0xF0) << 12) | record->output;
+        switch (record->type) {
+        case SCAN_START:
+            tclk = (input != 0);
+            vcdSet(SIG_TDI, tclk);
+            break;
+        case SCAN_RESET:
+            tclk = true; // initFSM() leaves TCLK high
+            vcdSet(SIG_TDI, tclk);
+            vcdAdvance(VCD_SCAN_GAP_CYCLES);
+            break;
+        case SCAN_IR:
+            // IR_SHIFT stores the bit shifted out i-th at bit 7 - i
+            // and the last one at bit 0, undo that to the wire order
+            raw = 0;
+            for (bit = 0; bit < 7; bit++) {
+                raw |= ((output >> (7 - bit)) & 1) << bit;
+            }
+            raw |= (output & 1) << 7;
+            vcdScan(true, input, raw, 8, tclk);
+            break;
+        case SCAN_DR:
+            vcdScan(false, input, output, 16, tclk);
+            break;
+        case SCAN_DR20:
+            // undo the nibble swap of DR_SHIFT20
+            raw = ((output & 0xFFFF) << 4) | ((output >> 16) & 0x0F);
+            vcdScan(false, input, raw, 20, tclk);
+            break;
+        case SCAN_TCLK_SET:
+        case SCAN_TCLK_CLR:
+            tclk = (record->type == SCAN_TCLK_SET);
+            vcdSet(SIG_TDI, tclk);
+            vcdAdvance(VCD_EDGE_CYCLES + VCD_SCAN_GAP_CYCLES);
+            break;
+        case SCAN_PSA:
+            vcdPSA();
+            tclk = false;
+            break;
+        default:
+            break;
+        }
+    }
+    vcdEnd();
+}
+
+#endif
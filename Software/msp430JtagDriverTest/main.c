@@ -26,6 +26,8 @@ inline void setup() {
     usci_start();
     enable_uart_tx_interrupt();
     clear_uart_tx_interrupt_flag();
+    // free-running JTAG_TIMESTAMP() counter, see jtag_config.h
+    TA1CTL = TASSEL_2 + ID_3 + MC_2 + TACLR;
     __bis_SR_register(GIE);
 }
 
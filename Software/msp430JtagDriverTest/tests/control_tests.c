@@ -11,6 +11,11 @@
 #include "control_tests.h"
 #include "jtag_control.h"
 #include "jtag_fsm.h"
+#include "jtag_config.h"
+#include "bsl_control.h"
+#include "jtag_checkpoint.h"
+#include "jtag_analyzer.h"
+#include "jtag_eem.h"
 
 bool test_read_write() {
     const uint16_t addr1 = 0x0332; // non-flash memory
@@ -40,3 +45,323 @@ bool test_read_write() {
 
     return true;
 }
+
+bool test_read_byte() {
+    bool result = true;
+
+    initFSM();
+    getDevice();
+    haltCPU();
+    writeMem(0x0200, 0x12AB);
+
+    // both halves of a word, the odd one included
+    if (readMemByte(0x0200) != 0xAB || readMemByte(0x0201) != 0x12) {
+        result = false;
+    }
+    releaseCPU();
+
+    return result;
+}
+
+bool test_get_device() {
+    const SyncStats *stats;
+
+    initFSM();
+    clrSyncStats();
+    if (!getDevice()) {
+        return false;
+    }
+    stats = getSyncStats();
+    if (stats->syncs != 1 || stats->failures != 0) {
+        return false;
+    }
+    if (stats->last_polls == 0 || stats->last_polls > SYNC_POLLS) {
+        return false;
+    }
+
+    return true;
+}
+
+bool test_bsl_read() {
+    uint16_t password[BSL_PASSWORD_WORDS];
+    uint16_t bsl_words[8];
+    int i;
+
+    // the BSL password is the vector table, read it over JTAG
+    initFSM();
+    getDevice();
+    haltCPU();
+    for (i = 0; i < BSL_PASSWORD_WORDS; i++) {
+        password[i] = readMem(0xFFE0 + 2 * i);
+    }
+    releaseCPU();
+    releaseDevice();
+    releaseFSM();
+
+    if (!bslEnter() || !bslUnlock(password)) {
+        bslExit();
+        return false;
+    }
+    bool result = bslReadBlock(0xC000, bsl_words, 8);
+    bslExit();
+    if (!result) {
+        return false;
+    }
+
+    // both transports must agree
+    initFSM();
+    getDevice();
+    haltCPU();
+    for (i = 0; i < 8; i++) {
+        if (readMem(0xC000 + 2 * i) != bsl_words[i]) {
+            result = false;
+        }
+    }
+    releaseCPU();
+
+    return result;
+}
+
+bool test_read_reg() {
+    uint16_t pc, sp;
+    bool result = true;
+
+    initFSM();
+    getDevice();
+    haltCPU();
+    pc = readReg(0);
+    sp = readReg(1);
+
+    // reading a register must not change any of them
+    if (readReg(0) != pc || readReg(1) != sp) {
+        result = false;
+    }
+    if (pc < 0xC000 || (pc & 1) || (sp & 1)) {
+        result = false;
+    }
+    setInstrFetch();
+    haltCPU();
+    releaseCPU();
+
+    return result;
+}
+
+bool test_psa() {
+    uint16_t words[16];
+    uint16_t i, psa;
+    bool result = true;
+
+    initFSM();
+    getDevice();
+    haltCPU();
+    for (i = 0; i < 16; i++) {
+        words[i] = readMem(0xC000 + 2 * i);
+    }
+    if (!getPSA(0xC000, 16, &psa) || psa != calcPSA(0xC000, words, 16)) {
+        result = false;
+    }
+
+    // a single changed word must change the signature
+    words[7] ^= 0x0100;
+    setInstrFetch();
+    haltCPU();
+    if (!getPSA(0xC000, 16, &psa) || psa == calcPSA(0xC000, words, 16)) {
+        result = false;
+    }
+
+    // the PSA is seeded from the start address, and must still
+    // work straight after a burst read
+    setInstrFetch();
+    haltCPU();
+    readMemQuick(0xC010, words, 8);
+    setInstrFetch();
+    haltCPU();
+    if (!getPSA(0xC010, 8, &psa) || psa != calcPSA(0xC010, words, 8)) {
+        result = false;
+    }
+    setInstrFetch();
+    haltCPU();
+    releaseCPU();
+
+    return result;
+}
+
+bool test_watchpoint() {
+    // MOV #0xBEEF, &0x0210 then JMP $, run from RAM
+    const uint16_t program[] = {0x40B2, 0xBEEF, 0x0210, 0x3FFF};
+    Watchpoint watch;
+    uint16_t i, polls;
+    bool result = true;
+
+    initFSM();
+    getDevice();
+    haltCPU();
+    for (i = 0; i < 4; i++) {
+        writeMem(0x0220 + 2 * i, program[i]);
+    }
+    writeMem(0x0210, 0x0000);
+
+    watch.address = 0x0210;
+    watch.value = 0xBEEF;
+    watch.match_value = true;
+    watch.access = WATCH_WRITE;
+    clrWatchpoints();
+    if (!setWatchpoint(&watch) || isWatchpointHit()) {
+        return false;
+    }
+    if (!setInstrFetch()) {
+        return false;
+    }
+    setPC(0x0220);
+    if (!runCPU()) {
+        return false;
+    }
+    for (polls = 0; polls < 1000 && !isWatchpointHit(); polls++) {
+    }
+    if (polls == 1000) {
+        result = false;
+    }
+
+    // the CPU stops right after the MOV, on the JMP $
+    getDevice();
+    haltCPU();
+    clrWatchpoints();
+    if (readMem(0x0210) != 0xBEEF || readReg(0) != 0x0226) {
+        result = false;
+    }
+    setInstrFetch();
+    haltCPU();
+    releaseCPU();
+
+    return result;
+}
+
+bool test_xv2_halt() {
+    const uint32_t ram = 0x2400; // start of RAM on an F5529-class target
+    uint16_t words[2];
+    bool result = true;
+
+    initFSM();
+    if (!getDevice()) {
+        return false;
+    }
+    if (getJtagId() != JTAG_ID_XV2) {
+        return true; // a 1xx/2xx target, covered by the tests above
+    }
+    if (!setInstrFetch()) {
+        return false;
+    }
+    haltCPU();
+    writeMem(ram, 0xB0BA);
+    writeMem20(ram + 2, 0xCAFE);
+
+    // the 16-bit functions must reach the same words as the 20-bit ones
+    if (readMem(ram) != 0xB0BA || readMem20(ram + 2) != 0xCAFE) {
+        result = false;
+    }
+    readMemQuick20(ram, words, 2);
+    if (words[0] != 0xB0BA || words[1] != 0xCAFE) {
+        result = false;
+    }
+    releaseCPU();
+
+    // and the halt must hold across a second round
+    if (!setInstrFetch()) {
+        return false;
+    }
+    haltCPU();
+    if (readMem(ram) != 0xB0BA) {
+        result = false;
+    }
+    releaseCPU();
+
+    return result;
+}
+
+#ifdef __MSP430F5529__
+static uint16_t saved_words[CHECKPOINT_WORDS];
+
+static void saveRam(uint16_t offset, const uint16_t *words, uint16_t count) {
+    uint16_t i;
+
+    for (i = 0; i < count; i++) {
+        saved_words[offset + i] = words[i];
+    }
+}
+
+static void loadRam(uint16_t offset, uint16_t *words, uint16_t count) {
+    uint16_t i;
+
+    for (i = 0; i < count; i++) {
+        words[i] = saved_words[offset + i];
+    }
+}
+
+bool test_checkpoint() {
+    static const CheckpointStore store = {saveRam, loadRam};
+    bool result = true;
+
+    initFSM();
+    getDevice();
+    haltCPU();
+    writeMem(0x0200, 0x1234);
+    writeMem(0x03FE, 0x5678); // last word, in the final chunk
+    if (!checkpoint(&store)) {
+        return false;
+    }
+
+    // clobber the state, then roll it back
+    writeMem(0x0200, 0xDEAD);
+    writeMem(0x03FE, 0xDEAD);
+    writeReg(4, ~saved_words[4]);
+    if (!restore(&store)) {
+        return false;
+    }
+    if (readMem(0x0200) != 0x1234 || readMem(0x03FE) != 0x5678) {
+        result = false;
+    }
+    if (readReg(4) != saved_words[4] || readReg(0) != saved_words[0]) {
+        result = false;
+    }
+    setInstrFetch();
+    haltCPU();
+    releaseCPU();
+
+    return result;
+}
+#endif
+
+bool test_analyzer() {
+    static const AnalyzerChannel channels[] = {
+        {0x0020, "P1IN"},
+        {0x0028, "P2IN"},
+    };
+    const AnalyzerEvent *events;
+    bool result = true;
+
+    initFSM();
+    getDevice();
+    haltCPU();
+
+    // with the target frozen and its pins idle, each channel
+    // only logs its first value
+    if (runAnalyzer(channels, 2, 16, 0) != 16) {
+        result = false;
+    }
+    if (getAnalyzerLength() != 2) {
+        result = false;
+    }
+
+    // both first values are seen in sample 0, and the run as a
+    // whole takes time
+    events = getAnalyzerEvents();
+    if (events[0].time != events[1].time || events[1].time > getAnalyzerElapsed()) {
+        result = false;
+    }
+    if (getAnalyzerElapsed() == 0) {
+        result = false;
+    }
+    releaseCPU();
+
+    return result;
+}
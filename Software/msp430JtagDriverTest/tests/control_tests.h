@@ -10,13 +10,46 @@
 
 
 bool test_read_write();
+bool test_read_byte();
+bool test_get_device();
+bool test_bsl_read();
+bool test_read_reg();
+bool test_analyzer();
+bool test_psa();
+bool test_watchpoint();
+bool test_xv2_halt();
+#ifdef __MSP430F5529__
+bool test_checkpoint();
+#endif
 
 static bool (*test_funcs[])(void) = {
                                      test_read_write,
+                                     test_read_byte,
+                                     test_get_device,
+                                     test_bsl_read,
+                                     test_read_reg,
+                                     test_analyzer,
+                                     test_psa,
+                                     test_watchpoint,
+                                     test_xv2_halt,
+#ifdef __MSP430F5529__
+                                     test_checkpoint,
+#endif
 };
 
 static char* test_names[] = {
                              "test_read_write",
+                             "test_read_byte",
+                             "test_get_device",
+                             "test_bsl_read",
+                             "test_read_reg",
+                             "test_analyzer",
+                             "test_psa",
+                             "test_watchpoint",
+                             "test_xv2_halt",
+#ifdef __MSP430F5529__
+                             "test_checkpoint",
+#endif
 };
 
 
@@ -39,3 +39,34 @@ bool test_ir_mab(void) {
 
     return true;
 }
+
+#ifdef JTAG_CAPTURE
+bool test_capture_replay(void) {
+    // case 1: capture from before initFSM()
+    startCapture();
+    initFSM();
+    IR_SHIFT(IR_ADDR_16BIT);
+    DR_SHIFT(0xBEEF);
+    DR_SHIFT(0);
+    stopCapture();
+    if (replayCapture() != 0) {
+        return false;
+    }
+
+    // case 2: capture in the middle of a session, with TCLK low
+    initFSM();
+    IR_SHIFT(IR_ADDR_16BIT);
+    DR_SHIFT(0x1234);
+    ClrTCLK();
+    startCapture();
+    DR_SHIFT(0xC0DE);
+    SetTCLK();
+    DR_SHIFT(0x1234); // leave the MAB as the capture found it
+    stopCapture();
+    if (replayCapture() != 0) {
+        return false;
+    }
+
+    return true;
+}
+#endif
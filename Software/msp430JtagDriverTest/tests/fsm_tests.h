@@ -12,17 +12,26 @@
 bool test_ir_shift(void);
 bool test_dr_shift(void);
 bool test_ir_mab(void);
+#ifdef JTAG_CAPTURE
+bool test_capture_replay(void);
+#endif
 
 static bool (*test_funcs[])(void) = {
                                      test_ir_shift,
                                      test_dr_shift,
                                      test_ir_mab,
+#ifdef JTAG_CAPTURE
+                                     test_capture_replay,
+#endif
 };
 
 static char* test_names[] = {
                              "test_ir_shift",
                              "test_dr_shift",
                              "test_ir_mab",
+#ifdef JTAG_CAPTURE
+                             "test_capture_replay",
+#endif
 };
 
 
@@ -0,0 +1,96 @@
+/*
+ * analyzer.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Turns the log of a logic analyzer run streamed by writeAnalyzerLog(),
+ * see jtag_analyzer.h for its format, into a VCD waveform with one
+ * 8-bit signal per channel, so the debugger only has to send the
+ * changes:
+ *
+ *     analyzervcd log vcd
+ *
+ * Each change is placed at the time its sample was taken, in
+ * microseconds from the start of the run, so a run with the target
+ * frozen still shows the achieved sample rate.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "jtag_vcd.h"
+#include "jtag_analyzer.h"
+
+static FILE *vcd_file;
+
+static void vcdSink(char *text) {
+    fputs(text, vcd_file);
+}
+
+int main(int argc, char *argv[]) {
+    static const uint8_t widths[ANALYZER_CHANNELS] = {8, 8, 8, 8, 8, 8, 8, 8};
+    char names[ANALYZER_CHANNELS][64];
+    char *name_list[ANALYZER_CHANNELS];
+    char line[64];
+    unsigned int count, us, channels = 0, counts, channel, value;
+    unsigned long changes = 0, number = 0;
+    bool started = false, ended = false;
+    FILE *file;
+
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s log vcd\n", argv[0]);
+        return 2;
+    }
+    file = fopen(argv[1], "r");
+    if (file == NULL) {
+        fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 2;
+    }
+    vcd_file = fopen(argv[2], "w");
+    if (vcd_file == NULL) {
+        fprintf(stderr, "cannot write %s\n", argv[2]);
+        return 2;
+    }
+
+    while (!ended && fgets(line, sizeof(line), file) != NULL) {
+        number++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (sscanf(line, "ANALYZER %x %x", &count, &us) == 2) {
+            if (count > ANALYZER_CHANNELS) {
+                fprintf(stderr, "line %lu: too many channels\n", number);
+                return 2;
+            }
+            started = true;
+        } else if (!started) {
+            continue;
+        } else if (line[0] == 'C' && channels < count) {
+            snprintf(names[channels], sizeof(names[channels]), "%s", line + 1);
+            name_list[channels] = names[channels];
+            channels++;
+            if (channels == count) {
+                vcdBegin(vcdSink, "target", name_list, widths, count);
+            }
+        } else if (channels == count && sscanf(line, "V%x %x %x", &counts, &channel, &value) == 3) {
+            if (channel >= count) {
+                fprintf(stderr, "line %lu: unknown channel %X\n", number, channel);
+                return 2;
+            }
+            vcdAdvance((uint32_t) counts * us);
+            vcdSetBus(channel, 8, value);
+            changes++;
+        } else if (channels == count && sscanf(line, "END %x", &counts) == 1) {
+            vcdAdvance((uint32_t) counts * us);
+            vcdEnd();
+            ended = true;
+        }
+    }
+    fclose(file);
+    fclose(vcd_file);
+    if (!ended) {
+        fprintf(stderr, "%s is not a complete analyzer log\n", argv[1]);
+        return 2;
+    }
+    printf("%lu changes on %u channels\n", changes, count);
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * bench.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Wall-clock rate of the JTAG protocol core of jtag_fsm.c and
+ * jtag_control.c on the host pin backend, driving the TAP and target
+ * models of tap_model.c and target_model.c. The modelled times the
+ * tests print say how fast a scan is on the debugger, this says how
+ * fast the core and the models run here, so a change to the core's
+ * fast paths can be measured in seconds instead of by counting port
+ * accesses. Each rate is printed next to the modelled one, and a
+ * checksum of the scanned data shows that two builds agree.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+#include "jtag_host_pins.h"
+#include "target_model.h"
+#include "jtag_fsm.h"
+#include "jtag_control.h"
+#include "jtag_config.h"
+
+#define SCANS   (200000)    // IR and DR scans timed
+#define READS   (20000)     // readMem() calls timed
+#define BLOCK   (64)        // words per readMemQuick() call
+
+static uint32_t checksum;
+
+/*
+ * Returns: Wall-clock time, in seconds.
+ */
+static double getSeconds(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/*
+ * Prints the rate of count operations that took seconds of wall
+ * clock and cycles of modelled 1MHz MCLK.
+ */
+static void report(const char *name, uint32_t count, double seconds, uint32_t cycles) {
+    printf("%-17s %8.0f/s wall clock, %6.0f/s modelled\n",
+           name, count / seconds, count * 1e6 / cycles);
+}
+
+int main(void) {
+    static uint16_t words[BLOCK];
+    Cpu *cpu = getTargetCpu();
+    uint32_t i, cycles;
+    double start;
+
+    clrTap(false);
+    for (i = 0; i < 0x2000; i++) {
+        writeWord(cpu, 0xC000 + 2 * i, (uint16_t) (i * 0x9E37));
+    }
+    initFSM();
+    getDevice();
+    haltCPU();
+
+#ifdef JTAG_SBW
+    printf("Spy-Bi-Wire:\n");
+#else
+    printf("4-wire:\n");
+#endif
+    start = getSeconds();
+    cycles = getHostCycles();
+    for (i = 0; i < SCANS; i++) {
+        checksum += IR_SHIFT(IR_CNTRL_SIG_CAPTURE);
+    }
+    report("IR_SHIFT", SCANS, getSeconds() - start, getHostCycles() - cycles);
+
+    start = getSeconds();
+    cycles = getHostCycles();
+    for (i = 0; i < SCANS; i++) {
+        checksum += DR_SHIFT((uint16_t) i);
+    }
+    report("DR_SHIFT", SCANS, getSeconds() - start, getHostCycles() - cycles);
+
+    haltCPU();
+    start = getSeconds();
+    cycles = getHostCycles();
+    for (i = 0; i < READS; i++) {
+        checksum += readMem(0xC000 + 2 * (i & 0x1FFF));
+    }
+    report("readMem", READS, getSeconds() - start, getHostCycles() - cycles);
+
+    setInstrFetch();
+    haltCPU();
+    start = getSeconds();
+    cycles = getHostCycles();
+    for (i = 0; i < READS; i += BLOCK) {
+        readMemQuick(0xC000 + 2 * (i & 0x1FFF), words, BLOCK);
+        checksum += words[0] + words[BLOCK - 1];
+    }
+    report("readMemQuick word", READS, getSeconds() - start, getHostCycles() - cycles);
+
+    printf("checksum: %08X, %u model errors\n", (unsigned int) checksum, getTargetErrors());
+    return (getTargetErrors() == 0) ? 0 : 1;
+}
@@ -0,0 +1,331 @@
+/*
+ * bsl_model.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * The BSL stand-in of bsl_model.h. The receiver samples the level
+ * last written to BSLOUT in the middle of each bit, counting from
+ * the falling edge of the start bit, the way a UART does. Nothing
+ * happens between pin accesses, so bits are sampled late, when the
+ * next access shows that their time has passed. Replies start one
+ * bit after the stop bit of the last byte of a command and are sent
+ * back to back, the level of BSLIN at any time following from when
+ * the reply started.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "bsl_model.h"
+#include "bsl_control.h"
+#include "target_model.h"
+#include "jtag_config.h"
+
+#define FRAME_BITS  (11)    // start, 8 data, parity and stop bit
+#define MAX_FRAME   (8 + 2 * BSL_PASSWORD_WORDS + 2)
+#define MAX_REPLY   (4 + BSL_MAX_BLOCK + 2)
+
+static bool active;
+static bool unlocked;           // by the RX password command
+static uint8_t test_level, rst_level;
+static uint8_t test_pulses;     // TEST rising edges with RST low
+static bool rst_released;       // RST rose with TEST high after them
+static uint8_t faults;
+static BslModelStats stats;
+
+static uint8_t rx_level;        // BSLOUT as last written
+static bool rx_busy;            // inside a UART frame
+static uint32_t rx_start;       // falling edge of its start bit
+static uint8_t rx_bit;          // next bit to sample
+static uint16_t rx_frame;
+static bool synced;             // SYNC acknowledged, a frame is coming in
+static uint8_t frame[MAX_FRAME];
+static uint16_t frame_length;
+
+static uint8_t reply[MAX_REPLY];
+static uint16_t reply_length;
+static uint32_t reply_start;    // falling edge of the first start bit
+static uint8_t reply_faults;
+
+static uint8_t parityOf(uint8_t data) {
+    data ^= data >> 4;
+    data ^= data >> 2;
+    data ^= data >> 1;
+    return data & 1;
+}
+
+/*
+ * Sends bytes starting one bit after time, the middle of the stop
+ * bit that ended the command.
+ */
+static void sendReply(const uint8_t *bytes, uint16_t length, uint32_t time, uint8_t with_faults) {
+    uint16_t i;
+
+    for (i = 0; i < length; i++) {
+        reply[i] = bytes[i];
+    }
+    reply_length = length;
+    reply_start = time + BSL_BIT_CYCLES;
+    reply_faults = with_faults;
+}
+
+static void sendByte(uint8_t byte, uint32_t time) {
+    sendReply(&byte, 1, time, 0);
+}
+
+/*
+ * Sends length bytes of target memory from address in a TX data
+ * block reply.
+ */
+static void sendBlock(uint16_t address, uint8_t length, uint32_t time) {
+    uint8_t bytes[MAX_REPLY];
+    uint8_t checksum[2] = {0, 0};
+    Cpu *cpu = getTargetCpu();
+    uint16_t i;
+
+    bytes[0] = BSL_SYNC;
+    bytes[1] = 0x00;
+    bytes[2] = length;
+    bytes[3] = length;
+    for (i = 0; i < length; i++) {
+        bytes[4 + i] = cpu->memory[(uint16_t) (address + i)];
+    }
+    for (i = 0; i < 4 + length; i++) {
+        checksum[i & 1] ^= bytes[i];
+    }
+    bytes[4 + length] = ~checksum[0];
+    bytes[5 + length] = ~checksum[1];
+    if (faults & BSL_FAULT_CHECKSUM) {
+        bytes[5 + length] ^= 0x01;
+    }
+    sendReply(bytes, 6 + length, time, faults);
+}
+
+/*
+ * Carries out the command in frame, complete with its checksum.
+ */
+static void runCommand(uint32_t time) {
+    uint8_t checksum[2] = {0, 0};
+    uint16_t address = frame[4] | (frame[5] << 8);
+    uint16_t length = frame[6] | (frame[7] << 8);
+    Cpu *cpu = getTargetCpu();
+    uint16_t i;
+
+    for (i = 0; i < frame_length; i++) {
+        checksum[i & 1] ^= frame[i];
+    }
+    if (checksum[0] != 0xFF || checksum[1] != 0xFF) {
+        stats.checksum_errors++;
+        stats.naks++;
+        sendByte(BSL_NAK, time);
+        return;
+    }
+    if (frame[1] == BSL_RX_PASSWORD) {
+        for (i = 0; i < 2 * BSL_PASSWORD_WORDS; i++) {
+            if (frame[8 + i] != cpu->memory[0xFFE0 + i]) {
+                stats.naks++;
+                sendByte(BSL_NAK, time);
+                return;
+            }
+        }
+        unlocked = true;
+        sendByte(BSL_ACK, time);
+    } else if (frame[1] == BSL_TX_BLOCK && unlocked && length <= BSL_MAX_BLOCK) {
+        sendBlock(address, (uint8_t) length, time);
+    } else {
+        stats.naks++;
+        sendByte(BSL_NAK, time);
+    }
+}
+
+/*
+ * Takes in one received byte, time being the middle of its stop bit.
+ *
+ * A repeated SYNC and a frame header are the same byte, so every
+ * SYNC where a frame may start is answered. If it was the header,
+ * the ACK goes out while the debugger is still sending the frame
+ * and is never read.
+ */
+static void receiveByte(uint8_t byte, uint32_t time) {
+    if (byte == BSL_SYNC && frame_length <= 1) {
+        synced = true;
+        frame[0] = BSL_SYNC;
+        frame_length = 1;
+        sendByte(BSL_ACK, time);
+        return;
+    }
+    if (!synced) {
+        return;
+    }
+    frame[frame_length++] = byte;
+    if (frame_length >= 4 && (frame[2] != frame[3] || frame[2] + 6 > MAX_FRAME)) {
+        synced = false; // the two length fields disagree
+        frame_length = 0;
+        return;
+    }
+    if (frame_length >= 4 && frame_length == frame[2] + 6) {
+        synced = false;
+        runCommand(time);
+        frame_length = 0;
+    }
+}
+
+/*
+ * Samples the bits of the frame being received up to time, at
+ * which BSLOUT is still at rx_level.
+ */
+static void advance(uint32_t time) {
+    uint32_t sample;
+    uint8_t byte;
+
+    while (rx_busy) {
+        sample = rx_start + BSL_BIT_CYCLES / 2 + (uint32_t) rx_bit * BSL_BIT_CYCLES;
+        if (sample > time) {
+            return;
+        }
+        if (rx_bit == 0 && rx_level) {
+            rx_busy = false; // a glitch, not a start bit
+            return;
+        }
+        rx_frame |= (uint16_t) rx_level << rx_bit;
+        if (++rx_bit < FRAME_BITS) {
+            continue;
+        }
+        rx_busy = false;
+        byte = (uint8_t) (rx_frame >> 1);
+        if (!(rx_frame & BITA) || ((rx_frame >> 9) & 1) != parityOf(byte)) {
+            stats.framing_errors++;
+            synced = false;
+            frame_length = 0;
+            return;
+        }
+        stats.bytes++;
+        receiveByte(byte, sample);
+    }
+}
+
+/*
+ * Restarts the stand-in with the BSL not running and no faults.
+ */
+void clrBslModel() {
+    active = false;
+    unlocked = false;
+    test_level = 0;
+    rst_level = 0;
+    test_pulses = 0;
+    rst_released = false;
+    faults = 0;
+    stats.bytes = 0;
+    stats.framing_errors = 0;
+    stats.checksum_errors = 0;
+    stats.naks = 0;
+    rx_level = 1;
+    rx_busy = false;
+    synced = false;
+    frame_length = 0;
+    reply_length = 0;
+}
+
+/*
+ * Takes a change of a pin's level, written by the debugger at time
+ * in MCLK cycles.
+ *
+ * The BSL starts when TEST falls after RST was released with TEST
+ * high, following two TEST pulses with RST low. The JTAG entry
+ * sequence pulses TEST the same way but clocks TCK before TEST
+ * falls, which does not start the BSL.
+ */
+void bslModelPin(int pin, uint8_t level, uint32_t time) {
+    switch (pin) {
+    case RST:
+        rst_level = level;
+        if (!level) {
+            active = false;
+            test_pulses = 0;
+            rst_released = false;
+        } else if (test_level && test_pulses >= 2) {
+            rst_released = true;
+        }
+        break;
+    case TEST:
+        test_level = level;
+        if (level && !rst_level) {
+            test_pulses++;
+        } else if (!level && rst_released) {
+            rst_released = false;
+            active = true;
+            unlocked = false;
+            rx_level = 1;
+            rx_busy = false;
+            synced = false;
+            frame_length = 0;
+            reply_length = 0;
+        }
+        break;
+    case TCK:
+        rst_released = false;
+        break;
+    case BSLOUT:
+        if (!active) {
+            break;
+        }
+        advance(time);
+        if (!level && !rx_busy) {
+            rx_busy = true;
+            rx_start = time;
+            rx_bit = 0;
+            rx_frame = 0;
+        }
+        rx_level = level;
+        break;
+    default:
+        break;
+    }
+}
+
+bool isBslActive() {
+    return active;
+}
+
+/*
+ * Returns: The level of BSLIN at time in MCLK cycles.
+ */
+uint8_t bslModelRead(uint32_t time) {
+    uint32_t bit;
+    uint16_t index;
+    uint8_t byte;
+
+    advance(time);
+    if (reply_length == 0 || time < reply_start) {
+        return 1; // idle
+    }
+    bit = (time - reply_start) / BSL_BIT_CYCLES;
+    if (bit >= (uint32_t) reply_length * FRAME_BITS) {
+        return 1;
+    }
+    index = bit / FRAME_BITS;
+    byte = reply[index];
+    switch (bit % FRAME_BITS) {
+    case 0:
+        return 0;
+    case 9:
+        // the first data byte carries the framing faults
+        return parityOf(byte) ^ (index == 4 && (reply_faults & BSL_FAULT_PARITY));
+    case 10:
+        return !(index == 4 && (reply_faults & BSL_FAULT_STOP));
+    default:
+        return (byte >> (bit % FRAME_BITS - 1)) & 1;
+    }
+}
+
+/*
+ * Injects faults, a mask of the BSL_FAULT_ bits, into every TX data
+ * block reply from now on.
+ */
+void setBslFaults(uint8_t with_faults) {
+    faults = with_faults;
+}
+
+const BslModelStats *getBslModelStats() {
+    return &stats;
+}
@@ -0,0 +1,50 @@
+/*
+ * bsl_model.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * A stand-in for the ROM bootstrap loader (BSL) of the target, so
+ * that bsl_control.c can run on the host. It is entered by the TEST
+ * and RST sequence of bslEnter(), decodes the 8E1 UART frames the
+ * debugger bit bangs on BSLOUT by the MCLK time of tap_model.c and
+ * answers SYNC, RX password and TX data block commands on BSLIN
+ * from the memory of the target model. Faults can be injected into
+ * the data block replies to test the debugger's checks.
+ */
+
+#ifndef BSL_MODEL_H_
+#define BSL_MODEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*** Faults injected into every TX data block reply ***/
+#define BSL_FAULT_CHECKSUM  (0x01)  // a wrong checksum
+#define BSL_FAULT_PARITY    (0x02)  // a data byte with the wrong parity bit
+#define BSL_FAULT_STOP      (0x04)  // a data byte with a low stop bit
+
+/*
+ * What the stand-in saw of the debugger since clrBslModel().
+ */
+struct BslModelStats {
+    /* Bytes received with a valid start, parity and stop bit */
+    uint16_t bytes;
+    /* Bytes received with a bad parity or stop bit */
+    uint16_t framing_errors;
+    /* Frames received with a bad checksum */
+    uint16_t checksum_errors;
+    /* Commands answered with BSL_NAK */
+    uint16_t naks;
+};
+
+typedef struct BslModelStats BslModelStats;
+
+void clrBslModel();
+void bslModelPin(int pin, uint8_t level, uint32_t time);
+bool isBslActive();
+uint8_t bslModelRead(uint32_t time);
+void setBslFaults(uint8_t faults);
+const BslModelStats *getBslModelStats();
+
+#endif /* BSL_MODEL_H_ */
@@ -0,0 +1,76 @@
+/*
+ * host_flash.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * The flash_control.h interface on a simulated segment. Like real
+ * flash, programming a word can only clear bits and only an erase
+ * sets them again, so a caller that relies on anything else shows
+ * up in the violation count rather than as silently wrong data.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "host_flash.h"
+#include "flash_control.h"
+
+uint16_t host_flash[HOST_FLASH_WORDS];
+
+static FlashStats stats;
+static bool unlocked;
+
+static bool isInFlash(volatile uint16_t *address) {
+    return address >= host_flash && address < host_flash + HOST_FLASH_WORDS;
+}
+
+uint16_t unlockFlash() {
+    unlocked = true;
+    return 0;
+}
+
+void lockFlash(uint16_t interrupts) {
+    unlocked = false;
+}
+
+void eraseSegment(volatile uint16_t *address) {
+    int i;
+
+    if (!unlocked || !isInFlash(address)) {
+        stats.violations++;
+        return;
+    }
+    for (i = 0; i < HOST_FLASH_WORDS; i++) {
+        host_flash[i] = 0xFFFF;
+    }
+    stats.erases++;
+}
+
+void writeFlashWord(volatile uint16_t *address, uint16_t value) {
+    if (!unlocked || !isInFlash(address) || (value & ~*address)) {
+        stats.violations++;
+    }
+    if (isInFlash(address)) {
+        *address &= value;
+    }
+    stats.writes++;
+}
+
+/*
+ * Erases the segment and clears the statistics.
+ */
+void clrHostFlash() {
+    int i;
+
+    for (i = 0; i < HOST_FLASH_WORDS; i++) {
+        host_flash[i] = 0xFFFF;
+    }
+    stats.erases = 0;
+    stats.writes = 0;
+    stats.violations = 0;
+    unlocked = false;
+}
+
+const FlashStats *getFlashStats() {
+    return &stats;
+}
@@ -0,0 +1,40 @@
+/*
+ * host_flash.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * A simulated info flash segment of the debugger, standing in for
+ * flash_control.c of MSP430_JTAG_Debugger in the host build. It is
+ * included into nav_index.c on the compiler command line, which
+ * places the saved navigation index in host_flash.
+ */
+
+#ifndef HOST_FLASH_H_
+#define HOST_FLASH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HOST_FLASH_WORDS (32)   // one 64-byte info segment
+
+/*
+ * What the simulated flash has seen since clrHostFlash().
+ */
+struct FlashStats {
+    /* Segment erases */
+    uint16_t erases;
+    /* Words programmed */
+    uint16_t writes;
+    /* Writes that would set a bit, or went to locked flash */
+    uint16_t violations;
+};
+
+typedef struct FlashStats FlashStats;
+
+extern uint16_t host_flash[HOST_FLASH_WORDS];
+
+void clrHostFlash();
+const FlashStats *getFlashStats();
+
+#endif /* HOST_FLASH_H_ */
@@ -0,0 +1,127 @@
+/*
+ * jtag_host_pins.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Pin HAL of the host test build, included by jtag_config.h when
+ * JTAG_HOST is defined. The pins of jtag_fsm.c drive a software
+ * model of the target JTAG TAP in tap_model.c instead of GPIOs.
+ * Every pin write is logged into pin_trace and every clock edge
+ * the TAP sees into tap_trace, so the sequence a scan emits can be
+ * checked without a target over either transport.
+ */
+
+#ifndef JTAG_HOST_PINS_H_
+#define JTAG_HOST_PINS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "jtag_text.h"
+
+#define RST         (0)     // target reset
+#define TMS         (1)     // JTAG FSM control
+#define TCK         (2)     // JTAG clock input
+#define TDI         (3)     // JTAG data input and TCLK input
+#define TDO         (4)     // JTAG data output
+#define TEST        (5)     // JTAG enable pins
+
+/*** Bit masks, as msp430.h and the ESP-IDF provide them ***/
+#define BIT0        (0x0001)
+#define BIT1        (0x0002)
+#define BIT2        (0x0004)
+#define BIT3        (0x0008)
+#define BIT4        (0x0010)
+#define BIT5        (0x0020)
+#define BIT6        (0x0040)
+#define BIT7        (0x0080)
+#define BIT8        (0x0100)
+#define BIT9        (0x0200)
+#define BITA        (0x0400)
+#define BITB        (0x0800)
+#define BITC        (0x1000)
+#define BITD        (0x2000)
+#define BITE        (0x4000)
+#define BITF        (0x8000)
+
+#define PIN_TRACE_DEPTH (1024)
+#define TAP_TRACE_DEPTH (1024)
+
+/*
+ * One logged pin write.
+ */
+struct PinEdge {
+    /* One of the pins above */
+    uint8_t pin;
+    /* The level written */
+    uint8_t level;
+};
+
+typedef struct PinEdge PinEdge;
+
+/*
+ * The TMS and TDI levels the TAP saw at one rising edge of its
+ * clock, TCK over 4-wire or the TDI slot over Spy-Bi-Wire.
+ */
+struct TapEdge {
+    uint8_t tms;
+    uint8_t tdi;
+};
+
+typedef struct TapEdge TapEdge;
+
+/*
+ * What the Spy-Bi-Wire decoder saw since clrTap(), in MCLK cycles
+ * where it is a time.
+ */
+struct SbwStats {
+    /* The longest SBWTCK low phase */
+    uint32_t longest_low;
+    /* Low phases longer than SBW_LOW_MAX_US */
+    uint16_t long_lows;
+    /* TDO slots where the debugger still drove SBWTDIO */
+    uint16_t contentions;
+    /* Times SBWTCK stayed low long enough to leave Spy-Bi-Wire */
+    uint16_t dropouts;
+};
+
+typedef struct SbwStats SbwStats;
+
+/*
+ * States of the IEEE 1149.1 TAP controller.
+ */
+typedef enum {
+    TAP_RESET, TAP_IDLE,
+    TAP_SELECT_DR, TAP_CAPTURE_DR, TAP_SHIFT_DR, TAP_EXIT1_DR,
+    TAP_PAUSE_DR, TAP_EXIT2_DR, TAP_UPDATE_DR,
+    TAP_SELECT_IR, TAP_CAPTURE_IR, TAP_SHIFT_IR, TAP_EXIT1_IR,
+    TAP_PAUSE_IR, TAP_EXIT2_IR, TAP_UPDATE_IR
+} TapState;
+
+extern PinEdge pin_trace[PIN_TRACE_DEPTH];
+extern uint16_t pin_trace_length;
+extern TapEdge tap_trace[TAP_TRACE_DEPTH];
+extern uint16_t tap_trace_length;
+
+void pinHigh(int pin);
+void pinLow(int pin);
+uint32_t pinRead(int pin);
+uint32_t pinDriven(int pin);
+void pinInput(int pin);
+void pinOutput(int pin);
+void hostClaimPins();
+void hostClaimSbwPins();
+void hostClaimBslPins();
+void hostDelay(uint16_t n);
+uint16_t hostTimestamp();
+uint32_t getHostCycles();
+
+void clrTap(bool xv2);
+TapState getTapState();
+uint8_t getTapInstruction();
+uint32_t getTclkEdges();
+const SbwStats *getSbwStats();
+void startPinVcd(TextSink sink);
+void stopPinVcd();
+
+#endif /* JTAG_HOST_PINS_H_ */
@@ -0,0 +1,927 @@
+/*
+ * main.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Runs the JTAG FSM tests of msp430JtagDriverTest on a Linux host,
+ * against the TAP model of tap_model.c, followed by checks of the
+ * TAP clock edges each scan emits, of debugger sequences and the
+ * navigation index run against the target model of target_model.c
+ * and of BSL reads against the stand-in of bsl_model.c. Prints one
+ * line per test, the modelled time of each kind of scan, the memory
+ * reads taken by UP presses on the navigation index and the
+ * throughput of the BSL against JTAG, and exits non-zero if any
+ * test failed.
+ *
+ * Built with JTAG_CAPTURE and given a path, it also records a short
+ * session and writes its capture log there for jtagreplay. Given
+ * -a and a path, it writes the log of a logic analyzer run there
+ * for analyzervcd:
+ *
+ *     jtaghost [-a analyzer log] [capture]
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "jtag_host_pins.h"
+#include "target_model.h"
+#include "jtag_fsm.h"
+#include "jtag_control.h"
+#include "nav_index.h"
+#include "bsl_control.h"
+#include "bsl_model.h"
+#include "host_flash.h"
+#include "jtag_capture.h"
+#include "jtag_eem.h"
+#include "jtag_analyzer.h"
+#include "jtag_config.h"
+#include "fsm_tests.h"
+
+/*
+ * Rising TAP clock edges a scan ends with in Run-Test/Idle, which
+ * the 4-wire transport adds after every scan and Spy-Bi-Wire does
+ * not.
+ */
+#ifdef JTAG_SBW
+#define IDLE_EDGES (0)
+#else
+#define IDLE_EDGES (4)
+#endif
+
+/*
+ * TAP clock edges taken by a TCLK edge, a Run-Test/Idle cycle over
+ * Spy-Bi-Wire and just a write of TDI over 4-wire.
+ */
+#ifdef JTAG_SBW
+#define TCLK_EDGES (1)
+#else
+#define TCLK_EDGES (0)
+#endif
+
+/*
+ * Walks the logged TAP clock edges from start and checks TMS at
+ * every edge against tms, and TDI against tdi at the edges where
+ * tdi is not negative.
+ *
+ * Returns: The number of edges, or -1 on a mismatch.
+ */
+static int checkEdges(uint16_t start, const uint8_t *tms, const int8_t *tdi, int edges) {
+    uint16_t i;
+
+    if (tap_trace_length - start != edges) {
+        return -1;
+    }
+    for (i = start; i < tap_trace_length; i++) {
+        if (tap_trace[i].tms != tms[i - start]) {
+            return -1;
+        }
+        if (tdi[i - start] >= 0 && tap_trace[i].tdi != tdi[i - start]) {
+            return -1;
+        }
+    }
+    return edges;
+}
+
+bool test_dr_edges(void) {
+    // TMS at each of the 21 TAP clock edges of a DR_SHIFT, and the idle ones
+    const uint8_t tms[21 + IDLE_EDGES] = {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                          1, 1, 0};
+    const uint16_t data = 0xA5A5;
+    int8_t tdi[21 + IDLE_EDGES];
+    uint16_t start;
+    int i;
+
+    // data bits are clocked in at edges 3 to 18, MSB first
+    for (i = 0; i < 21 + IDLE_EDGES; i++) {
+        tdi[i] = (i >= 3 && i < 19) ? (data >> (18 - i)) & 1 : -1;
+    }
+    clrTap(false);
+    initFSM();
+    ClrTCLK();
+    start = tap_trace_length;
+    DR_SHIFT(data);
+    if (checkEdges(start, tms, tdi, 21 + IDLE_EDGES) < 0) {
+        return false;
+    }
+
+    // TCLK is left where it was, in Run-Test/Idle
+    return getTapState() == TAP_IDLE && !getTCLK();
+}
+
+bool test_ir_edges(void) {
+    // TMS at each of the 14 TAP clock edges of an IR_SHIFT, and the idle ones
+    const uint8_t tms[14 + IDLE_EDGES] = {1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0};
+    int8_t tdi[14 + IDLE_EDGES];
+    uint16_t start;
+    int i;
+
+    // instruction bits are clocked in at edges 4 to 11, LSB first
+    for (i = 0; i < 14 + IDLE_EDGES; i++) {
+        tdi[i] = (i >= 4 && i < 12) ? (IR_ADDR_16BIT >> (i - 4)) & 1 : -1;
+    }
+    clrTap(false);
+    initFSM();
+    start = tap_trace_length;
+    IR_SHIFT(IR_ADDR_16BIT);
+    if (checkEdges(start, tms, tdi, 14 + IDLE_EDGES) < 0) {
+        return false;
+    }
+    return getTapState() == TAP_IDLE && getTapInstruction() == IR_ADDR_16BIT && getTCLK();
+}
+
+bool test_tclk_edges(void) {
+    uint16_t start, i;
+    uint32_t edges;
+
+    // TCLK is TDI in Run-Test/Idle, it must not move the TAP
+    clrTap(false);
+    initFSM();
+    start = tap_trace_length;
+    edges = getTclkEdges();
+    ClrTCLK();
+    SetTCLK();
+    if (getTclkEdges() - edges != 2 || tap_trace_length - start != 2 * TCLK_EDGES) {
+        return false;
+    }
+    for (i = start; i < tap_trace_length; i++) {
+        if (tap_trace[i].tms) {
+            return false;
+        }
+    }
+
+    // nor may a scan clock the target, whatever bits it shifts
+    IR_SHIFT(IR_BYPASS);
+    DR_SHIFT(0);
+    ClrTCLK();
+    IR_SHIFT(IR_BYPASS);
+    DR_SHIFT(1);
+    return getTclkEdges() - edges == 3 && !getTCLK() && getTapState() == TAP_IDLE;
+}
+
+bool test_dr_shift20(void) {
+    // the 20-bit MAB of an Xv2 target, bits 19-16 swapped back in place
+    clrTap(true);
+    initFSM();
+    if (IR_SHIFT(IR_ADDR_16BIT) != JTAG_ID_XV2) {
+        return false;
+    }
+    DR_SHIFT20(0xABCDE);
+    if (getTargetMab() != 0xABCDE) {
+        return false;
+    }
+    return DR_SHIFT20(0) == 0xABCDE;
+}
+
+bool test_flash_signature(void) {
+    static uint16_t words[NAV_BLOCKS * NAV_BLOCK_WORDS];
+    Cpu *cpu = getTargetCpu();
+    uint16_t signature;
+    uint16_t i;
+
+    // a target halted mid-program, flash full of distinct words
+    for (i = 0; i < NAV_BLOCKS * NAV_BLOCK_WORDS; i++) {
+        words[i] = 0x4303 ^ (i * 0x9E37);
+        writeWord(cpu, NAV_START + 2 * i, words[i]);
+    }
+    initFSM();
+    if (!getDevice() || !setInstrFetch()) {
+        return false;
+    }
+    setPC(0xD00A);
+    haltCPU();
+    if (!getFlashSignature(&signature)
+            || signature != calcPSA(NAV_START, words, NAV_BLOCKS * NAV_BLOCK_WORDS)) {
+        return false;
+    }
+
+    // getPSA() runs the PC off the end of flash, it must be put back
+    return readReg(0) == 0xD00A && getTargetErrors() == 0;
+}
+
+#define NAV_WORDS (NAV_BLOCKS * NAV_BLOCK_WORDS)
+
+static bool nav_boundary[NAV_WORDS];   // instruction starts on the walk from NAV_START
+static uint16_t nav_last;               // the last of them
+
+/*
+ * Fills the flash covered by the navigation index with a fixed mix
+ * of one, two and three word instructions and marks where each one
+ * starts, as a linear walk from NAV_START finds them.
+ */
+static void fillNavFlash(void) {
+    Cpu *cpu = getTargetCpu();
+    uint32_t seed = 1;
+    uint16_t word = 0;
+    int length;
+
+    for (word = 0; word < NAV_WORDS; word++) {
+        nav_boundary[word] = false;
+    }
+    word = 0;
+    while (word < NAV_WORDS) {
+        seed = seed * 1103515245 + 12345;
+        length = 1 + (seed >> 16) % 3;
+        if (word + length > NAV_WORDS) {
+            length = 1;
+        }
+        nav_boundary[word] = true;
+        nav_last = NAV_START + 2 * word;
+        // NOP, MOV #imm, R5 and MOV #imm, &addr
+        writeWord(cpu, nav_last, (length == 1) ? 0x4303 : (length == 2) ? 0x4035 : 0x40B2);
+        if (length > 1) {
+            writeWord(cpu, nav_last + 2, (uint16_t) seed);
+        }
+        if (length > 2) {
+            writeWord(cpu, nav_last + 4, 0x0200);
+        }
+        word += length;
+    }
+    initFSM();
+    getDevice();
+    haltCPU();
+}
+
+/*
+ * Returns: The instruction before address on the linear walk.
+ */
+static uint16_t linearPrev(uint16_t address) {
+    uint16_t word = (address - NAV_START) >> 1;
+
+    if (address <= NAV_START) {
+        return NAV_START;
+    }
+    do {
+        word--;
+    } while (!nav_boundary[word]);
+    return NAV_START + 2 * word;
+}
+
+bool test_prev_instruction(void) {
+    uint32_t seed = 7, reads;
+    uint16_t address, word;
+    int i;
+
+    // from any instruction, cold or with the index partly built,
+    // the index must agree with a linear walk
+    fillNavFlash();
+    clrNavIndex();
+    for (i = 0; i < 200; i++) {
+        seed = seed * 1103515245 + 12345;
+        word = (seed >> 8) % NAV_WORDS;
+        while (!nav_boundary[word]) {
+            word--;
+        }
+        address = NAV_START + 2 * word;
+        if (prevInstruction(address) != linearPrev(address)) {
+            return false;
+        }
+    }
+
+    // scrolling up from the end, each press decodes at most about a
+    // block once the index is complete
+    address = nav_last;
+    for (i = 0; i < 300; i++) {
+        reads = getTargetReads();
+        if (prevInstruction(address) != linearPrev(address)) {
+            return false;
+        }
+        if (i > 0 && getTargetReads() - reads > NAV_BLOCK_WORDS + 3) {
+            return false;
+        }
+        address = linearPrev(address);
+    }
+    return prevInstruction(NAV_START) == NAV_START && getTargetErrors() == 0;
+}
+
+bool test_nav_save(void) {
+    const FlashStats *stats = getFlashStats();
+    uint32_t reads;
+
+    fillNavFlash();
+    clrHostFlash();
+    if (loadNavIndex(0x1234)) {
+        return false;
+    }
+
+    // the first save erases the segment, the second only adds
+    // checkpoints by clearing bits
+    prevInstruction(NAV_START + 8 * (NAV_BLOCK_WORDS << 1));
+    saveNavIndex();
+    if (stats->erases != 1) {
+        return false;
+    }
+    prevInstruction(nav_last);
+    saveNavIndex();
+    if (stats->erases != 1 || stats->violations != 0) {
+        return false;
+    }
+
+    // after a reboot the saved index makes the first press cheap
+    clrNavIndex();
+    if (!loadNavIndex(0x1234)) {
+        return false;
+    }
+    reads = getTargetReads();
+    if (prevInstruction(nav_last) != linearPrev(nav_last)
+            || getTargetReads() - reads > NAV_BLOCK_WORDS + 3) {
+        return false;
+    }
+
+    // another target flash starts over and replaces the record
+    if (loadNavIndex(0x5678)) {
+        return false;
+    }
+    prevInstruction(nav_last);
+    saveNavIndex();
+    clrNavIndex();
+    return stats->erases == 2 && stats->violations == 0
+            && loadNavIndex(0x5678) && !loadNavIndex(0x1234);
+}
+
+/*
+ * Runs a program that writes 0x1234 to 0x0200, reads it into R5,
+ * writes 0x5678 and reads that into R6, with the given watchpoints
+ * set, until one stops it.
+ *
+ * Returns: The PC the target stopped at, or 0 if it did not stop.
+ */
+static uint16_t runWatched(const Watchpoint *watches, int count) {
+    static const uint16_t program[] = {
+        0x40B2, 0x1234, 0x0200,     // C000: MOV #0x1234, &0x0200
+        0x4215, 0x0200,             // C006: MOV &0x0200, R5
+        0x40B2, 0x5678, 0x0200,     // C00A: MOV #0x5678, &0x0200
+        0x4216, 0x0200,             // C010: MOV &0x0200, R6
+        0x3FFF,                     // C014: JMP $
+    };
+    Cpu *cpu = getTargetCpu();
+    int i, polls;
+
+    for (i = 0; i < sizeof(program) / sizeof(program[0]); i++) {
+        writeWord(cpu, 0xC000 + 2 * i, program[i]);
+    }
+    initFSM();
+    if (!getDevice() || !setInstrFetch()) {
+        return 0;
+    }
+    setPC(0xC000);
+    haltCPU();
+    clrWatchpoints();
+    for (i = 0; i < count; i++) {
+        if (!setWatchpoint(&watches[i])) {
+            return 0;
+        }
+    }
+    if (!runCPU()) {
+        return 0;
+    }
+    for (polls = 0; !isWatchpointHit(); polls++) {
+        if (polls == 10) {
+            return 0;
+        }
+    }
+    if (!getDevice() || !setInstrFetch()) {
+        return 0;
+    }
+    return readReg(0);
+}
+
+bool test_watch_address(void) {
+    Watchpoint watch = {0x0200, 0, false, WATCH_WRITE};
+
+    // the first write stops the CPU before R5 is loaded
+    return runWatched(&watch, 1) == 0xC006 && readReg(5) == 0;
+}
+
+bool test_watch_value(void) {
+    Watchpoint watch = {0x0200, 0x5678, true, WATCH_WRITE};
+
+    // only the write of 0x5678 matches, after the first read
+    return runWatched(&watch, 1) == 0xC010 && readReg(5) == 0x1234 && readReg(6) == 0;
+}
+
+bool test_watch_access(void) {
+    Watchpoint read = {0x0200, 0x5678, true, WATCH_READ};
+    Watchpoint both = {0x0200, 0x1234, true, WATCH_READ | WATCH_WRITE};
+
+    // a read watchpoint passes over the writes of its value
+    if (runWatched(&read, 1) != 0xC014 || readReg(6) != 0x5678) {
+        return false;
+    }
+    clrTap(false);
+    return runWatched(&both, 1) == 0xC006;
+}
+
+bool test_watch_budget(void) {
+    Watchpoint value = {0x0200, 0x1234, true, WATCH_WRITE};
+    Watchpoint unused = {0x0202, 0, false, WATCH_WRITE};
+    Watchpoint read = {0x0200, 0, false, WATCH_READ};
+    Watchpoint both[] = {unused, read};
+
+    initFSM();
+    if (!getDevice()) {
+        return false;
+    }
+    haltCPU();
+    // a value takes both triggers, leaving none
+    clrWatchpoints();
+    if (!setWatchpoint(&value) || setWatchpoint(&unused)) {
+        return false;
+    }
+    clrWatchpoints();
+    if (!setWatchpoint(&unused) || !setWatchpoint(&read) || setWatchpoint(&unused)) {
+        return false;
+    }
+
+    // the second of two watchpoints gets the second trigger
+    clrTap(false);
+    return runWatched(both, 2) == 0xC00A;
+}
+
+static char vcd_text[16384];
+static uint16_t vcd_length;
+
+static void vcdBuffer(char *text) {
+    while (*text != '\0' && vcd_length < sizeof(vcd_text) - 1) {
+        vcd_text[vcd_length++] = *text++;
+    }
+    vcd_text[vcd_length] = '\0';
+}
+
+bool test_pin_vcd(void) {
+#ifdef JTAG_SBW
+    char rise[] = {'\n', '1', '!' + SBWTCK, '\n', '\0'};
+    int clock = SBWTCK, writes = 3; // SBWTCK cycles per TAP clock edge
+#else
+    char rise[] = {'\n', '1', '!' + TCK, '\n', '\0'};
+    int clock = TCK, writes = 1;
+#endif
+    char end[16];
+    uint16_t start;
+    uint32_t cycles;
+    char *next;
+    int rises;
+
+    // the waveform must hold every clock edge the TAP saw and end
+    // at the modelled time the scan took
+    initFSM();
+    vcd_length = 0;
+    start = tap_trace_length;
+    cycles = getHostCycles();
+    rises = -(int) pinDriven(clock); // the waveform opens with it at 0
+    startPinVcd(vcdBuffer);
+    IR_SHIFT(IR_CNTRL_SIG_CAPTURE);
+    stopPinVcd();
+    for (next = strstr(vcd_text, rise); next != NULL; next = strstr(next + 1, rise)) {
+        rises++;
+    }
+    snprintf(end, sizeof(end), "\n#%lu\n", (unsigned long) (getHostCycles() - cycles));
+    return rises == writes * (tap_trace_length - start)
+            && strcmp(vcd_text + vcd_length - strlen(end), end) == 0;
+}
+
+static const AnalyzerChannel analyzer_channels[] = {
+    {0x0200, "low"},
+    {0x0201, "high"},
+};
+
+/*
+ * Runs the analyzer on the frozen target model over two bytes of
+ * RAM, which it logs once each at the first sample.
+ */
+static uint16_t runFrozenAnalyzer(void) {
+    initFSM();
+    getDevice();
+    haltCPU();
+    writeMem(0x0200, 0x1234);
+    return runAnalyzer(analyzer_channels, 2, 16, 0);
+}
+
+bool test_analyzer_log(void) {
+    static const char expected[] = "ANALYZER 2 1\nClow\nChigh\nV0 0 34\nV0 1 12\nEND ";
+
+    if (runFrozenAnalyzer() != 16 || getAnalyzerLength() != 2) {
+        return false;
+    }
+    // both changes at the first sample, then the rest of the run
+    vcd_length = 0;
+    writeAnalyzerLog(vcdBuffer);
+    if (strncmp(vcd_text, expected, sizeof(expected) - 1) != 0) {
+        return false;
+    }
+    return vcd_text[vcd_length - 1] == '\n';
+}
+
+#ifdef JTAG_SBW
+bool test_sbw_slots(void) {
+    const SbwStats *stats = getSbwStats();
+
+    // through a session's worth of scans the debugger must never
+    // fight the target over SBWTDIO, nor leave SBWTCK low for long
+    // enough to drop out of Spy-Bi-Wire
+    writeWord(getTargetCpu(), 0xC000, 0x4031);
+    initFSM();
+    if (!getDevice() || !setInstrFetch()) {
+        return false;
+    }
+    haltCPU();
+    if (readMem(0xC000) != 0x4031 || readReg(0) != 0) {
+        return false;
+    }
+    return stats->contentions == 0 && stats->dropouts == 0;
+}
+#endif
+
+#ifndef JTAG_SBW
+#define BSL_WORDS (BSL_MAX_BLOCK) // two data block commands
+
+/*
+ * Fills the target memory read by the BSL tests, BSL_WORDS words
+ * from 0xC000 and the vector table, the BSL password, and copies
+ * the password into password.
+ */
+static void fillBslMemory(uint16_t *password) {
+    Cpu *cpu = getTargetCpu();
+    uint16_t i;
+
+    for (i = 0; i < BSL_WORDS; i++) {
+        writeWord(cpu, 0xC000 + 2 * i, 0x4303 ^ (i * 0x9E37));
+    }
+    for (i = 0; i < BSL_PASSWORD_WORDS; i++) {
+        password[i] = 0xC000 + 2 * i;
+        writeWord(cpu, 0xFFE0 + 2 * i, password[i]);
+    }
+}
+
+/*
+ * Enters and unlocks the BSL, then reads the words of fillBslMemory()
+ * with faults injected into the replies.
+ *
+ * Returns: True if the read succeeded.
+ */
+static bool readWithFaults(uint8_t faults, uint16_t *words) {
+    uint16_t password[BSL_PASSWORD_WORDS];
+    bool result;
+
+    fillBslMemory(password);
+    if (!bslEnter() || !bslUnlock(password)) {
+        return false;
+    }
+    setBslFaults(faults);
+    result = bslReadBlock(0xC000, words, BSL_WORDS);
+    bslExit();
+    return result;
+}
+
+bool test_bsl_read(void) {
+    static uint16_t words[BSL_WORDS];
+    const BslModelStats *stats = getBslModelStats();
+    Cpu *cpu = getTargetCpu();
+    uint16_t i;
+
+    if (!readWithFaults(0, words)) {
+        return false;
+    }
+    for (i = 0; i < BSL_WORDS; i++) {
+        if (words[i] != readWord(cpu, 0xC000 + 2 * i)) {
+            return false;
+        }
+    }
+    // every byte the debugger sent must have been well framed, and
+    // 8E1 at BSL_BAUD caps the rate at BSL_BAUD / 11 bytes per second
+    if (stats->framing_errors != 0 || stats->checksum_errors != 0 || stats->naks != 0) {
+        return false;
+    }
+    if (bslBytesPerSecond() == 0 || bslBytesPerSecond() > BSL_BAUD / 11) {
+        return false;
+    }
+
+    // JTAG must take over again after the BSL and agree with it
+    initFSM();
+    if (!getDevice()) {
+        return false;
+    }
+    haltCPU();
+    return readMem(0xC000) == words[0] && readMem(0xC000 + 2 * (BSL_WORDS - 1)) == words[BSL_WORDS - 1];
+}
+
+bool test_bsl_password(void) {
+    uint16_t password[BSL_PASSWORD_WORDS];
+    uint16_t word;
+
+    fillBslMemory(password);
+    password[BSL_PASSWORD_WORDS - 1] ^= 0x0100;
+    if (!bslEnter() || bslUnlock(password)) {
+        return false;
+    }
+    // a locked BSL must not hand out memory either
+    if (bslReadBlock(0xC000, &word, 1)) {
+        return false;
+    }
+    bslExit();
+    return getBslModelStats()->naks == 2;
+}
+
+bool test_bsl_checksum(void) {
+    static uint16_t words[BSL_WORDS];
+
+    return !readWithFaults(BSL_FAULT_CHECKSUM, words);
+}
+
+bool test_bsl_framing(void) {
+    static uint16_t words[BSL_WORDS];
+
+    if (readWithFaults(BSL_FAULT_PARITY, words)) {
+        return false;
+    }
+    return !readWithFaults(BSL_FAULT_STOP, words);
+}
+#endif
+
+static bool (*host_test_funcs[])(void) = {
+                                          test_dr_edges,
+                                          test_ir_edges,
+                                          test_tclk_edges,
+                                          test_dr_shift20,
+                                          test_flash_signature,
+                                          test_prev_instruction,
+                                          test_nav_save,
+                                          test_pin_vcd,
+                                          test_watch_address,
+                                          test_watch_value,
+                                          test_watch_access,
+                                          test_watch_budget,
+                                          test_analyzer_log,
+#ifdef JTAG_SBW
+                                          test_sbw_slots,
+#else
+                                          test_bsl_read,
+                                          test_bsl_password,
+                                          test_bsl_checksum,
+                                          test_bsl_framing,
+#endif
+};
+
+static char* host_test_names[] = {
+                                  "test_dr_edges",
+                                  "test_ir_edges",
+                                  "test_tclk_edges",
+                                  "test_dr_shift20",
+                                  "test_flash_signature",
+                                  "test_prev_instruction",
+                                  "test_nav_save",
+                                  "test_pin_vcd",
+                                  "test_watch_address",
+                                  "test_watch_value",
+                                  "test_watch_access",
+                                  "test_watch_budget",
+                                  "test_analyzer_log",
+#ifdef JTAG_SBW
+                                  "test_sbw_slots",
+#else
+                                  "test_bsl_read",
+                                  "test_bsl_password",
+                                  "test_bsl_checksum",
+                                  "test_bsl_framing",
+#endif
+};
+
+static int run_tests(bool (*funcs[])(void), char* names[], unsigned int num_tests) {
+    unsigned int i;
+    int failures = 0;
+
+    for (i = 0; i < num_tests; i++) {
+        clrTap(false);
+        if (funcs[i]()) {
+            printf("%s passed.\n", names[i]);
+        } else {
+            printf("%s failed.\n", names[i]);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+/*
+ * Prints the modelled time of each kind of scan and of reading a
+ * word, in cycles of the 1MHz MCLK, ie microseconds, for comparing
+ * the transports. Only port accesses are counted, see tap_model.c.
+ */
+static void reportTiming(void) {
+    uint16_t words[64];
+    uint32_t start, ir, dr, tclk, mem, quick;
+
+    clrTap(false);
+    initFSM();
+    getDevice();
+    haltCPU();
+    start = getHostCycles();
+    IR_SHIFT(IR_CNTRL_SIG_CAPTURE);
+    ir = getHostCycles() - start;
+    start = getHostCycles();
+    DR_SHIFT(0);
+    dr = getHostCycles() - start;
+    start = getHostCycles();
+    ClrTCLK();
+    SetTCLK();
+    tclk = (getHostCycles() - start) / 2;
+    start = getHostCycles();
+    readMem(0xC000);
+    mem = getHostCycles() - start;
+    setInstrFetch();
+    haltCPU();
+    start = getHostCycles();
+    readMemQuick(0xC000, words, 64);
+    quick = (getHostCycles() - start) / 64;
+
+#ifdef JTAG_SBW
+    printf("Spy-Bi-Wire:");
+#else
+    printf("4-wire:");
+#endif
+    printf(" IR_SHIFT %lu us, DR_SHIFT %lu us, TCLK edge %lu us, readMem %lu us,"
+           " readMemQuick %lu us/word, %lu DR scans/s\n",
+           (unsigned long) ir, (unsigned long) dr, (unsigned long) tclk,
+           (unsigned long) mem, (unsigned long) quick, 1000000UL / dr);
+#ifdef JTAG_SBW
+    printf("Spy-Bi-Wire: longest SBWTCK low phase %lu us, %u over %u us\n",
+           (unsigned long) getSbwStats()->longest_low, getSbwStats()->long_lows, SBW_LOW_MAX_US);
+#endif
+}
+
+/*
+ * Prints the memory reads taken by UP presses scrolling from the end
+ * of the flash covered by the navigation index to its start, with
+ * the index empty at the first press, against re-decoding from
+ * NAV_START, three reads per instruction, on every press. The index
+ * is saved after every press, as the debugger does when it goes
+ * idle, and the flash erases and writes that took are printed with
+ * the reads of the first press after a reboot.
+ */
+static void reportNav(void) {
+    const FlashStats *stats = getFlashStats();
+    uint32_t reads, first, total = 0, most = 0, linear;
+    uint16_t address, presses = 0;
+
+    clrTap(false);
+    fillNavFlash();
+    clrHostFlash();
+    loadNavIndex(0x1234);
+    address = nav_last;
+    reads = getTargetReads();
+    address = prevInstruction(address);
+    first = getTargetReads() - reads;
+    saveNavIndex();
+    while (address > NAV_START) {
+        reads = getTargetReads();
+        address = prevInstruction(address);
+        reads = getTargetReads() - reads;
+        total += reads;
+        most = (reads > most) ? reads : most;
+        presses++;
+        saveNavIndex();
+    }
+    // the press landing on the n-th instruction would re-decode n + 1
+    linear = 3 * ((uint32_t) presses + 2) / 2;
+
+    printf("nav: first UP %lu reads, then %lu on average and %lu at most over %u presses,"
+           " %lu on average re-decoding from %04X\n",
+           (unsigned long) first, (unsigned long) (total / presses), (unsigned long) most,
+           presses, (unsigned long) linear, NAV_START);
+
+    clrNavIndex();
+    loadNavIndex(0x1234);
+    reads = getTargetReads();
+    prevInstruction(nav_last);
+    printf("nav: saving after every press took %u erases and %u writes,"
+           " first UP after a reboot %lu reads\n",
+           stats->erases, stats->writes, (unsigned long) (getTargetReads() - reads));
+}
+
+#ifndef JTAG_SBW
+/*
+ * Prints the throughput of reading memory through the BSL and
+ * through JTAG with readMem() and readMemQuick(), each timed with
+ * JTAG_TIMESTAMP() in modelled time. The 16-bit timestamp wraps
+ * every 65ms here, so the JTAG reads are timed a word or a short
+ * block at a time.
+ */
+static void reportBsl(void) {
+    static uint16_t words[BSL_WORDS];
+    uint32_t mem = 0, quick = 0;
+    uint16_t stamp;
+    uint16_t i;
+
+    clrTap(false);
+    readWithFaults(0, words);
+    initFSM();
+    getDevice();
+    haltCPU();
+    for (i = 0; i < BSL_WORDS; i++) {
+        stamp = JTAG_TIMESTAMP();
+        readMem(0xC000 + 2 * i);
+        mem += (uint16_t) (JTAG_TIMESTAMP() - stamp);
+    }
+    setInstrFetch();
+    haltCPU();
+    for (i = 0; i < BSL_WORDS; i += 25) {
+        stamp = JTAG_TIMESTAMP();
+        readMemQuick(0xC000 + 2 * i, words, 25);
+        quick += (uint16_t) (JTAG_TIMESTAMP() - stamp);
+    }
+
+    printf("4-wire: BSL %u bytes/s, readMem %lu bytes/s, readMemQuick %lu bytes/s\n",
+           bslBytesPerSecond(),
+           2000000UL * BSL_WORDS / (mem * JTAG_TIMESTAMP_US),
+           2000000UL * BSL_WORDS / (quick * JTAG_TIMESTAMP_US));
+}
+#endif
+
+static FILE *capture_file;
+
+static void fileSink(char *text) {
+    fputs(text, capture_file);
+}
+
+/*
+ * Runs the analyzer over two bytes of RAM and writes its log to path.
+ *
+ * Returns: False if path could not be written.
+ */
+static bool writeAnalyzerFile(const char *path) {
+    clrTap(false);
+    runFrozenAnalyzer();
+    capture_file = fopen(path, "w");
+    if (capture_file == NULL) {
+        return false;
+    }
+    writeAnalyzerLog(fileSink);
+    return fclose(capture_file) == 0;
+}
+
+#ifdef JTAG_CAPTURE
+
+/*
+ * Records a session of memory writes and reads and writes its
+ * capture log to path.
+ *
+ * Returns: False if path could not be written.
+ */
+static bool writeCaptureFile(const char *path) {
+    clrTap(false);
+    startCapture();
+    initFSM();
+    getDevice();
+    haltCPU();
+    writeMem(0x0200, 0x1234);
+    writeMem(0x0202, 0xABCD);
+    readMem(0x0200);
+    readMem(0x0202);
+    stopCapture();
+
+    capture_file = fopen(path, "w");
+    if (capture_file == NULL) {
+        return false;
+    }
+    writeCapture(fileSink);
+    return fclose(capture_file) == 0;
+}
+#endif
+
+int main(int argc, char *argv[]) {
+    const char *analyzer = NULL;
+    int failures, option;
+
+    while ((option = getopt(argc, argv, "a:")) != -1) {
+        switch (option) {
+        case 'a':
+            analyzer = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-a analyzer log] [capture]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    failures = run_tests(test_funcs, test_names, sizeof(test_names)/sizeof(char*));
+    failures += run_tests(host_test_funcs, host_test_names, sizeof(host_test_names)/sizeof(char*));
+    reportTiming();
+    reportNav();
+#ifndef JTAG_SBW
+    reportBsl();
+#endif
+    if (analyzer != NULL && !writeAnalyzerFile(analyzer)) {
+        printf("cannot write %s\n", analyzer);
+        failures++;
+    }
+#ifdef JTAG_CAPTURE
+    if (optind < argc && !writeCaptureFile(argv[optind])) {
+        printf("cannot write %s\n", argv[optind]);
+        failures++;
+    }
+#endif
+    return (failures == 0) ? 0 : 1;
+}
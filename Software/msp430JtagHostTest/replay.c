@@ -0,0 +1,165 @@
+/*
+ * replay.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Replays a capture log written by writeCapture() against the TAP
+ * model of tap_model.c, so a session recorded on the debugger can be
+ * checked without the target:
+ *
+ *     jtagreplay [-s snapshot] [-v vcd] capture
+ *
+ *     -s  load the target memory and registers from a snapshot
+ *         written by writeSnapshot() before replaying
+ *     -v  write the pins driven during the replay to a VCD file,
+ *         timed by the MCLK model of tap_model.c
+ *
+ * Every scan is reissued through jtag_fsm.c and its TDO compared
+ * with the captured one. Each scan that differs is printed with the
+ * line it came from, and the exit status is 1 if any did. A capture
+ * started in the middle of a session has no session to resume on
+ * the model, so JTAG is entered before resuming it.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "jtag_host_pins.h"
+#include "target_model.h"
+#include "jtag_fsm.h"
+#include "simulator.h"
+
+static FILE *vcd_file;
+
+static const char *SCAN_NAMES[] = {"IR_SHIFT", "DR_SHIFT", "DR_SHIFT20", "SetTCLK",
+                                   "ClrTCLK", "ClockPSA", "START", "RESET"};
+
+static int usage(const char *name) {
+    fprintf(stderr, "usage: %s [-s snapshot] [-v vcd] capture\n", name);
+    return 2;
+}
+
+static void vcdSink(char *text) {
+    fputs(text, vcd_file);
+}
+
+/*
+ * Reissues one captured scan.
+ *
+ * Returns: The bits captured from TDO, 0 for records without any.
+ */
+static uint32_t replayScan(uint8_t type, uint32_t input) {
+    switch (type) {
+    case SCAN_IR:
+        return IR_SHIFT((uint8_t) input);
+    case SCAN_DR:
+        return DR_SHIFT((uint16_t) input);
+    case SCAN_DR20:
+        return DR_SHIFT20(input);
+    case SCAN_TCLK_SET:
+        SetTCLK();
+        return 0;
+    case SCAN_TCLK_CLR:
+        ClrTCLK();
+        return 0;
+    case SCAN_PSA:
+        ClockPSA();
+        return 0;
+    case SCAN_START:
+        initFSM();
+        resumeFSM(input != 0);
+        return 0;
+    case SCAN_RESET:
+        initFSM();
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    char line[64];
+    const char *snapshot = NULL, *vcd = NULL;
+    unsigned int id, overflowed, type, high, input, output, timestamp;
+    uint32_t full_input, expected, actual;
+    unsigned long scans = 0, mismatches = 0, number = 0;
+    bool started = false;
+    FILE *file;
+    int option;
+
+    while ((option = getopt(argc, argv, "s:v:")) != -1) {
+        switch (option) {
+        case 's':
+            snapshot = optarg;
+            break;
+        case 'v':
+            vcd = optarg;
+            break;
+        default:
+            return usage(argv[0]);
+        }
+    }
+    if (optind != argc - 1) {
+        return usage(argv[0]);
+    }
+    file = fopen(argv[optind], "r");
+    if (file == NULL) {
+        fprintf(stderr, "cannot open %s\n", argv[optind]);
+        return 2;
+    }
+    if (vcd != NULL) {
+        vcd_file = fopen(vcd, "w");
+        if (vcd_file == NULL) {
+            fprintf(stderr, "cannot write %s\n", vcd);
+            return 2;
+        }
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        number++;
+        if (sscanf(line, "CAPTURE %x %x", &id, &overflowed) == 2) {
+            clrTap(id == JTAG_ID_XV2);
+            if (snapshot != NULL && !loadSnapshot(getTargetCpu(), snapshot)) {
+                fprintf(stderr, "%s is not a snapshot\n", snapshot);
+                return 2;
+            }
+            if (overflowed) {
+                printf("capture overflowed, replaying the scans it kept\n");
+            }
+            if (vcd_file != NULL && !started) {
+                startPinVcd(vcdSink);
+            }
+            started = true;
+        } else if (line[0] == 'E') {
+            break;
+        } else if (started && sscanf(line, "S%x %x %x %x %x",
+                                     &type, &high, &input, &output, &timestamp) == 5) {
+            if (type >= sizeof(SCAN_NAMES) / sizeof(SCAN_NAMES[0])) {
+                fprintf(stderr, "line %lu: unknown scan type %X\n", number, type);
+                return 2;
+            }
+            full_input = ((uint32_t) (high & 0x0F) << 16) | input;
+            expected = ((uint32_t) (high & 0xF0) << 12) | output;
+            actual = replayScan(type, full_input);
+            scans++;
+            if (actual != expected) {
+                mismatches++;
+                printf("line %lu: %s(%05lX) at %04X shifted out %05lX, captured %05lX\n",
+                       number, SCAN_NAMES[type], (unsigned long) full_input, timestamp,
+                       (unsigned long) actual, (unsigned long) expected);
+            }
+        }
+    }
+    fclose(file);
+    if (vcd_file != NULL) {
+        stopPinVcd();
+        fclose(vcd_file);
+    }
+    if (!started) {
+        fprintf(stderr, "%s is not a capture\n", argv[optind]);
+        return 2;
+    }
+    printf("%lu scans replayed, %lu mismatched\n", scans, mismatches);
+    return (mismatches == 0) ? 0 : 1;
+}
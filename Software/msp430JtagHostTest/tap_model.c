@@ -0,0 +1,501 @@
+/*
+ * tap_model.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * A model of the JTAG TAP of an MSP430 target, driven by the pin
+ * writes of jtag_fsm.c. Over 4-wire the TAP follows TMS on every
+ * rising TCK edge while TEST is high and changes TDO on the falling
+ * edges. With JTAG_SBW defined the pins are decoded as Spy-Bi-Wire
+ * slots instead, see sbwRising() and sbwFalling(). The data
+ * registers behind the TAP and the CPU they control are modelled in
+ * target_model.c, which also sees TDI as TCLK while the TAP sits in
+ * Run-Test/Idle. Over 4-wire the pins are also watched by the BSL
+ * stand-in of bsl_model.c, which takes over BSLIN once started.
+ *
+ * Time is kept in cycles of the debugger's 1MHz MCLK. Every port
+ * access, eg BIS.B #BIT0,&P1OUT, costs PIN_CYCLES and delays cost
+ * what they ask for. The loops and calls around the accesses are
+ * not counted, so times are a lower bound set by the port accesses.
+ * The same clock times the waveform of startPinVcd(), which records
+ * every level the pins take, as written by the debugger or, for
+ * TDO, driven by the target.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "jtag_host_pins.h"
+#include "target_model.h"
+#include "bsl_model.h"
+#include "jtag_vcd.h"
+#include "jtag_fsm.h"
+#include "jtag_config.h"
+
+#define MCLK_MHZ        (1)
+#define PIN_CYCLES      (4)     // MCLK cycles of a port access
+#define SBW_RESET_US    (100)   // SBWTCK low this long leaves Spy-Bi-Wire
+
+PinEdge pin_trace[PIN_TRACE_DEPTH];
+uint16_t pin_trace_length;
+TapEdge tap_trace[TAP_TRACE_DEPTH];
+uint16_t tap_trace_length;
+
+/*
+ * Next TAP state, indexed by the state and the TMS level.
+ */
+static const TapState NEXT_STATE[16][2] = {
+    [TAP_RESET]      = {TAP_IDLE,       TAP_RESET},
+    [TAP_IDLE]       = {TAP_IDLE,       TAP_SELECT_DR},
+    [TAP_SELECT_DR]  = {TAP_CAPTURE_DR, TAP_SELECT_IR},
+    [TAP_CAPTURE_DR] = {TAP_SHIFT_DR,   TAP_EXIT1_DR},
+    [TAP_SHIFT_DR]   = {TAP_SHIFT_DR,   TAP_EXIT1_DR},
+    [TAP_EXIT1_DR]   = {TAP_PAUSE_DR,   TAP_UPDATE_DR},
+    [TAP_PAUSE_DR]   = {TAP_PAUSE_DR,   TAP_EXIT2_DR},
+    [TAP_EXIT2_DR]   = {TAP_SHIFT_DR,   TAP_UPDATE_DR},
+    [TAP_UPDATE_DR]  = {TAP_IDLE,       TAP_SELECT_DR},
+    [TAP_SELECT_IR]  = {TAP_CAPTURE_IR, TAP_RESET},
+    [TAP_CAPTURE_IR] = {TAP_SHIFT_IR,   TAP_EXIT1_IR},
+    [TAP_SHIFT_IR]   = {TAP_SHIFT_IR,   TAP_EXIT1_IR},
+    [TAP_EXIT1_IR]   = {TAP_PAUSE_IR,   TAP_UPDATE_IR},
+    [TAP_PAUSE_IR]   = {TAP_PAUSE_IR,   TAP_EXIT2_IR},
+    [TAP_EXIT2_IR]   = {TAP_SHIFT_IR,   TAP_UPDATE_IR},
+    [TAP_UPDATE_IR]  = {TAP_IDLE,       TAP_SELECT_DR},
+};
+
+static uint8_t levels[6];
+static bool outputs[6];     // driven by the debugger, else an input
+static uint32_t cycles;     // MCLK cycles so far
+static TapState state;
+static uint8_t instruction, ir_shift, tdo;
+static uint32_t dr_shift;
+static uint8_t tclk;        // TCLK as the target sees it
+static uint32_t tclk_edges;
+/* Set for an MSP430Xv2 target, whose address register is 20 bits */
+static bool is_xv2;
+
+static bool vcd_on;
+static uint32_t vcd_cycles;     // cycles at the last waveform update
+
+#ifdef JTAG_SBW
+static bool sbw_enabled;
+static uint8_t slot;        // 0 TMS, 1 TDI, 2 TDO
+static uint8_t slot_tms, slot_tdi;
+static uint32_t low_start;  // when SBWTCK last went low
+static SbwStats sbw_stats;
+#endif
+
+static int getDrBits() {
+    if (instruction == IR_BYPASS) {
+        return 1;
+    }
+    if (is_xv2 && (instruction == IR_ADDR_16BIT || instruction == IR_ADDR_CAPTURE)) {
+        return 20;
+    }
+    return 16;
+}
+
+/*
+ * The value loaded into the DR shift register in Capture-DR. An
+ * Xv2 target shifts a 20-bit register out with bits 19-16 last.
+ */
+static uint32_t captureDr() {
+    uint32_t value = captureTarget(instruction);
+
+    if (getDrBits() == 20) {
+        return ((value & 0xFFFF) << 4) | (value >> 16);
+    }
+    return value & 0xFFFF;
+}
+
+/*
+ * The value loaded into the IR shift register in Capture-IR.
+ * shiftIR() files the first bit out as bit 7 of the JTAG ID, so
+ * the ID is captured with its bits reversed.
+ */
+static uint8_t captureIr() {
+    uint8_t id = is_xv2 ? JTAG_ID_XV2 : JTAG_ID;
+    uint8_t reversed = 0;
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        reversed |= ((id >> i) & 1) << (7 - i);
+    }
+    return reversed;
+}
+
+/*
+ * Takes the level of TDI as TCLK, which only clocks the target
+ * while the TAP is in Run-Test/Idle.
+ */
+static void setTclk(uint8_t level) {
+    if (state == TAP_IDLE && level != tclk) {
+        tclk_edges++;
+        clockTarget(level);
+    }
+    tclk = level;
+}
+
+static void risingTck(uint8_t tms, uint8_t tdi) {
+    if (tap_trace_length < TAP_TRACE_DEPTH) {
+        tap_trace[tap_trace_length].tms = tms;
+        tap_trace[tap_trace_length].tdi = tdi;
+        tap_trace_length++;
+    }
+    switch (state) {
+    case TAP_CAPTURE_DR:
+        dr_shift = captureDr();
+        break;
+    case TAP_SHIFT_DR:
+        dr_shift = ((dr_shift << 1) | tdi) & ((1UL << getDrBits()) - 1);
+        break;
+    case TAP_UPDATE_DR:
+        updateTarget(instruction, dr_shift);
+        break;
+    case TAP_CAPTURE_IR:
+        ir_shift = captureIr();
+        break;
+    case TAP_SHIFT_IR:
+        ir_shift = (ir_shift >> 1) | (tdi << 7);
+        break;
+    case TAP_UPDATE_IR:
+        instruction = ir_shift;
+        loadTargetInstruction(instruction);
+        break;
+    default:
+        break;
+    }
+    state = NEXT_STATE[state][tms];
+    if (state == TAP_RESET && instruction != IR_BYPASS) {
+        instruction = IR_BYPASS;
+        loadTargetInstruction(instruction);
+    }
+}
+
+static void fallingTck() {
+    if (state == TAP_SHIFT_DR) {
+        tdo = (dr_shift >> (getDrBits() - 1)) & 1;
+    } else if (state == TAP_SHIFT_IR) {
+        tdo = ir_shift & 1;
+    } else {
+        tdo = 0;
+    }
+}
+
+#ifdef JTAG_SBW
+/*
+ * SBWTCK falling: TMS is latched in the TMS slot, where the TAP
+ * clock falls too, and TDI in the TDI slot. In the TDO slot the
+ * target drives SBWTDIO, which the debugger must have released.
+ */
+static void sbwFalling() {
+    low_start = cycles;
+    if (!sbw_enabled) {
+        return;
+    }
+    switch (slot) {
+    case 0:
+        slot_tms = levels[SBWTDIO];
+        fallingTck();
+        break;
+    case 1:
+        slot_tdi = levels[SBWTDIO];
+        break;
+    default:
+        if (outputs[SBWTDIO]) {
+            sbw_stats.contentions++;
+        }
+        break;
+    }
+}
+
+/*
+ * SBWTCK rising: the TAP clock rises at the end of the TDI slot.
+ * TCLK follows SBWTDIO at the end of both the TMS and the TDI
+ * slot, which is why sbwCycle() holds SBWTDIO at the TCLK level
+ * in a TMS slot that stays in Run-Test/Idle. A low phase longer
+ * than SBW_RESET_US drops the target out of Spy-Bi-Wire, and a
+ * rising edge with SBWTDIO (RST) high enters it again.
+ */
+static void sbwRising() {
+    uint32_t low = cycles - low_start;
+
+    if (low > SBW_RESET_US * MCLK_MHZ) {
+        if (sbw_enabled) {
+            sbw_stats.dropouts++;
+        }
+        sbw_enabled = false;
+    }
+    if (!sbw_enabled) {
+        sbw_enabled = levels[SBWTDIO];
+        slot = 0;
+        return;
+    }
+    if (low > sbw_stats.longest_low) {
+        sbw_stats.longest_low = low;
+    }
+    if (low > SBW_LOW_MAX_US * MCLK_MHZ) {
+        sbw_stats.long_lows++;
+    }
+    switch (slot) {
+    case 0:
+        if (!slot_tms) {
+            setTclk(levels[SBWTDIO]);
+        }
+        break;
+    case 1:
+        setTclk(slot_tdi);
+        risingTck(slot_tms, slot_tdi);
+        break;
+    default:
+        break;
+    }
+    slot = (slot + 1) % 3;
+}
+#endif
+
+/*
+ * Returns: The level on TDO, from the TAP or the BSL stand-in.
+ */
+static uint8_t tdoLevel() {
+#ifndef JTAG_SBW
+    if (isBslActive()) {
+        return bslModelRead(cycles);
+    }
+#endif
+    return tdo;
+}
+
+/*
+ * Brings the waveform up to the current cycle and levels.
+ */
+static void dumpPins() {
+    int i;
+
+    if (!vcd_on) {
+        return;
+    }
+    vcdAdvance(cycles - vcd_cycles);
+    vcd_cycles = cycles;
+    for (i = 0; i < 6; i++) {
+        vcdSet(i, (i == TDO) ? tdoLevel() : levels[i]);
+    }
+}
+
+static void setPin(int pin, uint8_t level) {
+    uint8_t previous = levels[pin];
+
+    if (pin_trace_length < PIN_TRACE_DEPTH) {
+        pin_trace[pin_trace_length].pin = pin;
+        pin_trace[pin_trace_length].level = level;
+        pin_trace_length++;
+    }
+    cycles += PIN_CYCLES;
+    levels[pin] = level;
+    tickTarget();
+    if (level == previous) {
+        dumpPins();
+        return;
+    }
+#ifdef JTAG_SBW
+    if (pin == SBWTCK) {
+        if (level) {
+            sbwRising();
+        } else {
+            sbwFalling();
+        }
+    }
+#else
+    bslModelPin(pin, level, cycles);
+    if (levels[TEST] && pin == TCK) {
+        if (level) {
+            risingTck(levels[TMS], levels[TDI]);
+        } else {
+            fallingTck();
+        }
+    } else if (levels[TEST] && pin == TDI) {
+        setTclk(level);
+    }
+#endif
+    dumpPins();
+}
+
+void pinHigh(int pin) {
+    setPin(pin, 1);
+}
+
+void pinLow(int pin) {
+    setPin(pin, 0);
+}
+
+uint32_t pinRead(int pin) {
+    cycles += PIN_CYCLES;
+#ifdef JTAG_SBW
+    if (pin == SBWTDIO && !outputs[pin]) {
+        // only driven by the target in the low phase of a TDO slot
+        return (sbw_enabled && slot == 2 && !levels[SBWTCK]) ? tdo : 0;
+    }
+#else
+    if (pin == BSLIN && isBslActive()) {
+        return bslModelRead(cycles);
+    }
+#endif
+    return (pin == TDO) ? tdo : levels[pin];
+}
+
+uint32_t pinDriven(int pin) {
+    return levels[pin];
+}
+
+void pinInput(int pin) {
+    cycles += PIN_CYCLES;
+    outputs[pin] = false;
+}
+
+void pinOutput(int pin) {
+    cycles += PIN_CYCLES;
+    outputs[pin] = true;
+}
+
+/*
+ * JTAG_CLAIM_PINS(): TDO an input, the other pins outputs, in the
+ * three port accesses the MSP430 takes.
+ */
+void hostClaimPins() {
+    int i;
+
+    for (i = 0; i < 6; i++) {
+        outputs[i] = (i != TDO);
+    }
+    cycles += 3 * PIN_CYCLES;
+}
+
+/*
+ * JTAG_CLAIM_SBW_PINS(): SBWTCK and SBWTDIO outputs.
+ */
+void hostClaimSbwPins() {
+    outputs[TEST] = true;
+    outputs[RST] = true;
+    cycles += 2 * PIN_CYCLES;
+}
+
+/*
+ * JTAG_CLAIM_BSL_PINS(): TEST, RST and BSLOUT outputs, BSLIN an
+ * input.
+ */
+void hostClaimBslPins() {
+    outputs[TEST] = true;
+    outputs[RST] = true;
+    outputs[BSLOUT] = true;
+    outputs[BSLIN] = false;
+    cycles += 3 * PIN_CYCLES;
+}
+
+/*
+ * JTAG_DELAY_CYCLES(): lets n MCLK cycles pass.
+ */
+void hostDelay(uint16_t n) {
+    cycles += n;
+}
+
+/*
+ * Returns: The low bits of the MCLK cycle count, which at 1MHz
+ *          are JTAG_TIMESTAMP() in microseconds.
+ */
+uint16_t hostTimestamp() {
+    return (uint16_t) cycles;
+}
+
+/*
+ * Returns: The MCLK cycles since clrTap().
+ */
+uint32_t getHostCycles() {
+    return cycles;
+}
+
+/*
+ * Starts streaming the pins as a VCD waveform to the sink, timed
+ * in MCLK cycles from now, ie microseconds at 1MHz.
+ */
+void startPinVcd(TextSink sink) {
+    static char *const names[] = {"RST", "TMS", "TCK", "TDI", "TDO", "TEST"};
+
+    vcdBegin(sink, "pins", names, NULL, 6);
+    vcd_on = true;
+    vcd_cycles = cycles;
+    dumpPins();
+}
+
+/*
+ * Ends the waveform at the current cycle.
+ */
+void stopPinVcd() {
+    if (!vcd_on) {
+        return;
+    }
+    dumpPins();
+    vcd_on = false;
+    vcdEnd();
+}
+
+/*
+ * Powers up the model with all pins low inputs, the TAP in
+ * Test-Logic-Reset and the target memory empty.
+ *
+ * xv2: Model an MSP430Xv2 target, see target_model.h.
+ */
+void clrTap(bool xv2) {
+    int i;
+
+    for (i = 0; i < 6; i++) {
+        levels[i] = 0;
+        outputs[i] = false;
+    }
+    clrTarget(xv2);
+    clrBslModel();
+    pin_trace_length = 0;
+    tap_trace_length = 0;
+    cycles = 0;
+    vcd_cycles = 0; // a waveform being streamed carries on
+    state = TAP_RESET;
+    instruction = IR_BYPASS;
+    ir_shift = 0;
+    dr_shift = 0;
+    tdo = 0;
+    tclk = 0;
+    tclk_edges = 0;
+    is_xv2 = xv2;
+#ifdef JTAG_SBW
+    sbw_enabled = false;
+    slot = 0;
+    slot_tms = 0;
+    slot_tdi = 0;
+    low_start = 0;
+    sbw_stats.longest_low = 0;
+    sbw_stats.long_lows = 0;
+    sbw_stats.contentions = 0;
+    sbw_stats.dropouts = 0;
+#endif
+}
+
+TapState getTapState() {
+    return state;
+}
+
+uint8_t getTapInstruction() {
+    return instruction;
+}
+
+/*
+ * Returns: The TCLK edges the target has seen since clrTap().
+ */
+uint32_t getTclkEdges() {
+    return tclk_edges;
+}
+
+#ifdef JTAG_SBW
+const SbwStats *getSbwStats() {
+    return &sbw_stats;
+}
+#endif
@@ -0,0 +1,431 @@
+/*
+ * target_model.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Instructions injected through IR_DATA_16BIT are executed as soon
+ * as their last word has been shifted in, which is all the TCLK
+ * timing the sequences of jtag_control.c rely on. The model keeps
+ * these conventions, chosen to match what the sequences expect of
+ * real hardware:
+ *  - an injected MOV reading R0 sees the PC once the MOV is done,
+ *    which is what readReg(0) reports
+ *  - IR_DATA_PSA seeds the PSA from the PC, and every falling TCLK
+ *    edge advances the PC a word and adds the word it points to
+ *  - IR_DATA_QUICK advances the PC a word on every falling TCLK
+ *    edge, and accesses the word after it, which the CPU has
+ *    already prefetched
+ * Anything else injected is counted by getTargetErrors().
+ *
+ * The EEM is modelled from the registers written through
+ * IR_EMEX_DATA_EXCHANGE: the MBTRIGx comparators on the address or
+ * data bus and access type, their combination, BREAKREACT and the
+ * stop bit read back through IR_EMEX_READ_CONTROL. Triggers see the
+ * data accesses of a released CPU, not those injected over JTAG.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "target_model.h"
+#include "jtag_fsm.h"
+#include "jtag_control.h"
+#include "jtag_eem.h"
+
+// 1xx/2xx control signal register bits
+#define CNTRL_RW        (0x0001)    // read, else write
+#define CNTRL_HALT_JTAG (0x0008)
+#define CNTRL_BYTE      (0x0010)
+#define CNTRL_INSTR_LOAD (0x0080)   // captured only: CPU in instruction fetch
+#define CNTRL_TCE       (0x0200)    // captured only: synced with JTAG
+#define CNTRL_TCE1      (0x0400)
+#define CNTRL_POR       (0x0800)
+
+static Cpu cpu;
+static bool is_xv2;
+static uint16_t cntrl_sig;
+static uint32_t mab;
+static uint16_t mdb;
+static uint16_t psa;
+static uint8_t loaded;
+/* Words of an instruction being injected */
+static uint16_t injected[3];
+static uint8_t num_injected;
+/* Set while the CPU runs from MCLK, released from JTAG control */
+static bool running;
+/* Data registers of instructions the model gives no meaning to */
+static uint32_t registers[256];
+static uint16_t errors;
+/* Memory reads through IR_DATA_TO_ADDR, one per readMem() */
+static uint32_t reads;
+
+/* EEM registers by address / 2, EEM_GENCTRL the last */
+static uint16_t eem[(EEM_GENCTRL >> 1) + 1];
+static uint16_t eem_select;    // register chosen by the first exchange
+static bool eem_selected;      // the next exchange carries its value
+static bool eem_stopped;       // a trigger stopped the CPU
+
+static uint16_t *pc = &cpu.regs[0];
+
+static bool isInstrFetch() {
+    return num_injected == 0 && !running;
+}
+
+static uint16_t readTarget(uint16_t address, bool byte) {
+    return byte ? cpu.memory[address] : readWord(&cpu, address);
+}
+
+static void writeTarget(uint16_t address, uint16_t value, bool byte) {
+    if (byte) {
+        cpu.memory[address] = value;
+    } else {
+        writeWord(&cpu, address, value);
+    }
+}
+
+/*
+ * Executes the injected instruction once all its words are in.
+ */
+static void executeInjected() {
+    uint16_t opcode = injected[0];
+    int16_t offset;
+    uint8_t reg;
+
+    if ((opcode & 0xFC00) == 0x3C00) { // JMP
+        offset = (int16_t) (opcode << 6) >> 6;
+        *pc += 2 + 2 * offset;
+    } else if ((opcode & 0xFFF0) == 0x4030) { // MOV #imm, Rn
+        if (num_injected < 2) {
+            return;
+        }
+        reg = opcode & 0x0F;
+        *pc += 4;
+        cpu.regs[reg] = injected[1];
+    } else if ((opcode & 0xF0FF) == 0x4082) { // MOV Rn, &abs
+        if (num_injected < 2) {
+            return;
+        }
+        reg = (opcode >> 8) & 0x0F;
+        *pc += 4;
+        mdb = cpu.regs[reg];
+        writeWord(&cpu, injected[1], mdb);
+    } else if (opcode == 0x4303) { // NOP
+        *pc += 2;
+    } else {
+        errors++;
+    }
+    num_injected = 0;
+}
+
+/*
+ * Returns: True if trigger matches a data access.
+ */
+static bool isTriggered(uint8_t trigger, uint16_t address, uint16_t value, bool write) {
+    uint16_t control = eem[(8 * trigger + EEM_MBTRIGxCTL) >> 1];
+    uint16_t mask = eem[(8 * trigger + EEM_MBTRIGxMSK) >> 1];
+    uint16_t bus = (control & EEM_MDB) ? value : address;
+
+    switch (control & 0x00E0) {
+    case EEM_ACCESS_RW:
+        break;
+    case EEM_ACCESS_READ:
+        if (write) {
+            return false;
+        }
+        break;
+    case EEM_ACCESS_WRITE:
+        if (!write) {
+            return false;
+        }
+        break;
+    default:
+        return false; // instruction fetches only
+    }
+    return ((bus ^ eem[(8 * trigger + EEM_MBTRIGxVAL) >> 1]) & ~mask) == 0;
+}
+
+/*
+ * Takes a data access of the running CPU. A combination fires once
+ * every trigger feeding it matches, and stops the CPU if enabled in
+ * BREAKREACT.
+ */
+static void eemAccess(Cpu *target, uint16_t address, uint16_t value, bool write) {
+    uint8_t matched = 0, feeding, trigger, combination;
+
+    if (!(eem[EEM_GENCTRL >> 1] & EEM_EN)) {
+        return;
+    }
+    for (trigger = 0; trigger < EEM_TRIGGERS; trigger++) {
+        if (isTriggered(trigger, address, value, write)) {
+            matched |= 1 << trigger;
+        }
+    }
+    for (combination = 0; combination < EEM_TRIGGERS; combination++) {
+        feeding = 0;
+        for (trigger = 0; trigger < EEM_TRIGGERS; trigger++) {
+            if (eem[(8 * trigger + EEM_MBTRIGxCMB) >> 1] & (1 << combination)) {
+                feeding |= 1 << trigger;
+            }
+        }
+        if (feeding != 0 && (feeding & ~matched) == 0
+                && (eem[EEM_BREAKREACT >> 1] & (1 << combination))) {
+            eem_stopped = true;
+            running = false; // once this instruction completes
+        }
+    }
+}
+
+/*
+ * Takes the second DR scan of an IR_EMEX_DATA_EXCHANGE write.
+ */
+static void writeEem(uint16_t reg, uint16_t value) {
+    if (reg > EEM_GENCTRL) {
+        return;
+    }
+    if (reg == EEM_GENCTRL && (value & EEM_CLEAR_STOP)) {
+        eem_stopped = false;
+        value &= ~EEM_CLEAR_STOP;
+    }
+    eem[reg >> 1] = value;
+}
+
+/*
+ * Writes the control signal register, applying a power-up reset
+ * when POR is set.
+ */
+static void writeControl(uint16_t value) {
+    cntrl_sig = value & ~(CNTRL_INSTR_LOAD | CNTRL_TCE);
+    if (value & CNTRL_POR) {
+        *pc = readWord(&cpu, 0xFFFE);
+        cpu.regs[2] = 0;
+        num_injected = 0;
+    }
+    if (value & CNTRL_TCE1) {
+        running = false;
+    }
+}
+
+/*
+ * Returns: The value loaded into the data register of instruction
+ *          in Capture-DR.
+ */
+uint32_t captureTarget(uint8_t instruction) {
+    uint16_t value;
+
+    switch (instruction) {
+    case IR_CNTRL_SIG_16BIT:
+    case IR_CNTRL_SIG_CAPTURE:
+        value = cntrl_sig;
+        if (cntrl_sig & CNTRL_TCE1) {
+            value |= CNTRL_TCE;
+        }
+        if (isInstrFetch()) {
+            value |= CNTRL_INSTR_LOAD;
+        }
+        return value;
+    case IR_ADDR_16BIT:
+    case IR_ADDR_CAPTURE:
+        return mab;
+    case IR_DATA_TO_ADDR:
+        if (cntrl_sig & CNTRL_RW) {
+            mdb = readTarget(mab, (cntrl_sig & CNTRL_BYTE) != 0);
+            reads++;
+        }
+        return mdb;
+    case IR_DATA_QUICK:
+        if (cntrl_sig & CNTRL_RW) {
+            mdb = readWord(&cpu, *pc + 2);
+        }
+        return mdb;
+    case IR_DATA_16BIT:
+    case IR_DATA_CAPTURE:
+        return mdb;
+    case IR_DATA_PSA:
+    case IR_SHIFT_OUT_PSA:
+        return psa;
+    case IR_EMEX_DATA_EXCHANGE:
+        if (eem_selected && (eem_select & EEM_READ) && (eem_select & ~EEM_READ) <= EEM_GENCTRL) {
+            return eem[eem_select >> 1];
+        }
+        return 0;
+    case IR_EMEX_READ_CONTROL:
+        return eem_stopped ? EEM_STOPPED : 0;
+    case IR_BYPASS:
+        return 0;
+    default:
+        return registers[instruction];
+    }
+}
+
+/*
+ * Takes the value shifted into the data register of instruction
+ * in Update-DR.
+ */
+void updateTarget(uint8_t instruction, uint32_t value) {
+    switch (instruction) {
+    case IR_CNTRL_SIG_16BIT:
+        writeControl(value);
+        break;
+    case IR_ADDR_16BIT:
+        mab = value;
+        break;
+    case IR_DATA_TO_ADDR:
+        if (!(cntrl_sig & CNTRL_RW)) {
+            writeTarget(mab, value, (cntrl_sig & CNTRL_BYTE) != 0);
+        }
+        mdb = value;
+        break;
+    case IR_DATA_16BIT:
+        mdb = value;
+        injected[num_injected++] = value;
+        executeInjected();
+        break;
+    case IR_DATA_QUICK:
+        mdb = value;
+        break;
+    case IR_EMEX_DATA_EXCHANGE:
+        if (!eem_selected) {
+            eem_select = value;
+            eem_selected = true;
+        } else {
+            if (!(eem_select & EEM_READ)) {
+                writeEem(eem_select, value);
+            }
+            eem_selected = false;
+        }
+        break;
+    case IR_CNTRL_SIG_CAPTURE:
+    case IR_ADDR_CAPTURE:
+    case IR_DATA_CAPTURE:
+    case IR_DATA_PSA:
+    case IR_SHIFT_OUT_PSA:
+    case IR_BYPASS:
+        break;
+    default:
+        registers[instruction] = value;
+        break;
+    }
+}
+
+/*
+ * Takes a new instruction in Update-IR. Releasing the control
+ * signal register lets a CPU under JTAG control run from MCLK.
+ */
+void loadTargetInstruction(uint8_t instruction) {
+    loaded = instruction;
+    switch (instruction) {
+    case IR_DATA_PSA:
+        psa = *pc;
+        break;
+    case IR_EMEX_DATA_EXCHANGE:
+        eem_selected = false; // a register is selected first
+        break;
+    case IR_CNTRL_SIG_RELEASE:
+    case IR_BYPASS:
+        if (cntrl_sig & CNTRL_TCE1) {
+            cntrl_sig &= ~CNTRL_TCE1;
+            running = true;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/*
+ * Takes a TCLK edge, ie a change of TDI in Run-Test/Idle.
+ */
+void clockTarget(bool tclk) {
+    if (tclk) {
+        return;
+    }
+    if (loaded == IR_DATA_QUICK) {
+        *pc += 2;
+        if (!(cntrl_sig & CNTRL_RW)) {
+            writeWord(&cpu, *pc + 2, mdb);
+        }
+    } else if (loaded == IR_DATA_PSA) {
+        *pc += 2;
+        if (psa & 0x8000) {
+            psa ^= PSA_POLYNOMIAL;
+            psa <<= 1;
+            psa |= 1;
+        } else {
+            psa <<= 1;
+        }
+        psa ^= readWord(&cpu, *pc);
+    }
+}
+
+/*
+ * Runs one instruction of a released CPU. A CPU that enters a
+ * low-power mode or meets a word that does not decode stops.
+ */
+void tickTarget() {
+    if (!running || (cpu.regs[2] & SR_CPUOFF)) {
+        return;
+    }
+    if (!step(&cpu, NULL)) {
+        running = false;
+    }
+}
+
+/*
+ * Powers up the target with empty memory, under JTAG control of
+ * nobody.
+ *
+ * xv2: Model an MSP430Xv2 target, see target_model.h.
+ */
+void clrTarget(bool xv2) {
+    int i;
+
+    clrCpu(&cpu);
+    cpu.on_access = eemAccess;
+    for (i = 0; i < 256; i++) {
+        registers[i] = 0;
+    }
+    for (i = 0; i < sizeof(eem) / sizeof(eem[0]); i++) {
+        eem[i] = 0;
+    }
+    eem_selected = false;
+    eem_stopped = false;
+    is_xv2 = xv2;
+    cntrl_sig = 0;
+    mab = 0;
+    mdb = 0;
+    psa = 0;
+    loaded = IR_BYPASS;
+    num_injected = 0;
+    running = false;
+    errors = 0;
+    reads = 0;
+}
+
+Cpu *getTargetCpu() {
+    return &cpu;
+}
+
+uint32_t getTargetMab() {
+    return mab;
+}
+
+bool isTargetRunning() {
+    return running;
+}
+
+/*
+ * Returns: The number of injected instructions the model did not
+ *          understand since clrTarget().
+ */
+uint16_t getTargetErrors() {
+    return errors;
+}
+
+/*
+ * Returns: The number of memory reads through IR_DATA_TO_ADDR, as
+ *          done by readMem(), since clrTarget().
+ */
+uint32_t getTargetReads() {
+    return reads;
+}
@@ -0,0 +1,39 @@
+/*
+ * target_model.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * The JTAG data registers of an MSP430 target and the CPU behind
+ * them, driven by the TAP model of tap_model.c. The CPU is the
+ * instruction-set simulator of msp430Simulator, so once released
+ * from JTAG control the target runs the code in its memory.
+ *
+ * Only the 1xx/2xx control signal register is modelled, along with
+ * the EEM-S triggers of jtag_eem.h that stop the CPU. An Xv2
+ * target differs in the JTAG ID and the width of its address
+ * register, so 20-bit scans can be tested, but its 20-bit memory
+ * access sequences are not understood.
+ */
+
+#ifndef TARGET_MODEL_H_
+#define TARGET_MODEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "simulator.h"
+
+void clrTarget(bool xv2);
+uint32_t captureTarget(uint8_t instruction);
+void updateTarget(uint8_t instruction, uint32_t value);
+void loadTargetInstruction(uint8_t instruction);
+void clockTarget(bool tclk);
+void tickTarget();
+
+Cpu *getTargetCpu();
+uint32_t getTargetMab();
+bool isTargetRunning();
+uint16_t getTargetErrors();
+uint32_t getTargetReads();
+
+#endif /* TARGET_MODEL_H_ */
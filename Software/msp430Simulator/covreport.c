@@ -0,0 +1,137 @@
+/*
+ * covreport.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Renders the coverage streamed by writeCoverage() of the JTAG driver,
+ * see jtag_coverage.h for its format, against the flash of a snapshot
+ * taken with writeSnapshot():
+ *
+ *     covreport [-a] snapshot coverage
+ *
+ *     -a  list every instruction of the window, not only the covered
+ *         ones and the first instruction after each covered run
+ *
+ * The streams of a session can be appended to one coverage file, the
+ * words covered being the union of all of them. Each listed
+ * instruction is marked with * if it was fetched. The listing ends
+ * with the number of instructions covered out of those in the window.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "simulator.h"
+#include "disassembler.h"
+
+#define MAX_WORDS   (0x8000)
+
+static Cpu cpu;
+static uint8_t covered[MAX_WORDS / 8];
+static uint16_t window_start;
+static uint16_t window_words;
+
+static int usage(const char *name) {
+    fprintf(stderr, "usage: %s [-a] snapshot coverage\n", name);
+    return 2;
+}
+
+static bool isSet(uint16_t word) {
+    return (covered[word >> 3] & (1 << (word & 7))) != 0;
+}
+
+/*
+ * Adds the streams of the coverage file at path to the bitmap.
+ *
+ * Returns: False if the file cannot be read, holds no stream, or
+ *          its streams disagree on the window.
+ */
+static bool loadCoverage(const char *path) {
+    char line[64];
+    unsigned int start, words, skip, run;
+    uint32_t word = 0;
+    bool found = false;
+    FILE *file;
+
+    file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "COVERAGE %x %x", &start, &words) == 2) {
+            if (words > MAX_WORDS || (found && (start != window_start || words != window_words))) {
+                fclose(file);
+                return false;
+            }
+            window_start = start;
+            window_words = words;
+            found = true;
+            word = 0;
+        } else if (found && sscanf(line, "D%x %x", &skip, &run) == 2) {
+            for (word += skip; run > 0 && word < window_words; run--, word++) {
+                covered[word >> 3] |= 1 << (word & 7);
+            }
+        }
+    }
+    fclose(file);
+    return found;
+}
+
+int main(int argc, char *argv[]) {
+    char text[INSTRUCTION_TEXT_SIZE];
+    Instruction instr;
+    DecodedInstruction decoded;
+    unsigned long total = 0, hits = 0;
+    bool all = false, previous = false, hit;
+    uint32_t word;
+    int option;
+
+    while ((option = getopt(argc, argv, "a")) != -1) {
+        switch (option) {
+        case 'a':
+            all = true;
+            break;
+        default:
+            return usage(argv[0]);
+        }
+    }
+    if (optind != argc - 2) {
+        return usage(argv[0]);
+    }
+    clrCpu(&cpu);
+    if (!loadSnapshot(&cpu, argv[optind])) {
+        fprintf(stderr, "%s is not a snapshot\n", argv[optind]);
+        return 2;
+    }
+    if (!loadCoverage(argv[optind + 1])) {
+        fprintf(stderr, "%s is not a coverage stream\n", argv[optind + 1]);
+        return 2;
+    }
+
+    word = 0;
+    while (word < window_words) {
+        instr.address = window_start + 2 * word;
+        instr.operator = readWord(&cpu, instr.address);
+        instr.source = readWord(&cpu, instr.address + 2);
+        instr.destination = readWord(&cpu, instr.address + 4);
+        decode(&decoded, &instr);
+        hit = isSet(word);
+        if (all || hit || previous) {
+            if (decoded.length == 0) {
+                printf("%c %04X  .word 0x%04X\n", hit ? '*' : ' ', instr.address, instr.operator);
+            } else {
+                formatInstruction(text, &decoded);
+                printf("%c %04X  %s\n", hit ? '*' : ' ', instr.address, text);
+            }
+        }
+        if (decoded.length != 0) {
+            total++;
+            hits += hit;
+        }
+        previous = hit;
+        word += (decoded.length == 0) ? 1 : decoded.length;
+    }
+    printf("%lu of %lu instructions covered\n", hits, total);
+    return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * main.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Resumes a target from a snapshot taken by the debugger with
+ * writeSnapshot(), so a field state can be reproduced and changed
+ * without single stepping the real hardware:
+ *
+ *     msp430sim [-n steps] [-b address] [-t]
+ *               [-m address=word]... [-r reg=value]... snapshot
+ *
+ *     -n  run at most this many instructions, 1000000 by default
+ *     -b  stop once the PC reaches address
+ *     -t  print every instruction before it is executed
+ *     -m  change a word of memory before running
+ *     -r  change a register before running
+ *
+ * Numbers other than the step count are hexadecimal, as in the
+ * snapshot. The registers are
+ * printed in the R lines of the snapshot format when the run stops.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "simulator.h"
+#include "disassembler.h"
+
+/*
+ * A change given by -m or -r, applied once the snapshot is loaded.
+ */
+struct Poke {
+    /* Set for -r, clear for -m */
+    bool is_reg;
+    /* The address=value or reg=value text */
+    char *text;
+};
+
+typedef struct Poke Poke;
+
+static Cpu cpu;
+
+static const char *STOP_NAMES[] = {"steps", "breakpoint", "low-power mode", "invalid instruction"};
+
+/*
+ * Prints an instruction before it is executed.
+ */
+static void traceStep(const Cpu *cpu, const DecodedInstruction *decoded) {
+    char text[INSTRUCTION_TEXT_SIZE];
+
+    formatInstruction(text, decoded);
+    printf("%04X  %s\n", decoded->address, text);
+}
+
+static int usage(const char *name) {
+    fprintf(stderr, "usage: %s [-n steps] [-b address] [-t] "
+            "[-m address=word]... [-r reg=value]... snapshot\n", name);
+    return 2;
+}
+
+/*
+ * Parses an address=value pair of hexadecimal numbers.
+ */
+static bool parsePair(const char *text, unsigned long *left, unsigned long *right) {
+    char *end;
+
+    *left = strtoul(text, &end, 16);
+    if (end == text || *end != '=') {
+        return false;
+    }
+    *right = strtoul(end + 1, &end, 16);
+    return *end == '\0';
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long steps = 1000000, left, right;
+    int32_t breakpoint = -1;
+    StepHook hook = NULL;
+    StopReason reason;
+    Poke pokes[64];
+    int npokes = 0, option, i;
+    uint8_t reg;
+
+    while ((option = getopt(argc, argv, "n:b:tm:r:")) != -1) {
+        switch (option) {
+        case 'n':
+            steps = strtoul(optarg, NULL, 10);
+            break;
+        case 'b':
+            breakpoint = strtoul(optarg, NULL, 16) & 0xFFFF;
+            break;
+        case 't':
+            hook = traceStep;
+            break;
+        case 'm':
+        case 'r':
+            if (npokes == sizeof(pokes) / sizeof(pokes[0])) {
+                fprintf(stderr, "too many -m and -r options\n");
+                return 2;
+            }
+            pokes[npokes].is_reg = (option == 'r');
+            pokes[npokes].text = optarg;
+            npokes++;
+            break;
+        default:
+            return usage(argv[0]);
+        }
+    }
+    if (optind != argc - 1) {
+        return usage(argv[0]);
+    }
+
+    clrCpu(&cpu);
+    if (!loadSnapshot(&cpu, argv[optind])) {
+        fprintf(stderr, "%s is not a snapshot\n", argv[optind]);
+        return 1;
+    }
+    for (i = 0; i < npokes; i++) {
+        if (!parsePair(pokes[i].text, &left, &right)) {
+            fprintf(stderr, "bad value %s\n", pokes[i].text);
+            return 2;
+        }
+        if (pokes[i].is_reg) {
+            reg = left & 0xF;
+            cpu.regs[reg] = right;
+        } else {
+            writeWord(&cpu, left, right);
+        }
+    }
+
+    reason = simulate(&cpu, steps, breakpoint, hook);
+    printf("STOP %s after %lu steps\n", STOP_NAMES[reason], (unsigned long) cpu.steps);
+    for (reg = 0; reg < 16; reg++) {
+        if (reg != 3) {
+            printf("R%X %04X\n", reg, cpu.regs[reg]);
+        }
+    }
+    return (reason == STOP_ERROR) ? 1 : 0;
+}
@@ -0,0 +1,461 @@
+/*
+ * simulator.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "simulator.h"
+#include "disassembler.h"
+
+/*
+ * Where an operand lives once its addressing mode is resolved.
+ */
+struct Operand {
+    /* Set if the operand is a register, else it is in memory */
+    bool in_reg;
+    /* Set for the constants of R2 and R3, which cannot be written */
+    bool constant;
+    /* The register, if in_reg */
+    uint8_t reg;
+    /* The memory address, if not in_reg */
+    uint16_t address;
+    /* The value, for constants */
+    uint16_t value;
+};
+
+typedef struct Operand Operand;
+
+/*
+ * Empties the registers and memory of cpu.
+ */
+void clrCpu(Cpu *cpu) {
+    memset(cpu, 0, sizeof(*cpu));
+}
+
+/*
+ * Loads a snapshot written by writeSnapshot() of the JTAG driver,
+ * see jtag_snapshot.h for its format. Memory and registers the
+ * snapshot leaves out are left as they were.
+ *
+ * Returns: False if the file cannot be read or is not a snapshot.
+ */
+bool loadSnapshot(Cpu *cpu, const char *path) {
+    char line[256];
+    char *next, *end;
+    unsigned int reg, value;
+    uint16_t address;
+    bool found = false;
+    FILE *file;
+
+    file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (strncmp(line, "SNAPSHOT", 8) == 0) {
+            found = true;
+        } else if (strncmp(line, "END", 3) == 0) {
+            break;
+        } else if (line[0] == 'R' && sscanf(line, "R%x %x", &reg, &value) == 2) {
+            cpu->regs[reg & 0xF] = value;
+        } else if (line[0] == 'M') {
+            address = strtoul(line + 1, &next, 16);
+            while (true) {
+                value = strtoul(next, &end, 16);
+                if (end == next) {
+                    break;
+                }
+                writeWord(cpu, address, value);
+                address += 2;
+                next = end;
+            }
+        }
+    }
+    fclose(file);
+    return found;
+}
+
+/*
+ * Returns the word at address, which is aligned down as the
+ * MSP430 does.
+ */
+uint16_t readWord(const Cpu *cpu, uint16_t address) {
+    address &= ~1;
+    return cpu->memory[address] | (cpu->memory[address + 1] << 8);
+}
+
+/*
+ * Writes the word at address, which is aligned down as the
+ * MSP430 does.
+ */
+void writeWord(Cpu *cpu, uint16_t address, uint16_t value) {
+    address &= ~1;
+    cpu->memory[address] = value & 0xFF;
+    cpu->memory[address + 1] = value >> 8;
+}
+
+/*
+ * Resolves an operand in the given addressing mode, taking its
+ * extension word from the PC if the mode uses one. Autoincrement
+ * is applied here, so each operand must be resolved once.
+ */
+static void resolve(Cpu *cpu, Operand *op, addressingMode mode, uint8_t reg,
+                    bool source, bool byte, uint16_t word) {
+    static const uint16_t CG2[] = {0x0000, 0x0001, 0x0002, 0xFFFF};
+    static const uint16_t CG1[] = {0x0000, 0x0000, 0x0004, 0x0008};
+    uint16_t word_address;
+
+    op->in_reg = false;
+    op->constant = false;
+    op->reg = reg;
+    if (source && (reg == 3 || (reg == 2 && mode >= INDIRECT))) {
+        op->constant = true; // constant generators
+        op->value = (reg == 3) ? CG2[mode - REGISTER] : CG1[mode - REGISTER];
+        return;
+    }
+    switch (mode) {
+    case REGISTER:
+        op->in_reg = true;
+        break;
+    case INDEXED:
+        word_address = cpu->regs[0];
+        cpu->regs[0] += 2;
+        if (reg == 0) {
+            op->address = word_address + word; // symbolic
+        } else if (reg == 2) {
+            op->address = word; // absolute
+        } else {
+            op->address = cpu->regs[reg] + word;
+        }
+        break;
+    case INDIRECT:
+        op->address = cpu->regs[reg];
+        break;
+    case AUTOINCREMENT:
+        if (reg == 0) {
+            op->constant = true; // immediate
+            op->value = word;
+            cpu->regs[0] += 2;
+        } else {
+            op->address = cpu->regs[reg];
+            cpu->regs[reg] += (byte && reg != 1) ? 1 : 2;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/*
+ * Hands a data access to the hook of cpu, if it has one.
+ */
+static void access(Cpu *cpu, uint16_t address, uint16_t value, bool write) {
+    if (cpu->on_access != NULL) {
+        cpu->on_access(cpu, address, value, write);
+    }
+}
+
+static uint16_t load(Cpu *cpu, const Operand *op, bool byte) {
+    uint16_t value;
+
+    if (op->constant) {
+        return byte ? op->value & 0xFF : op->value;
+    }
+    if (op->in_reg) {
+        return byte ? cpu->regs[op->reg] & 0xFF : cpu->regs[op->reg];
+    }
+    value = byte ? cpu->memory[op->address] : readWord(cpu, op->address);
+    access(cpu, op->address, value, false);
+    return value;
+}
+
+static void store(Cpu *cpu, const Operand *op, bool byte, uint16_t value) {
+    if (op->constant || (op->in_reg && op->reg == 3)) {
+        return;
+    }
+    if (op->in_reg) {
+        cpu->regs[op->reg] = byte ? value & 0xFF : value; // .B clears the high byte
+        return;
+    }
+    if (byte) {
+        value &= 0xFF;
+        cpu->memory[op->address] = value;
+    } else {
+        writeWord(cpu, op->address, value);
+    }
+    access(cpu, op->address, value, true);
+}
+
+/*
+ * Sets N and Z from result, and C and V to the values given.
+ */
+static void setFlags(Cpu *cpu, uint16_t result, bool byte, bool carry, bool overflow) {
+    uint16_t sr = cpu->regs[2] & ~(SR_C | SR_Z | SR_N | SR_V);
+
+    if (result & (byte ? 0x80 : 0x8000)) {
+        sr |= SR_N;
+    }
+    if (result == 0) {
+        sr |= SR_Z;
+    }
+    if (carry) {
+        sr |= SR_C;
+    }
+    if (overflow) {
+        sr |= SR_V;
+    }
+    cpu->regs[2] = sr;
+}
+
+/*
+ * Adds src, dst and carry in .B or .W width and sets the flags.
+ */
+static uint16_t add(Cpu *cpu, uint16_t src, uint16_t dst, uint16_t carry, bool byte) {
+    uint16_t mask = byte ? 0xFF : 0xFFFF;
+    uint16_t msb = byte ? 0x80 : 0x8000;
+    uint32_t sum = (uint32_t) src + dst + carry;
+    uint16_t result = sum & mask;
+
+    setFlags(cpu, result, byte, sum > mask, (~(src ^ dst) & (dst ^ result) & msb) != 0);
+    return result;
+}
+
+/*
+ * Adds src, dst and carry as binary coded decimal and sets the flags.
+ */
+static uint16_t addDecimal(Cpu *cpu, uint16_t src, uint16_t dst, bool byte) {
+    uint16_t result = 0, digit;
+    uint16_t carry = cpu->regs[2] & SR_C;
+    int i;
+
+    for (i = 0; i < (byte ? 8 : 16); i += 4) {
+        digit = ((src >> i) & 0xF) + ((dst >> i) & 0xF) + carry;
+        carry = digit > 9;
+        if (carry) {
+            digit -= 10;
+        }
+        result |= digit << i;
+    }
+    setFlags(cpu, result, byte, carry, false); // V is undefined
+    return result;
+}
+
+static void push(Cpu *cpu, uint16_t value) {
+    cpu->regs[1] -= 2;
+    writeWord(cpu, cpu->regs[1], value);
+    access(cpu, cpu->regs[1], value, true);
+}
+
+static uint16_t pop(Cpu *cpu) {
+    uint16_t value = readWord(cpu, cpu->regs[1]);
+
+    access(cpu, cpu->regs[1], value, false);
+    cpu->regs[1] += 2;
+    return value;
+}
+
+static void executeDouble(Cpu *cpu, const DecodedInstruction *decoded) {
+    bool byte = decoded->is_byte;
+    uint16_t msb = byte ? 0x80 : 0x8000;
+    uint16_t mask = byte ? 0xFF : 0xFFFF;
+    uint16_t src, dst = 0, result;
+    Operand src_op, dst_op;
+
+    resolve(cpu, &src_op, decoded->src_mode, decoded->src_reg, true, byte, decoded->source);
+    src = load(cpu, &src_op, byte);
+    resolve(cpu, &dst_op, decoded->dest_mode, decoded->dest_reg, false, byte, decoded->destination);
+    if (decoded->opcode != MOV_ID) {
+        dst = load(cpu, &dst_op, byte);
+    }
+
+    switch (decoded->opcode) {
+    case MOV_ID:
+        result = src;
+        break;
+    case ADD_ID:
+        result = add(cpu, src, dst, 0, byte);
+        break;
+    case ADDC_ID:
+        result = add(cpu, src, dst, cpu->regs[2] & SR_C, byte);
+        break;
+    case SUB_ID:
+    case CMP_ID:
+        result = add(cpu, ~src & mask, dst, 1, byte);
+        break;
+    case SUBC_ID:
+        result = add(cpu, ~src & mask, dst, cpu->regs[2] & SR_C, byte);
+        break;
+    case DADD_ID:
+        result = addDecimal(cpu, src, dst, byte);
+        break;
+    case AND_ID:
+    case BIT_ID:
+        result = src & dst;
+        setFlags(cpu, result, byte, result != 0, false);
+        break;
+    case XOR_ID:
+        result = src ^ dst;
+        setFlags(cpu, result, byte, result != 0, (src & dst & msb) != 0);
+        break;
+    case BIC_ID:
+        result = dst & ~src;
+        break;
+    case BIS_ID:
+        result = dst | src;
+        break;
+    default:
+        return;
+    }
+    if (decoded->opcode != CMP_ID && decoded->opcode != BIT_ID) {
+        store(cpu, &dst_op, byte, result); // after the flags, so writes to SR win
+    }
+}
+
+static void executeSingle(Cpu *cpu, const DecodedInstruction *decoded) {
+    bool byte = decoded->is_byte;
+    uint16_t msb = byte ? 0x80 : 0x8000;
+    uint16_t value, result, carry;
+    Operand op;
+
+    if (decoded->opcode == RETI_ID) {
+        cpu->regs[2] = pop(cpu);
+        cpu->regs[0] = pop(cpu);
+        return;
+    }
+    resolve(cpu, &op, decoded->src_mode, decoded->src_reg, true, byte, decoded->source);
+    value = load(cpu, &op, byte);
+
+    switch (decoded->opcode) {
+    case RRC_ID:
+        carry = cpu->regs[2] & SR_C;
+        result = (value >> 1) | (carry ? msb : 0);
+        setFlags(cpu, result, byte, value & 1, false);
+        break;
+    case RRA_ID:
+        result = (value >> 1) | (value & msb);
+        setFlags(cpu, result, byte, value & 1, false);
+        break;
+    case SWPB_ID:
+        result = (value << 8) | (value >> 8);
+        break;
+    case SXT_ID:
+        result = (value & 0x0080) ? (value | 0xFF00) : (value & 0x00FF);
+        setFlags(cpu, result, false, result != 0, false);
+        byte = false; // SXT always writes the whole word
+        break;
+    case PUSH_ID:
+        push(cpu, value);
+        return;
+    case CALL_ID:
+        push(cpu, cpu->regs[0]);
+        cpu->regs[0] = value;
+        return;
+    default:
+        return;
+    }
+    store(cpu, &op, byte, result);
+}
+
+static void executeJump(Cpu *cpu, const DecodedInstruction *decoded) {
+    uint16_t sr = cpu->regs[2];
+    bool negative = (sr & SR_N) != 0;
+    bool overflow = (sr & SR_V) != 0;
+    bool taken;
+
+    switch (decoded->opcode) {
+    case JNE_ID:
+        taken = !(sr & SR_Z);
+        break;
+    case JEQ_ID:
+        taken = (sr & SR_Z) != 0;
+        break;
+    case JNC_ID:
+        taken = !(sr & SR_C);
+        break;
+    case JC_ID:
+        taken = (sr & SR_C) != 0;
+        break;
+    case JN_ID:
+        taken = negative;
+        break;
+    case JGE_ID:
+        taken = (negative == overflow);
+        break;
+    case JL_ID:
+        taken = (negative != overflow);
+        break;
+    default:
+        taken = true; // JMP
+        break;
+    }
+    if (taken) {
+        cpu->regs[0] = decoded->target;
+    }
+}
+
+/*
+ * Executes the instruction at the PC of cpu, after handing it to
+ * hook unless hook is NULL.
+ *
+ * Returns: False if the words at the PC do not decode as an
+ *          instruction, in which case nothing is executed.
+ */
+bool step(Cpu *cpu, StepHook hook) {
+    DecodedInstruction decoded;
+    Instruction instr;
+
+    instr.address = cpu->regs[0] & ~1;
+    instr.operator = readWord(cpu, instr.address);
+    instr.source = readWord(cpu, instr.address + 2);
+    instr.destination = readWord(cpu, instr.address + 4);
+    if (!decode(&decoded, &instr) || decoded.length == 0) {
+        return false;
+    }
+    if (hook != NULL) {
+        hook(cpu, &decoded);
+    }
+
+    cpu->regs[0] = instr.address + 2; // extension words advance it further
+    switch (decoded.format) {
+    case DOUBLE:
+        executeDouble(cpu, &decoded);
+        break;
+    case SINGLE:
+        executeSingle(cpu, &decoded);
+        break;
+    default:
+        executeJump(cpu, &decoded);
+        break;
+    }
+    cpu->regs[0] &= ~1;
+    cpu->regs[3] = 0;
+    cpu->steps++;
+    return true;
+}
+
+/*
+ * Runs cpu for at most steps instructions, stopping early at the
+ * breakpoint address unless it is negative, on entry into a
+ * low-power mode or on a word that does not decode.
+ */
+StopReason simulate(Cpu *cpu, uint32_t steps, int32_t breakpoint, StepHook hook) {
+    uint32_t i;
+
+    for (i = 0; i < steps; i++) {
+        if (cpu->regs[2] & SR_CPUOFF) {
+            return STOP_LOW_POWER;
+        }
+        if (i != 0 && cpu->regs[0] == breakpoint) {
+            return STOP_BREAKPOINT;
+        }
+        if (!step(cpu, hook)) {
+            return STOP_ERROR;
+        }
+    }
+    return STOP_STEPS;
+}
@@ -0,0 +1,79 @@
+/*
+ * simulator.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * An instruction-set simulator of the MSP430 CPU (not the MSP430X
+ * extensions) for a Linux host. Instructions are decoded with
+ * decode() of msp430DisassemblerLib, so the simulator and the
+ * debugger agree on what every word of flash means.
+ *
+ * The whole 64KB address space is plain memory. Peripherals and
+ * interrupts are not modelled, so a run stops once the CPU enters
+ * a low-power mode instead of waiting for an interrupt.
+ */
+
+#ifndef SIMULATOR_H_
+#define SIMULATOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "disassembler.h"
+
+#define SR_C        (0x0001)    // carry
+#define SR_Z        (0x0002)    // zero
+#define SR_N        (0x0004)    // negative
+#define SR_GIE      (0x0008)    // general interrupt enable
+#define SR_CPUOFF   (0x0010)    // CPU off, set by every low-power mode
+#define SR_V        (0x0100)    // overflow
+
+/*
+ * Why simulate() returned.
+ */
+typedef enum {
+    STOP_STEPS,         // the step limit was reached
+    STOP_BREAKPOINT,    // the PC reached the breakpoint
+    STOP_LOW_POWER,     // CPUOFF was set
+    STOP_ERROR          // a word did not decode as an instruction
+} StopReason;
+
+struct Cpu;
+
+/*
+ * Receives every data access of an instruction to memory, eg to
+ * model the EEM triggers of the target. Instruction fetches,
+ * including immediate and index words, are not data accesses.
+ */
+typedef void (*AccessHook)(struct Cpu *cpu, uint16_t address, uint16_t value, bool write);
+
+/*
+ * The state of a simulated CPU and its memory.
+ */
+struct Cpu {
+    /* R0 to R15, R0 is the PC, R1 the SP and R2 the SR */
+    uint16_t regs[16];
+    /* The 64KB address space, little endian */
+    uint8_t memory[0x10000];
+    /* Instructions executed since the CPU was loaded */
+    uint32_t steps;
+    /* Called on every data access, unless NULL */
+    AccessHook on_access;
+};
+
+typedef struct Cpu Cpu;
+
+/*
+ * Receives every instruction before it is executed, eg to print
+ * a trace.
+ */
+typedef void (*StepHook)(const Cpu *cpu, const DecodedInstruction *decoded);
+
+void clrCpu(Cpu *cpu);
+bool loadSnapshot(Cpu *cpu, const char *path);
+uint16_t readWord(const Cpu *cpu, uint16_t address);
+void writeWord(Cpu *cpu, uint16_t address, uint16_t value);
+bool step(Cpu *cpu, StepHook hook);
+StopReason simulate(Cpu *cpu, uint32_t steps, int32_t breakpoint, StepHook hook);
+
+#endif /* SIMULATOR_H_ */
@@ -0,0 +1,37 @@
+/*
+ * main.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ *
+ * Runs the simulator tests of sim_tests.c, one line per test, and
+ * exits non-zero if any test failed. Run from msp430Simulator, where
+ * the snapshots of the tests are found under tests/.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "sim_tests.h"
+
+static int run_tests(bool (*funcs[])(void), char* names[], unsigned int num_tests) {
+    unsigned int i;
+    int failures = 0;
+
+    for (i = 0; i < num_tests; i++) {
+        if (funcs[i]()) {
+            printf("%s passed.\n", names[i]);
+        } else {
+            printf("%s failed.\n", names[i]);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+int main(void) {
+    int failures;
+
+    failures = run_tests(test_funcs, test_names, sizeof(test_names)/sizeof(char*));
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "sim_tests.h"
+#include "simulator.h"
+
+#define PROGRAM_START (0xC000)
+#define STACK_TOP     (0x0400)
+
+/* The flags set by arithmetic, to compare SR without GIE or CPUOFF */
+#define FLAGS (SR_C | SR_Z | SR_N | SR_V)
+
+static Cpu cpu;
+
+/*
+ * Loads program at PROGRAM_START with the PC on it and an empty
+ * stack, as a snapshot taken at the start of the program would.
+ */
+static void loadProgram(const uint16_t *program, int words) {
+    int i;
+
+    clrCpu(&cpu);
+    for (i = 0; i < words; i++) {
+        writeWord(&cpu, PROGRAM_START + 2 * i, program[i]);
+    }
+    cpu.regs[0] = PROGRAM_START;
+    cpu.regs[1] = STACK_TOP;
+}
+
+/*
+ * Runs the loaded program until the PC reaches end.
+ *
+ * Returns: True if it got there within a few instructions.
+ */
+static bool runTo(uint16_t end) {
+    return simulate(&cpu, 32, end, NULL) == STOP_BREAKPOINT;
+}
+
+/*
+ * Loads the single instruction in program, sets R5 to value and SR
+ * to sr, and runs the instruction.
+ *
+ * Returns: True if R5 and the flags come out as expected.
+ */
+static bool runOnR5(const uint16_t *program, int words, uint16_t value, uint16_t sr,
+                    uint16_t expected, uint16_t flags) {
+    loadProgram(program, words);
+    cpu.regs[5] = value;
+    cpu.regs[2] = sr;
+    if (!runTo(PROGRAM_START + 2 * words)) {
+        return false;
+    }
+    return cpu.regs[5] == expected && (cpu.regs[2] & FLAGS) == flags;
+}
+
+bool test_sub_flags(void) {
+    static const uint16_t sub2[] = {0x8325};        // SUB #2, R5
+    static const uint16_t sub1[] = {0x8315};        // SUB #1, R5
+    static const uint16_t cmp[] = {0x9505};         // CMP R5, R5
+
+    // case 1: a borrow clears C
+    if (!runOnR5(sub2, 1, 0x0001, 0, 0xFFFF, SR_N)) {
+        return false;
+    }
+
+    // case 2: no borrow sets C, crossing 0x8000 sets V
+    if (!runOnR5(sub1, 1, 0x8000, 0, 0x7FFF, SR_C | SR_V)) {
+        return false;
+    }
+
+    // case 3: CMP sets the flags without writing the destination
+    return runOnR5(cmp, 1, 0x1234, SR_N, 0x1234, SR_C | SR_Z);
+}
+
+bool test_byte_flags(void) {
+    static const uint16_t add[] = {0x5355};         // ADD.B #1, R5
+    static const uint16_t sub[] = {0x8365};         // SUB.B #2, R5
+
+    // case 1: overflow and carry come from bit 7, the high byte is cleared
+    if (!runOnR5(add, 1, 0x127F, 0, 0x0080, SR_N | SR_V)) {
+        return false;
+    }
+    if (!runOnR5(add, 1, 0x12FF, 0, 0x0000, SR_C | SR_Z)) {
+        return false;
+    }
+
+    // case 2: a byte borrow
+    return runOnR5(sub, 1, 0x0001, 0, 0x00FF, SR_N);
+}
+
+bool test_dadd(void) {
+    static const uint16_t dadd[] = {0xA315};        // DADD #1, R5
+    static const uint16_t dadd_byte[] = {0xA345};   // DADD.B #0, R5
+
+    // case 1: decimal carries between digits
+    if (!runOnR5(dadd, 1, 0x0999, 0, 0x1000, 0)) {
+        return false;
+    }
+
+    // case 2: a carry out of the last digit sets C
+    if (!runOnR5(dadd, 1, 0x9999, 0, 0x0000, SR_C | SR_Z)) {
+        return false;
+    }
+
+    // case 3: the carry in is added, N follows bit 7 of a byte
+    return runOnR5(dadd_byte, 1, 0x0079, SR_C, 0x0080, SR_N);
+}
+
+bool test_xor_flags(void) {
+    static const uint16_t xor[] = {0xE035, 0x8001}; // XOR #0x8001, R5
+
+    // case 1: V is set when both operands are negative
+    if (!runOnR5(xor, 2, 0x8000, 0, 0x0001, SR_C | SR_V)) {
+        return false;
+    }
+
+    // case 2: a zero result clears C, V still follows the operands
+    if (!runOnR5(xor, 2, 0x8001, SR_C, 0x0000, SR_Z | SR_V)) {
+        return false;
+    }
+
+    // case 3: one negative operand clears V
+    return runOnR5(xor, 2, 0x0001, SR_V, 0x8000, SR_N | SR_C);
+}
+
+bool test_sxt(void) {
+    static const uint16_t sxt[] = {0x1185};         // SXT R5
+
+    // case 1: bit 7 is copied into the high byte
+    if (!runOnR5(sxt, 1, 0x0080, 0, 0xFF80, SR_N | SR_C)) {
+        return false;
+    }
+
+    // case 2: a positive byte clears the high byte
+    if (!runOnR5(sxt, 1, 0xFF7F, SR_V, 0x007F, SR_C)) {
+        return false;
+    }
+
+    // case 3: zero clears C
+    return runOnR5(sxt, 1, 0x5500, 0, 0x0000, SR_Z);
+}
+
+bool test_constant_generators(void) {
+    static const uint16_t program[] = {
+        0x4304,                     // MOV #0, R4
+        0x4315,                     // MOV #1, R5
+        0x4326,                     // MOV #2, R6
+        0x4337,                     // MOV #-1, R7
+        0x4228,                     // MOV #4, R8
+        0x4239,                     // MOV #8, R9
+        0x539A, 0x0002,             // ADD #1, 2(R10)
+        0x421B, 0x0202,             // MOV &0x0202, R11
+    };
+    uint8_t reg;
+
+    // case 1: R2 and R3 give constants without extension words
+    loadProgram(program, 10);
+    for (reg = 4; reg < 12; reg++) {
+        cpu.regs[reg] = 0x5555;
+    }
+    cpu.regs[10] = 0x0200;
+    writeWord(&cpu, 0x0202, 0x0041);
+    if (!runTo(PROGRAM_START + 20) || cpu.steps != 8) {
+        return false;
+    }
+    if (cpu.regs[4] != 0 || cpu.regs[5] != 1 || cpu.regs[6] != 2 || cpu.regs[7] != 0xFFFF
+            || cpu.regs[8] != 4 || cpu.regs[9] != 8) {
+        return false;
+    }
+
+    // case 2: an indexed destination still takes the first extension
+    // word, and R2 in indexed mode is absolute
+    return readWord(&cpu, 0x0202) == 0x0042 && cpu.regs[11] == 0x0042;
+}
+
+bool test_pop_byte(void) {
+    static const uint16_t program[] = {
+        0x4175,                     // MOV.B @SP+, R5
+        0x4677,                     // MOV.B @R6+, R7
+    };
+
+    // case 1: SP always moves by a word, other registers by a byte
+    loadProgram(program, 2);
+    cpu.regs[1] = 0x03FC;
+    writeWord(&cpu, 0x03FC, 0x1234);
+    cpu.regs[5] = 0xFFFF;
+    cpu.regs[6] = 0x0201;
+    writeWord(&cpu, 0x0200, 0xAB00);
+    if (!runTo(PROGRAM_START + 4)) {
+        return false;
+    }
+    return cpu.regs[5] == 0x0034 && cpu.regs[1] == 0x03FE
+            && cpu.regs[7] == 0x00AB && cpu.regs[6] == 0x0202;
+}
+
+bool test_call_reti(void) {
+    static const uint16_t program[] = {
+        0x12B0, 0xC010,             // C000: CALL #0xC010
+        0x3FFF,                     // C004: JMP $
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+        0x1230, 0xC020,             // C010: PUSH #0xC020
+        0x1230, 0x0105,             // C014: PUSH #0x0105
+        0x1300,                     // C018: RETI
+        0x0000, 0x0000, 0x0000,
+        0x4130,                     // C020: RET
+    };
+
+    // case 1: CALL pushes the address after its extension word, RETI
+    // pops SR before the PC and RET returns from the CALL
+    loadProgram(program, 17);
+    if (!runTo(0xC004)) {
+        return false;
+    }
+    if (cpu.regs[1] != STACK_TOP || readWord(&cpu, STACK_TOP - 2) != 0xC004) {
+        return false;
+    }
+    return cpu.regs[2] == 0x0105 && cpu.steps == 5;
+}
+
+bool test_snapshot(void) {
+    // case 1: a counting loop from a snapshot runs to its final jump
+    clrCpu(&cpu);
+    if (!loadSnapshot(&cpu, "tests/loop.snapshot")) {
+        return false;
+    }
+    if (simulate(&cpu, 100, 0xC00A, NULL) != STOP_BREAKPOINT) {
+        return false;
+    }
+    return cpu.regs[5] == 0 && (cpu.regs[2] & FLAGS) == (SR_Z | SR_C) && cpu.steps == 12;
+}
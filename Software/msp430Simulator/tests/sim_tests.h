@@ -0,0 +1,47 @@
+/*
+ * sim_tests.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: bapti
+ */
+
+#ifndef TESTS_SIM_TESTS_H_
+#define TESTS_SIM_TESTS_H_
+
+
+bool test_sub_flags(void);
+bool test_byte_flags(void);
+bool test_dadd(void);
+bool test_xor_flags(void);
+bool test_sxt(void);
+bool test_constant_generators(void);
+bool test_pop_byte(void);
+bool test_call_reti(void);
+bool test_snapshot(void);
+
+static bool (*test_funcs[])(void) = {
+                                     test_sub_flags,
+                                     test_byte_flags,
+                                     test_dadd,
+                                     test_xor_flags,
+                                     test_sxt,
+                                     test_constant_generators,
+                                     test_pop_byte,
+                                     test_call_reti,
+                                     test_snapshot,
+};
+
+static char* test_names[] = {
+                             "test_sub_flags",
+                             "test_byte_flags",
+                             "test_dadd",
+                             "test_xor_flags",
+                             "test_sxt",
+                             "test_constant_generators",
+                             "test_pop_byte",
+                             "test_call_reti",
+                             "test_snapshot",
+};
+
+
+#endif /* TESTS_SIM_TESTS_H_ */